@@ -0,0 +1,24 @@
+#include "cpu_usage_meter.h"
+
+#include <chrono>
+#include <ctime>
+
+// std::clock() returns the CPU time used by all the process' threads on POSIX
+// systems. On Windows it returns the wall clock time, so the meter reports 1.0.
+
+CpuUsageMeter::CpuUsageMeter()
+    : last_cpu_time_(std::clock()), last_wall_time_(std::chrono::steady_clock::now()) {}
+
+double CpuUsageMeter::Sample() {
+  std::clock_t cpu_time = std::clock();
+  std::chrono::steady_clock::time_point wall_time = std::chrono::steady_clock::now();
+
+  double cpu_seconds = static_cast<double>(cpu_time - last_cpu_time_) / CLOCKS_PER_SEC;
+  double wall_seconds = std::chrono::duration<double>(wall_time - last_wall_time_).count();
+  last_cpu_time_ = cpu_time;
+  last_wall_time_ = wall_time;
+
+  if (wall_seconds <= 0)
+    return 0;
+  return cpu_seconds / wall_seconds;
+}
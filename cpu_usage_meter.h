@@ -0,0 +1,26 @@
+#ifndef CPU_USAGE_METER_H_
+#define CPU_USAGE_METER_H_
+
+#include <chrono>
+#include <ctime>
+
+// Measures how much CPU time the process uses, relative to wall clock time.
+class CpuUsageMeter {
+ public:
+  CpuUsageMeter();
+
+  CpuUsageMeter(const CpuUsageMeter&) = delete;
+  CpuUsageMeter& operator=(const CpuUsageMeter&) = delete;
+
+  // The CPU time used since the previous call, or since construction.
+  //
+  // The result is in cores: 1.0 means one core was busy the whole time. It
+  // can exceed 1.0 when several threads are busy.
+  [[nodiscard]] double Sample();
+
+ private:
+  std::clock_t last_cpu_time_;
+  std::chrono::steady_clock::time_point last_wall_time_;
+};
+
+#endif  // CPU_USAGE_METER_H_
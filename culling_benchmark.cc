@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "frustum_culler.h"
+#include "job_system.h"
+
+namespace {
+
+// Perspective projection for a camera at the origin looking down -z, with
+// Vulkan's clip space conventions.
+[[nodiscard]] glm::mat4 ViewProjection(float vertical_fov_radians, float aspect_ratio,
+                                       float near_plane, float far_plane) {
+  float focal_length = 1.0f / std::tan(vertical_fov_radians * 0.5f);
+  glm::mat4 matrix{};
+  matrix[0][0] = focal_length / aspect_ratio;
+  matrix[1][1] = -focal_length;
+  matrix[2][2] = far_plane / (near_plane - far_plane);
+  matrix[2][3] = -1.0f;
+  matrix[3][2] = near_plane * far_plane / (near_plane - far_plane);
+  return matrix;
+}
+
+[[nodiscard]] const char* SimdLevelName(FrustumCuller::SimdLevel simd_level) {
+  switch (simd_level) {
+    case FrustumCuller::SimdLevel::kScalar:
+      return "scalar";
+    case FrustumCuller::SimdLevel::kSse:
+      return "SSE";
+    case FrustumCuller::SimdLevel::kAvx2:
+      return "AVX2";
+  }
+  return "unknown";
+}
+
+void FillCuller(FrustumCuller& culler, size_t object_count) {
+  std::mt19937 random(/*seed=*/42);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.1f, 2.0f);
+
+  for (size_t i = 0; i < object_count; ++i) {
+    glm::vec3 center(position(random), position(random), position(random));
+    if (i % 2 == 0) {
+      culler.AddSphere(static_cast<uint32_t>(i), center, size(random));
+    } else {
+      glm::vec3 extent(size(random), size(random), size(random));
+      culler.AddBox(static_cast<uint32_t>(i),
+                    glm::vec3(center.x - extent.x, center.y - extent.y, center.z - extent.z),
+                    glm::vec3(center.x + extent.x, center.y + extent.y, center.z + extent.z));
+    }
+  }
+}
+
+// Returns the best time of several runs, in microseconds.
+template <typename CullFunction>
+double TimeCull(const CullFunction& cull) {
+  constexpr int kRunCount = 50;
+  double best_time = 1e30;
+  for (int run = 0; run < kRunCount; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    cull();
+    auto end = std::chrono::steady_clock::now();
+    best_time = std::min(best_time, std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  return best_time;
+}
+
+}  // namespace
+
+// Usage: culling_benchmark [object_count]
+//
+// Measures FrustumCuller with each supported instruction set, and with the
+// work split across a JobSystem.
+int main(int argc, char** argv) {
+  size_t object_count = 100000;
+  if (argc > 2) {
+    std::cerr << "Usage: " << argv[0] << " [object_count]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (argc == 2)
+    object_count = std::stoul(argv[1]);
+
+  Frustum frustum = Frustum::FromViewProjection(ViewProjection(
+      /*vertical_fov_radians=*/1.0f, /*aspect_ratio=*/16.0f / 9.0f, /*near_plane=*/0.1f,
+      /*far_plane=*/150.0f));
+
+  FrustumCuller::SimdLevel best_level = FrustumCuller::DetectSimdLevel();
+  std::vector<uint32_t> reference_ids;
+  for (FrustumCuller::SimdLevel simd_level :
+       {FrustumCuller::SimdLevel::kScalar, FrustumCuller::SimdLevel::kSse,
+        FrustumCuller::SimdLevel::kAvx2}) {
+    if (static_cast<int>(simd_level) > static_cast<int>(best_level))
+      break;
+
+    FrustumCuller culler(simd_level);
+    FillCuller(culler, object_count);
+    std::vector<uint32_t> visible_ids;
+    double time = TimeCull([&] { culler.Cull(frustum, visible_ids); });
+    std::cout << SimdLevelName(simd_level) << ": " << visible_ids.size() << " of "
+              << object_count << " visible in " << time << " us" << std::endl;
+
+    if (simd_level == FrustumCuller::SimdLevel::kScalar) {
+      reference_ids = visible_ids;
+    } else if (visible_ids != reference_ids) {
+      std::cerr << SimdLevelName(simd_level) << " results differ from scalar results"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  JobSystem job_system;
+  FrustumCuller culler(best_level);
+  FillCuller(culler, object_count);
+  std::vector<uint32_t> visible_ids;
+  double time = TimeCull([&] { culler.Cull(frustum, job_system, visible_ids); });
+  std::cout << SimdLevelName(best_level) << " on " << job_system.WorkerCount() + 1
+            << " threads: " << visible_ids.size() << " visible in " << time << " us"
+            << std::endl;
+  if (visible_ids != reference_ids) {
+    std::cerr << "Parallel results differ from scalar results" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return 0;
+}
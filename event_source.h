@@ -0,0 +1,32 @@
+#ifndef EVENT_SOURCE_H_
+#define EVENT_SOURCE_H_
+
+// Delivers events to the thread that processes them.
+//
+// FrameLoop uses this interface to wait for events, so it can run both on the
+// windowing system's thread and on a render thread fed by the windowing
+// system's thread.
+class EventSource {
+ public:
+  EventSource() = default;
+  EventSource(const EventSource&) = delete;
+  EventSource& operator=(const EventSource&) = delete;
+  virtual ~EventSource() = default;
+
+  // Dispatches the pending events, without blocking.
+  virtual void PollEvents() = 0;
+
+  // Blocks until at least one event arrives or Wake() is called, then
+  // dispatches all pending events.
+  virtual void WaitEvents() = 0;
+
+  // Like WaitEvents(), but returns after `timeout_seconds` without any event.
+  virtual void WaitEventsTimeout(double timeout_seconds) = 0;
+
+  // Wakes up a WaitEvents() or WaitEventsTimeout() call.
+  //
+  // This is the only method that may be called from any thread.
+  virtual void Wake() = 0;
+};
+
+#endif  // EVENT_SOURCE_H_
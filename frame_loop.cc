@@ -0,0 +1,97 @@
+#include "frame_loop.h"
+
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <utility>
+
+#include "event_source.h"
+#include "frame_pacer.h"
+
+namespace {
+
+[[nodiscard]] FramePacer::Clock::duration FrameInterval(double frames_per_second) {
+  assert(frames_per_second > 0);
+  return std::chrono::duration_cast<FramePacer::Clock::duration>(
+      std::chrono::duration<double>(1 / frames_per_second));
+}
+
+}  // namespace
+
+FrameLoop::FrameLoop(EventSource& event_source, Options options)
+    : event_source_(event_source), options_(std::move(options)) {
+  assert(options_.stats_interval > std::chrono::milliseconds::zero());
+
+  if (options_.mode == Mode::kCapped)
+    pacer_.emplace(FrameInterval(options_.frames_per_second));
+}
+
+FrameLoop::~FrameLoop() = default;
+
+void FrameLoop::Run(const std::function<bool()>& should_stop,
+                    const std::function<void()>& render_frame) {
+  stats_start_time_ = std::chrono::steady_clock::now();
+  stats_frame_count_ = 0;
+  (void)cpu_usage_meter_.Sample();
+
+  // The first frame is rendered right away in all modes, so a window never
+  // shows up empty.
+  event_source_.PollEvents();
+  while (!should_stop()) {
+    if (pacer_.has_value())
+      pacer_->WaitForNextFrame();
+
+    render_frame();
+    ++stats_frame_count_;
+    MaybeReportStats();
+
+    PumpEvents();
+  }
+}
+
+void FrameLoop::RequestRedraw() {
+  redraw_requested_.store(true, std::memory_order_release);
+  event_source_.Wake();
+}
+
+void FrameLoop::PumpEvents() {
+  if (options_.mode != Mode::kOnDemand) {
+    event_source_.PollEvents();
+    return;
+  }
+
+  // A redraw requested while the last frame was rendered must not wait for
+  // the next event.
+  if (redraw_requested_.exchange(false, std::memory_order_acq_rel)) {
+    event_source_.PollEvents();
+    return;
+  }
+
+  // Any event may change what the surfaces show, so every wakeup renders a
+  // frame. Without a timeout, the loop uses no CPU until the user acts.
+  if (options_.max_idle_interval > std::chrono::milliseconds::zero()) {
+    event_source_.WaitEventsTimeout(
+        std::chrono::duration<double>(options_.max_idle_interval).count());
+  } else {
+    event_source_.WaitEvents();
+  }
+  redraw_requested_.store(false, std::memory_order_relaxed);
+}
+
+void FrameLoop::MaybeReportStats() {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration elapsed = now - stats_start_time_;
+  if (elapsed < options_.stats_interval)
+    return;
+
+  if (options_.report_stats) {
+    double elapsed_seconds = std::chrono::duration<double>(elapsed).count();
+    options_.report_stats(FrameLoopStats{
+      .frames_per_second = static_cast<double>(stats_frame_count_) / elapsed_seconds,
+      .cpu_utilization = cpu_usage_meter_.Sample(),
+    });
+  }
+
+  stats_start_time_ = now;
+  stats_frame_count_ = 0;
+}
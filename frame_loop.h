@@ -0,0 +1,99 @@
+#ifndef FRAME_LOOP_H_
+#define FRAME_LOOP_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "cpu_usage_meter.h"
+#include "frame_pacer.h"
+
+class EventSource;
+
+// Statistics reported periodically by FrameLoop.
+struct FrameLoopStats {
+  // Frames rendered per second of wall clock time.
+  double frames_per_second;
+
+  // CPU time used by the process, per second of wall clock time. 1.0 means
+  // one core was busy the whole time.
+  double cpu_utilization;
+};
+
+// Decides when frames are rendered, and waits for windowing system events.
+class FrameLoop {
+ public:
+  enum class Mode {
+    // Renders frames back-to-back. Only the swap chain's present mode limits
+    // the frame rate.
+    kContinuous,
+
+    // Renders frames at a fixed rate, using FramePacer.
+    kCapped,
+
+    // Sleeps until a windowing system event arrives or RequestRedraw() is
+    // called, then renders one frame.
+    kOnDemand,
+  };
+
+  struct Options {
+    Mode mode = Mode::kContinuous;
+
+    // Used in kCapped mode.
+    double frames_per_second = 60;
+
+    // In kOnDemand mode, a frame is rendered at least this often, even without
+    // events. Zero means waiting indefinitely.
+    std::chrono::milliseconds max_idle_interval = std::chrono::milliseconds::zero();
+
+    // How often `report_stats` is called.
+    std::chrono::milliseconds stats_interval = std::chrono::seconds(1);
+
+    // Called with statistics about the previous `stats_interval`. May be null.
+    std::function<void(const FrameLoopStats&)> report_stats;
+  };
+
+  // `event_source` must outlive this instance. Run() must be called on the
+  // thread that processes the source's events.
+  explicit FrameLoop(EventSource& event_source, Options options);
+
+  FrameLoop(const FrameLoop&) = delete;
+  FrameLoop& operator=(const FrameLoop&) = delete;
+
+  ~FrameLoop();
+
+  // Processes events and renders frames until `should_stop` returns true.
+  //
+  // `should_stop` is checked after events are processed, and before each frame
+  // is rendered.
+  void Run(const std::function<bool()>& should_stop, const std::function<void()>& render_frame);
+
+  // Causes a frame to be rendered soon, in kOnDemand mode.
+  //
+  // This is the only method that may be called from any thread.
+  void RequestRedraw();
+
+ private:
+  // Processes events, waiting for them in kOnDemand mode.
+  void PumpEvents();
+
+  // Reports statistics if the stats interval passed.
+  void MaybeReportStats();
+
+  EventSource& event_source_;
+  const Options options_;
+
+  // Set in kCapped mode.
+  std::optional<FramePacer> pacer_;
+
+  std::atomic<bool> redraw_requested_ = false;
+
+  CpuUsageMeter cpu_usage_meter_;
+
+  std::chrono::steady_clock::time_point stats_start_time_;
+  uint64_t stats_frame_count_ = 0;
+};
+
+#endif  // FRAME_LOOP_H_
@@ -0,0 +1,51 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// Bounds for the spin margin. The upper bound is also capped to half of the
+// frame interval, so the pacer always sleeps for part of the frame.
+constexpr FramePacer::Clock::duration kMinSpinMargin = std::chrono::microseconds(200);
+constexpr FramePacer::Clock::duration kMaxSpinMargin = std::chrono::milliseconds(4);
+constexpr FramePacer::Clock::duration kInitialSpinMargin = std::chrono::milliseconds(1);
+
+}  // namespace
+
+FramePacer::FramePacer(Clock::duration frame_interval)
+    : frame_interval_(frame_interval),
+      max_spin_margin_(std::max(kMinSpinMargin, std::min(kMaxSpinMargin, frame_interval / 2))),
+      next_frame_time_(Clock::now()),
+      spin_margin_(std::min(kInitialSpinMargin, max_spin_margin_)) {
+  assert(frame_interval > Clock::duration::zero());
+}
+
+void FramePacer::WaitForNextFrame() {
+  Clock::time_point now = Clock::now();
+  if (now >= next_frame_time_) {
+    // Late frames keep the cadence, unless they missed a whole interval.
+    bool missed_interval = (now - next_frame_time_) >= frame_interval_;
+    next_frame_time_ = (missed_interval ? now : next_frame_time_) + frame_interval_;
+    return;
+  }
+
+  Clock::time_point wake_time = next_frame_time_ - spin_margin_;
+  if (wake_time > now) {
+    std::this_thread::sleep_until(wake_time);
+
+    // Grow quickly to cover the worst wakeup latency seen recently, and
+    // shrink slowly when the system becomes more responsive.
+    Clock::duration oversleep = Clock::now() - wake_time;
+    Clock::duration margin = std::max(oversleep + oversleep / 4,
+                                      spin_margin_ - spin_margin_ / 16);
+    spin_margin_ = std::clamp(margin, kMinSpinMargin, max_spin_margin_);
+  }
+
+  while (Clock::now() < next_frame_time_)
+    std::this_thread::yield();
+
+  next_frame_time_ += frame_interval_;
+}
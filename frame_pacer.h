@@ -0,0 +1,38 @@
+#ifndef FRAME_PACER_H_
+#define FRAME_PACER_H_
+
+#include <chrono>
+
+// Starts frames at a fixed rate.
+//
+// Sleeping alone is imprecise, because the OS scheduler may wake the thread up
+// late. Spinning alone is precise, but keeps a CPU core busy. The pacer sleeps
+// until shortly before the next frame, and spins for the rest of the interval.
+// The spinning margin adapts to the wakeup latency observed on the system.
+class FramePacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit FramePacer(Clock::duration frame_interval);
+
+  FramePacer(const FramePacer&) = delete;
+  FramePacer& operator=(const FramePacer&) = delete;
+
+  // Blocks until the next frame should start.
+  //
+  // The first call returns immediately. If a frame runs late by more than an
+  // interval, the pacer starts the next frame right away, without trying to
+  // catch up on the missed frames.
+  void WaitForNextFrame();
+
+  // The time spent spinning before each frame, for diagnostics.
+  [[nodiscard]] Clock::duration SpinMargin() const { return spin_margin_; }
+
+ private:
+  const Clock::duration frame_interval_;
+  const Clock::duration max_spin_margin_;
+  Clock::time_point next_frame_time_;
+  Clock::duration spin_margin_;
+};
+
+#endif  // FRAME_PACER_H_
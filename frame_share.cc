@@ -0,0 +1,402 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "frame_writer.h"
+#include "unix_fd_channel.h"
+#include "vulkan_command_pool.h"
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_config.h"
+#include "vulkan_device.h"
+#include "vulkan_frame_capture.h"
+#include "vulkan_instance.h"
+#include "vulkan_physical_device.h"
+#include "vulkan_physical_device_list.h"
+#include "vulkan_render_target.h"
+#include "vulkan_shader_module.h"
+#include "vulkan_sync.h"
+#include "vulkan_yuv_converter.h"
+
+namespace {
+
+constexpr VkExtent2D kFrameExtent = {.width = 640, .height = 480};
+constexpr VkFormat kFrameFormat = VK_FORMAT_R8G8B8A8_UNORM;
+constexpr VkImageUsageFlags kFrameUsage =
+    VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+constexpr uint32_t kWorkgroupSize = 8;  // Must match shaders/pattern.comp.
+
+// The exporter renders into one image while the importer reads the others.
+constexpr uint32_t kSharedImageCount = 3;
+
+constexpr VkImageSubresourceRange kColorSubresourceRange = {
+  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+  .baseMipLevel = 0,
+  .levelCount = 1,
+  .baseArrayLayer = 0,
+  .layerCount = 1,
+};
+
+// Sent by the exporter when the importer connects.
+//
+// Carries 3 * kSharedImageCount file descriptors: the memory of each image,
+// followed by each image's `ready` semaphore, followed by each image's
+// `released` semaphore.
+struct SharedImagesMessage {
+  VulkanDeviceIdentity identity;
+  VkDeviceSize memory_sizes[kSharedImageCount];
+};
+
+// Sent by the exporter after submitting the work that renders an image. The
+// work signals the image's `ready` semaphore.
+struct FrameReadyMessage {
+  uint32_t image_index;
+  uint32_t frame_index;
+};
+
+// Sent by the importer after submitting the work that reads an image. The
+// work signals the image's `released` semaphore.
+struct FrameReleasedMessage {
+  uint32_t image_index;
+};
+
+void BeginCommandBuffer(const VulkanDevice& device, VkCommandBuffer command_buffer,
+                        VkCommandBufferUsageFlags flags) {
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .pNext = nullptr,
+    .flags = flags,
+    .pInheritanceInfo = nullptr,
+  };
+  if (device.Functions().vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+    std::cerr << "vkBeginCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+}
+
+void EndCommandBuffer(const VulkanDevice& device, VkCommandBuffer command_buffer) {
+  if (device.Functions().vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+    std::cerr << "vkEndCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+}
+
+// Records a transfer of `image`'s ownership between `src_queue_family_index`
+// and `dst_queue_family_index`, one of which is VK_QUEUE_FAMILY_EXTERNAL.
+//
+// The layout is GENERAL on both sides, unless `discard_contents` is true.
+void RecordOwnershipTransfer(const VulkanDevice& device, VkCommandBuffer command_buffer,
+                             VkImage image, uint32_t src_queue_family_index,
+                             uint32_t dst_queue_family_index, bool discard_contents) {
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = 0,
+    .dstAccessMask = 0,
+    .oldLayout = discard_contents ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL,
+    .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+    .srcQueueFamilyIndex = discard_contents ? VK_QUEUE_FAMILY_IGNORED : src_queue_family_index,
+    .dstQueueFamilyIndex = discard_contents ? VK_QUEUE_FAMILY_IGNORED : dst_queue_family_index,
+    .image = image,
+    .subresourceRange = kColorSubresourceRange,
+  };
+  if (dst_queue_family_index == VK_QUEUE_FAMILY_EXTERNAL) {
+    // Release: make the queue's writes available to the other process.
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+  } else {
+    // Acquire: make the other process's writes visible to the queue.
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+  }
+  device.Functions().vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void Submit(const VulkanDevice& device, VkCommandBuffer command_buffer,
+            VkSemaphore wait_semaphore, VkSemaphore signal_semaphore, VkFence fence) {
+  VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .pNext = nullptr,
+    .waitSemaphoreCount = (wait_semaphore != VK_NULL_HANDLE) ? 1u : 0u,
+    .pWaitSemaphores = &wait_semaphore,
+    .pWaitDstStageMask = &wait_stage,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &command_buffer,
+    .signalSemaphoreCount = (signal_semaphore != VK_NULL_HANDLE) ? 1u : 0u,
+    .pSignalSemaphores = &signal_semaphore,
+  };
+  if (device.Functions().vkQueueSubmit(device.ComputeQueue(), 1, &submit_info, fence) !=
+      VK_SUCCESS) {
+    std::cerr << "vkQueueSubmit() failed" << std::endl;
+    std::abort();
+  }
+}
+
+// Renders `frame_count` frames into shared images, and hands them to the
+// process that connects to `socket_path`.
+int RunExporter(const std::string& socket_path, int frame_count) {
+  VulkanConfig vulkan_config(/*want_external_memory=*/true);
+  VulkanInstance instance(vulkan_config, "Frame Share Exporter");
+  VulkanPhysicalDeviceList physical_devices(instance.VulkanHandle());
+  VulkanDevice device = physical_devices.CreateComputeDevice(vulkan_config);
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  std::vector<std::unique_ptr<VulkanRenderTarget>> targets;
+  std::vector<VkSemaphore> ready_semaphores, released_semaphores;
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    targets.push_back(std::make_unique<VulkanRenderTarget>(
+        device, kFrameExtent, kFrameFormat, kFrameUsage, /*exportable=*/true));
+    ready_semaphores.push_back(CreateExportableVulkanSemaphore(device));
+    released_semaphores.push_back(CreateExportableVulkanSemaphore(device));
+  }
+
+  VulkanComputePipeline pipeline(device, ReadSpirvFile("pattern.spv"),
+                                 {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE}, sizeof(uint32_t),
+                                 kSharedImageCount);
+  std::vector<VkDescriptorSet> descriptor_sets;
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    descriptor_sets.push_back(pipeline.AllocateDescriptorSet());
+    pipeline.BindImage(descriptor_sets[i], /*binding=*/0, targets[i]->ViewVulkanHandle(),
+                       VK_IMAGE_LAYOUT_GENERAL);
+  }
+
+  VulkanCommandPool command_pool(device, device.ComputeQueueFamilyIndex(),
+                                 VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+  std::vector<VkCommandBuffer> command_buffers =
+      command_pool.AllocateCommandBuffers(kSharedImageCount);
+  std::vector<VkFence> fences;
+  for (uint32_t i = 0; i < kSharedImageCount; ++i)
+    fences.push_back(CreateVulkanFence(device, VK_FENCE_CREATE_SIGNALED_BIT));
+
+  std::cerr << "Waiting for an importer on " << socket_path << std::endl;
+  UnixFdChannel channel = UnixFdChannel::Accept(socket_path);
+
+  SharedImagesMessage shared_images = {.identity = device.Identity(), .memory_sizes = {}};
+  std::vector<int> fds;
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    shared_images.memory_sizes[i] = targets[i]->MemorySize();
+    fds.push_back(targets[i]->ExportMemoryFd());
+  }
+  for (VkSemaphore semaphore : ready_semaphores)
+    fds.push_back(ExportVulkanSemaphoreFd(device, semaphore));
+  for (VkSemaphore semaphore : released_semaphores)
+    fds.push_back(ExportVulkanSemaphoreFd(device, semaphore));
+  bool connected = channel.Send(&shared_images, sizeof(shared_images), fds);
+  // The importer has its own copies of the file descriptors.
+  for (int fd : fds)
+    ::close(fd);
+
+  std::vector<bool> image_released(kSharedImageCount, true);
+  for (int frame_index = 0; connected && frame_index < frame_count; ++frame_index) {
+    uint32_t image_index = static_cast<uint32_t>(frame_index) % kSharedImageCount;
+
+    // The importer releases images in the order it receives them. Waiting on
+    // a semaphore requires its signal to be submitted first, so the
+    // exporter waits for the importer's message.
+    if (!image_released[image_index]) {
+      FrameReleasedMessage released;
+      connected = channel.Receive(&released, sizeof(released));
+      if (!connected)
+        break;
+      if (released.image_index != image_index) {
+        std::cerr << "Importer released images out of order" << std::endl;
+        std::abort();
+      }
+    }
+
+    WaitForVulkanFence(device, fences[image_index]);
+    functions.vkResetFences(device.VulkanHandle(), 1, &fences[image_index]);
+
+    VkCommandBuffer command_buffer = command_buffers[image_index];
+    VkImage image = targets[image_index]->VulkanHandle();
+    BeginCommandBuffer(device, command_buffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    // Every frame overwrites the whole image.
+    RecordOwnershipTransfer(device, command_buffer, image, VK_QUEUE_FAMILY_EXTERNAL,
+                            device.ComputeQueueFamilyIndex(), /*discard_contents=*/true);
+    uint32_t push_constant = static_cast<uint32_t>(frame_index);
+    pipeline.Dispatch(command_buffer, descriptor_sets[image_index], &push_constant,
+                      (kFrameExtent.width + kWorkgroupSize - 1) / kWorkgroupSize,
+                      (kFrameExtent.height + kWorkgroupSize - 1) / kWorkgroupSize);
+    RecordOwnershipTransfer(device, command_buffer, image, device.ComputeQueueFamilyIndex(),
+                            VK_QUEUE_FAMILY_EXTERNAL, /*discard_contents=*/false);
+    EndCommandBuffer(device, command_buffer);
+
+    Submit(device, command_buffer,
+           image_released[image_index] ? VK_NULL_HANDLE : released_semaphores[image_index],
+           ready_semaphores[image_index], fences[image_index]);
+    image_released[image_index] = false;
+
+    FrameReadyMessage ready = {.image_index = image_index,
+                               .frame_index = static_cast<uint32_t>(frame_index)};
+    connected = channel.Send(&ready, sizeof(ready));
+  }
+
+  // Imported memory and semaphores outlive their exported counterparts, so
+  // the importer can finish reading after this process exits.
+  functions.vkDeviceWaitIdle(device.VulkanHandle());
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    functions.vkDestroyFence(device.VulkanHandle(), fences[i], /*pAllocator=*/nullptr);
+    functions.vkDestroySemaphore(device.VulkanHandle(), ready_semaphores[i],
+                                 /*pAllocator=*/nullptr);
+    functions.vkDestroySemaphore(device.VulkanHandle(), released_semaphores[i],
+                                 /*pAllocator=*/nullptr);
+  }
+  return connected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Imports the frames rendered by the exporter at `socket_path`, and streams
+// them to `output` as a Y4M video.
+int RunImporter(const std::string& socket_path, std::FILE* output) {
+  UnixFdChannel channel = UnixFdChannel::Connect(socket_path);
+
+  SharedImagesMessage shared_images;
+  std::vector<int> fds;
+  if (!channel.Receive(&shared_images, sizeof(shared_images), &fds) ||
+      fds.size() != 3 * kSharedImageCount) {
+    std::cerr << "Exporter did not share its images" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Opaque file descriptors can only be imported by the same device and
+  // driver that exported them.
+  VulkanConfig vulkan_config(/*want_external_memory=*/true);
+  VulkanInstance instance(vulkan_config, "Frame Share Importer");
+  VulkanPhysicalDeviceList physical_devices(instance.VulkanHandle());
+  VulkanDevice device =
+      physical_devices.CreateComputeDevice(vulkan_config, &shared_images.identity);
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  std::vector<std::unique_ptr<VulkanRenderTarget>> targets;
+  std::vector<VkSemaphore> ready_semaphores, released_semaphores;
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    targets.push_back(std::make_unique<VulkanRenderTarget>(
+        device, kFrameExtent, kFrameFormat, kFrameUsage,
+        VulkanRenderTarget::ImportedMemory{.fd = fds[i], .size = shared_images.memory_sizes[i]}));
+
+    ready_semaphores.push_back(CreateVulkanSemaphore(device));
+    ImportVulkanSemaphoreFd(device, ready_semaphores[i], fds[kSharedImageCount + i]);
+    released_semaphores.push_back(CreateVulkanSemaphore(device));
+    ImportVulkanSemaphoreFd(device, released_semaphores[i], fds[2 * kSharedImageCount + i]);
+  }
+
+  // The ownership transfers for each image never change, so they are
+  // recorded once.
+  VulkanCommandPool command_pool(device, device.ComputeQueueFamilyIndex());
+  std::vector<VkCommandBuffer> acquire_command_buffers =
+      command_pool.AllocateCommandBuffers(kSharedImageCount);
+  std::vector<VkCommandBuffer> release_command_buffers =
+      command_pool.AllocateCommandBuffers(kSharedImageCount);
+  std::vector<VkFence> release_fences;
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    VkImage image = targets[i]->VulkanHandle();
+
+    BeginCommandBuffer(device, acquire_command_buffers[i], /*flags=*/0);
+    RecordOwnershipTransfer(device, acquire_command_buffers[i], image, VK_QUEUE_FAMILY_EXTERNAL,
+                            device.ComputeQueueFamilyIndex(), /*discard_contents=*/false);
+    EndCommandBuffer(device, acquire_command_buffers[i]);
+
+    BeginCommandBuffer(device, release_command_buffers[i], /*flags=*/0);
+    RecordOwnershipTransfer(device, release_command_buffers[i], image,
+                            device.ComputeQueueFamilyIndex(), VK_QUEUE_FAMILY_EXTERNAL,
+                            /*discard_contents=*/false);
+    EndCommandBuffer(device, release_command_buffers[i]);
+
+    release_fences.push_back(CreateVulkanFence(device, VK_FENCE_CREATE_SIGNALED_BIT));
+  }
+
+  VulkanYuvConverter yuv_converter(device, kFrameExtent, kSharedImageCount);
+  FrameWriter writer(output, FrameWriter::Format::kY4m, kFrameExtent.width, kFrameExtent.height,
+                     FrameWriter::PixelOrder::kRgba);
+  VulkanFrameCapture capture(device, device.ComputeQueue(), device.ComputeQueueFamilyIndex(),
+                             kFrameExtent, writer, kSharedImageCount, &yuv_converter);
+
+  while (true) {
+    FrameReadyMessage ready;
+    if (!channel.Receive(&ready, sizeof(ready)))
+      break;
+    if (ready.image_index >= kSharedImageCount) {
+      std::cerr << "Exporter sent an invalid image index" << std::endl;
+      std::abort();
+    }
+    uint32_t image_index = ready.image_index;
+    const VulkanRenderTarget& target = *targets[image_index];
+
+    // The command buffers for the image are reused after their last
+    // submission completes.
+    WaitForVulkanFence(device, release_fences[image_index]);
+    functions.vkResetFences(device.VulkanHandle(), 1, &release_fences[image_index]);
+
+    Submit(device, acquire_command_buffers[image_index], ready_semaphores[image_index],
+           VK_NULL_HANDLE, VK_NULL_HANDLE);
+    capture.Capture(target.VulkanHandle(), target.ViewVulkanHandle(), VK_IMAGE_LAYOUT_GENERAL);
+    Submit(device, release_command_buffers[image_index], VK_NULL_HANDLE,
+           released_semaphores[image_index], release_fences[image_index]);
+
+    FrameReleasedMessage released = {.image_index = image_index};
+    if (!channel.Send(&released, sizeof(released)))
+      break;
+  }
+
+  capture.Flush();
+  functions.vkDeviceWaitIdle(device.VulkanHandle());
+  for (uint32_t i = 0; i < kSharedImageCount; ++i) {
+    functions.vkDestroyFence(device.VulkanHandle(), release_fences[i], /*pAllocator=*/nullptr);
+    functions.vkDestroySemaphore(device.VulkanHandle(), ready_semaphores[i],
+                                 /*pAllocator=*/nullptr);
+    functions.vkDestroySemaphore(device.VulkanHandle(), released_semaphores[i],
+                                 /*pAllocator=*/nullptr);
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+// Hands rendered frames to another process without copying them through
+// host memory.
+//
+// Usage: frame_share export <socket_path> [frame_count]
+//        frame_share import <socket_path> [output_path]
+//
+// The exporter renders an animation into images whose memory is shared with
+// the importer. The importer streams the frames as a Y4M video, to stdout if
+// `output_path` is "-" or missing. Both processes must use the same GPU and
+// driver.
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " export|import <socket_path> [...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string mode(argv[1]);
+  std::string socket_path(argv[2]);
+
+  if (mode == "export") {
+    int frame_count = (argc > 3) ? std::atoi(argv[3]) : 120;
+    return RunExporter(socket_path, frame_count);
+  }
+
+  if (mode == "import") {
+    const char* output_path = (argc > 3) ? argv[3] : "-";
+    std::FILE* output = (std::strcmp(output_path, "-") == 0) ? stdout
+                                                             : std::fopen(output_path, "wb");
+    if (output == nullptr) {
+      std::cerr << "Failed to open " << output_path << std::endl;
+      return EXIT_FAILURE;
+    }
+    int status = RunImporter(socket_path, output);
+    if (output != stdout)
+      std::fclose(output);
+    return status;
+  }
+
+  std::cerr << "Unknown mode: " << mode << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+#include "frame_writer.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+FrameWriter::FrameWriter(std::FILE* output, Format format, uint32_t width, uint32_t height,
+                         PixelOrder pixel_order, uint32_t frames_per_second)
+    : output_(output), format_(format), width_(width), height_(height),
+      pixel_order_(pixel_order), frames_per_second_(frames_per_second),
+      writer_thread_(&FrameWriter::WriterThreadMain, this) {
+  assert(output != nullptr);
+  // 4:2:0 subsampling needs even dimensions.
+  assert(format != Format::kY4m || (width % 2 == 0 && height % 2 == 0));
+  assert(frames_per_second > 0);
+}
+
+FrameWriter::~FrameWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+  }
+  frame_queued_.notify_one();
+  writer_thread_.join();
+
+  assert(frames_.empty());
+  std::fflush(output_);
+}
+
+void FrameWriter::Write(const uint8_t* pixels, std::function<void()> on_written) {
+  assert(pixels != nullptr);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assert(!shutting_down_);
+    frames_.push_back(Frame{.pixels = pixels, .on_written = std::move(on_written)});
+  }
+  frame_queued_.notify_one();
+}
+
+void FrameWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  frame_written_.wait(lock, [this]() { return frames_.empty() && !writing_; });
+}
+
+void FrameWriter::WriterThreadMain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    frame_queued_.wait(lock, [this]() { return !frames_.empty() || shutting_down_; });
+    if (frames_.empty()) {
+      assert(shutting_down_);
+      return;
+    }
+
+    Frame frame = std::move(frames_.front());
+    frames_.pop_front();
+    writing_ = true;
+
+    lock.unlock();
+    WriteFrame(frame.pixels);
+    if (frame.on_written)
+      frame.on_written();
+    lock.lock();
+
+    writing_ = false;
+    frame_written_.notify_all();
+  }
+}
+
+void FrameWriter::WriteFrame(const uint8_t* pixels) {
+  size_t pixel_count = size_t{width_} * height_;
+
+  const uint8_t* data = pixels;
+  size_t data_size = FrameSize();
+  if (format_ == Format::kPpm) {
+    // PPM stores 3-byte RGB pixels.
+    conversion_buffer_.resize(pixel_count * 3);
+    size_t red_offset = (pixel_order_ == PixelOrder::kRgba) ? 0 : 2;
+    size_t blue_offset = 2 - red_offset;
+    for (size_t i = 0; i < pixel_count; ++i) {
+      conversion_buffer_[i * 3 + 0] = pixels[i * 4 + red_offset];
+      conversion_buffer_[i * 3 + 1] = pixels[i * 4 + 1];
+      conversion_buffer_[i * 3 + 2] = pixels[i * 4 + blue_offset];
+    }
+    data = conversion_buffer_.data();
+    data_size = conversion_buffer_.size();
+
+    if (std::fprintf(output_, "P6\n%u %u\n255\n", width_, height_) < 0) {
+      std::cerr << "Failed to write PPM header" << std::endl;
+      std::abort();
+    }
+  } else if (format_ == Format::kY4m) {
+    // C420jpeg: chroma samples are centered between the four luma samples
+    // they cover.
+    if (!stream_header_written_ &&
+        std::fprintf(output_, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", width_, height_,
+                     frames_per_second_) < 0) {
+      std::cerr << "Failed to write Y4M stream header" << std::endl;
+      std::abort();
+    }
+    stream_header_written_ = true;
+
+    if (std::fputs("FRAME\n", output_) < 0) {
+      std::cerr << "Failed to write Y4M frame header" << std::endl;
+      std::abort();
+    }
+  }
+
+  if (std::fwrite(data, 1, data_size, output_) != data_size) {
+    std::cerr << "Failed to write frame" << std::endl;
+    std::abort();
+  }
+}
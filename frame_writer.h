@@ -0,0 +1,102 @@
+#ifndef FRAME_WRITER_H_
+#define FRAME_WRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Streams captured frames to a file or pipe from a background thread.
+//
+// Frames are written in the order they are queued. The thread that queues
+// frames only blocks if it calls Flush().
+class FrameWriter {
+ public:
+  enum class Format {
+    // Pixels are written as they are captured, without any headers.
+    kRaw,
+    // Each frame is written as a binary PPM (P6) image.
+    kPpm,
+    // The frames form a YUV4MPEG2 video stream, which most encoders accept as
+    // input. Frames must be planar YUV 4:2:0, as produced by
+    // VulkanYuvConverter.
+    kY4m,
+  };
+
+  // Byte order of the 4-byte pixels in the frames passed to Write(). Ignored
+  // for kY4m.
+  enum class PixelOrder {
+    kRgba,
+    kBgra,
+  };
+
+  // `output` must remain open while this instance is alive. It is not closed
+  // by this instance.
+  //
+  // `frames_per_second` is only recorded in kY4m streams.
+  explicit FrameWriter(std::FILE* output, Format format, uint32_t width, uint32_t height,
+                       PixelOrder pixel_order, uint32_t frames_per_second = 60);
+
+  FrameWriter(const FrameWriter&) = delete;
+  FrameWriter& operator=(const FrameWriter&) = delete;
+
+  // Writes all the queued frames before returning.
+  ~FrameWriter();
+
+  // Queues a frame of `width` * `height` pixels for writing.
+  //
+  // `pixels` points to FrameSize() bytes.
+  //
+  // `pixels` must remain valid until `on_written` is called. `on_written` is
+  // called on the writer thread.
+  void Write(const uint8_t* pixels, std::function<void()> on_written);
+
+  // Blocks until all the queued frames are written.
+  void Flush();
+
+  // Number of bytes in a frame passed to Write().
+  [[nodiscard]] size_t FrameSize() const {
+    size_t pixel_count = size_t{width_} * height_;
+    return (format_ == Format::kY4m) ? pixel_count * 3 / 2 : pixel_count * 4;
+  }
+
+ private:
+  struct Frame {
+    const uint8_t* pixels;
+    std::function<void()> on_written;
+  };
+
+  void WriterThreadMain();
+  void WriteFrame(const uint8_t* pixels);
+
+  std::FILE* const output_;
+  const Format format_;
+  const uint32_t width_;
+  const uint32_t height_;
+  const PixelOrder pixel_order_;
+  const uint32_t frames_per_second_;
+
+  // Only used on the writer thread.
+  std::vector<uint8_t> conversion_buffer_;
+  bool stream_header_written_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable frame_queued_;
+  std::condition_variable frame_written_;
+  // Guarded by `mutex_`.
+  std::deque<Frame> frames_;
+  // Guarded by `mutex_`. True while the writer thread is writing a frame.
+  bool writing_ = false;
+  // Guarded by `mutex_`.
+  bool shutting_down_ = false;
+
+  // Must be the last member, so the thread starts after the state it uses is initialized.
+  std::thread writer_thread_;
+};
+
+#endif  // FRAME_WRITER_H_
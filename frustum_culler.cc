@@ -0,0 +1,476 @@
+#include "frustum_culler.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "job_system.h"
+
+// SSE2 is part of the x86-64 baseline. AVX2 kernels are compiled for
+// targets that may lack it, and only called after checking the CPU.
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_HAS_SSE 1
+#if defined(__GNUC__)
+#define FRUSTUM_CULLER_HAS_AVX2 1
+#define FRUSTUM_CULLER_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#define FRUSTUM_CULLER_HAS_AVX2 1
+#define FRUSTUM_CULLER_TARGET_AVX2
+#endif  // defined(__GNUC__)
+#endif  // defined(__x86_64__) || defined(_M_X64)
+
+namespace {
+
+// Volumes tested by each job in the parallel Cull().
+constexpr size_t kJobBatchSize = 4096;
+
+// The arrays are padded to a multiple of the widest SIMD width.
+constexpr size_t kArrayPadding = 8;
+
+// Frustum planes as a structure of arrays, for broadcasting into registers.
+//
+// Box tests also need the absolute values of the normals' components.
+struct FrustumPlanes {
+  float x[6], y[6], z[6], distance[6];
+  float abs_x[6], abs_y[6], abs_z[6];
+};
+
+[[nodiscard]] FrustumPlanes GetFrustumPlanes(const Frustum& frustum) {
+  FrustumPlanes planes;
+  for (int i = 0; i < 6; ++i) {
+    const glm::vec4& plane = frustum.planes[i];
+    planes.x[i] = plane.x;
+    planes.y[i] = plane.y;
+    planes.z[i] = plane.z;
+    planes.distance[i] = plane.w;
+    planes.abs_x[i] = std::abs(plane.x);
+    planes.abs_y[i] = std::abs(plane.y);
+    planes.abs_z[i] = std::abs(plane.z);
+  }
+  return planes;
+}
+
+// Appends the IDs of the lanes set in `visible_mask` to `visible_ids`.
+//
+// Every lane's ID is written, and the cursor only advances past visible
+// ones, which avoids unpredictable branches. `visible_ids` must have room for
+// `lane_count` IDs.
+inline size_t AppendVisibleIds(unsigned int visible_mask, size_t lane_count,
+                               const uint32_t* object_ids, uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t lane = 0; lane < lane_count; ++lane) {
+    visible_ids[visible_count] = object_ids[lane];
+    visible_count += (visible_mask >> lane) & 1;
+  }
+  return visible_count;
+}
+
+// Kernels for each SIMD level. A volume is visible if it is not entirely
+// behind any of the planes.
+
+size_t CullSpheresScalar(const FrustumPlanes& planes, const float* center_x,
+                         const float* center_y, const float* center_z, const float* radius,
+                         const uint32_t* object_ids, size_t begin, size_t end,
+                         uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bool visible = true;
+    for (int plane = 0; plane < 6; ++plane) {
+      float distance = planes.x[plane] * center_x[i] + planes.y[plane] * center_y[i] +
+                       planes.z[plane] * center_z[i] + planes.distance[plane];
+      visible &= (distance + radius[i] >= 0.0f);
+    }
+    visible_ids[visible_count] = object_ids[i];
+    visible_count += visible;
+  }
+  return visible_count;
+}
+
+size_t CullBoxesScalar(const FrustumPlanes& planes, const float* center_x,
+                       const float* center_y, const float* center_z, const float* extent_x,
+                       const float* extent_y, const float* extent_z, const uint32_t* object_ids,
+                       size_t begin, size_t end, uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t i = begin; i < end; ++i) {
+    bool visible = true;
+    for (int plane = 0; plane < 6; ++plane) {
+      float distance = planes.x[plane] * center_x[i] + planes.y[plane] * center_y[i] +
+                       planes.z[plane] * center_z[i] + planes.distance[plane];
+      // The box's extent along the plane's normal.
+      float extent = planes.abs_x[plane] * extent_x[i] + planes.abs_y[plane] * extent_y[i] +
+                     planes.abs_z[plane] * extent_z[i];
+      visible &= (distance + extent >= 0.0f);
+    }
+    visible_ids[visible_count] = object_ids[i];
+    visible_count += visible;
+  }
+  return visible_count;
+}
+
+#if defined(FRUSTUM_CULLER_HAS_SSE)
+
+size_t CullSpheresSse(const FrustumPlanes& planes, const float* center_x, const float* center_y,
+                      const float* center_z, const float* radius, const uint32_t* object_ids,
+                      size_t begin, size_t end, uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t i = begin; i < end; i += 4) {
+    __m128 x = _mm_loadu_ps(center_x + i);
+    __m128 y = _mm_loadu_ps(center_y + i);
+    __m128 z = _mm_loadu_ps(center_z + i);
+    __m128 r = _mm_loadu_ps(radius + i);
+
+    __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int plane = 0; plane < 6; ++plane) {
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes.x[plane])),
+                     _mm_mul_ps(y, _mm_set1_ps(planes.y[plane]))),
+          _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(planes.z[plane])),
+                     _mm_set1_ps(planes.distance[plane])));
+      visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(distance, r), _mm_setzero_ps()));
+    }
+    visible_count += AppendVisibleIds(_mm_movemask_ps(visible), 4, object_ids + i,
+                                      visible_ids + visible_count);
+  }
+  return visible_count;
+}
+
+size_t CullBoxesSse(const FrustumPlanes& planes, const float* center_x, const float* center_y,
+                    const float* center_z, const float* extent_x, const float* extent_y,
+                    const float* extent_z, const uint32_t* object_ids, size_t begin, size_t end,
+                    uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t i = begin; i < end; i += 4) {
+    __m128 x = _mm_loadu_ps(center_x + i);
+    __m128 y = _mm_loadu_ps(center_y + i);
+    __m128 z = _mm_loadu_ps(center_z + i);
+    __m128 ex = _mm_loadu_ps(extent_x + i);
+    __m128 ey = _mm_loadu_ps(extent_y + i);
+    __m128 ez = _mm_loadu_ps(extent_z + i);
+
+    __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int plane = 0; plane < 6; ++plane) {
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes.x[plane])),
+                     _mm_mul_ps(y, _mm_set1_ps(planes.y[plane]))),
+          _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(planes.z[plane])),
+                     _mm_set1_ps(planes.distance[plane])));
+      __m128 extent = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(planes.abs_x[plane])),
+                     _mm_mul_ps(ey, _mm_set1_ps(planes.abs_y[plane]))),
+          _mm_mul_ps(ez, _mm_set1_ps(planes.abs_z[plane])));
+      visible = _mm_and_ps(visible,
+                           _mm_cmpge_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+    }
+    visible_count += AppendVisibleIds(_mm_movemask_ps(visible), 4, object_ids + i,
+                                      visible_ids + visible_count);
+  }
+  return visible_count;
+}
+
+#endif  // defined(FRUSTUM_CULLER_HAS_SSE)
+
+#if defined(FRUSTUM_CULLER_HAS_AVX2)
+
+FRUSTUM_CULLER_TARGET_AVX2
+size_t CullSpheresAvx2(const FrustumPlanes& planes, const float* center_x,
+                       const float* center_y, const float* center_z, const float* radius,
+                       const uint32_t* object_ids, size_t begin, size_t end,
+                       uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t i = begin; i < end; i += 8) {
+    __m256 x = _mm256_loadu_ps(center_x + i);
+    __m256 y = _mm256_loadu_ps(center_y + i);
+    __m256 z = _mm256_loadu_ps(center_z + i);
+    __m256 r = _mm256_loadu_ps(radius + i);
+
+    __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int plane = 0; plane < 6; ++plane) {
+      __m256 distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(planes.x[plane])),
+                        _mm256_mul_ps(y, _mm256_set1_ps(planes.y[plane]))),
+          _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(planes.z[plane])),
+                        _mm256_set1_ps(planes.distance[plane])));
+      visible = _mm256_and_ps(
+          visible, _mm256_cmp_ps(_mm256_add_ps(distance, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    visible_count += AppendVisibleIds(_mm256_movemask_ps(visible), 8, object_ids + i,
+                                      visible_ids + visible_count);
+  }
+  return visible_count;
+}
+
+FRUSTUM_CULLER_TARGET_AVX2
+size_t CullBoxesAvx2(const FrustumPlanes& planes, const float* center_x, const float* center_y,
+                     const float* center_z, const float* extent_x, const float* extent_y,
+                     const float* extent_z, const uint32_t* object_ids, size_t begin,
+                     size_t end, uint32_t* visible_ids) {
+  size_t visible_count = 0;
+  for (size_t i = begin; i < end; i += 8) {
+    __m256 x = _mm256_loadu_ps(center_x + i);
+    __m256 y = _mm256_loadu_ps(center_y + i);
+    __m256 z = _mm256_loadu_ps(center_z + i);
+    __m256 ex = _mm256_loadu_ps(extent_x + i);
+    __m256 ey = _mm256_loadu_ps(extent_y + i);
+    __m256 ez = _mm256_loadu_ps(extent_z + i);
+
+    __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int plane = 0; plane < 6; ++plane) {
+      __m256 distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(planes.x[plane])),
+                        _mm256_mul_ps(y, _mm256_set1_ps(planes.y[plane]))),
+          _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(planes.z[plane])),
+                        _mm256_set1_ps(planes.distance[plane])));
+      __m256 extent = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(planes.abs_x[plane])),
+                        _mm256_mul_ps(ey, _mm256_set1_ps(planes.abs_y[plane]))),
+          _mm256_mul_ps(ez, _mm256_set1_ps(planes.abs_z[plane])));
+      visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(distance, extent),
+                                                     _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    visible_count += AppendVisibleIds(_mm256_movemask_ps(visible), 8, object_ids + i,
+                                      visible_ids + visible_count);
+  }
+  return visible_count;
+}
+
+#endif  // defined(FRUSTUM_CULLER_HAS_AVX2)
+
+// Grows `values` by a padding block of `fill`, if `index` is past its end.
+template <typename T>
+void PadArray(std::vector<T>& values, size_t index, T fill) {
+  if (index >= values.size())
+    values.resize(values.size() + kArrayPadding, fill);
+}
+
+}  // namespace
+
+// static
+Frustum Frustum::FromViewProjection(const glm::mat4& view_projection) {
+  // glm matrices are column-major, so rows are gathered across columns.
+  auto row = [&view_projection](int index) {
+    return glm::vec4(view_projection[0][index], view_projection[1][index],
+                     view_projection[2][index], view_projection[3][index]);
+  };
+
+  // A point is inside if -w <= x <= w, -w <= y <= w, and 0 <= z <= w in clip
+  // space. Each inequality is a plane in the space the matrix maps from.
+  Frustum frustum;
+  frustum.planes = {
+    row(3) + row(0),  // Left.
+    row(3) - row(0),  // Right.
+    row(3) + row(1),  // Top, since Vulkan's y axis points down.
+    row(3) - row(1),  // Bottom.
+    row(2),           // Near.
+    row(3) - row(2),  // Far.
+  };
+  for (glm::vec4& plane : frustum.planes) {
+    float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    plane /= length;
+  }
+  return frustum;
+}
+
+// static
+FrustumCuller::SimdLevel FrustumCuller::DetectSimdLevel() {
+#if defined(FRUSTUM_CULLER_HAS_AVX2) && defined(__GNUC__)
+  if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::kAvx2;
+#elif defined(FRUSTUM_CULLER_HAS_AVX2)
+  return SimdLevel::kAvx2;
+#endif  // defined(FRUSTUM_CULLER_HAS_AVX2) && defined(__GNUC__)
+
+#if defined(FRUSTUM_CULLER_HAS_SSE)
+  return SimdLevel::kSse;
+#else
+  return SimdLevel::kScalar;
+#endif  // defined(FRUSTUM_CULLER_HAS_SSE)
+}
+
+FrustumCuller::FrustumCuller(SimdLevel simd_level) : simd_level_(simd_level) {
+  assert(static_cast<int>(simd_level) <= static_cast<int>(DetectSimdLevel()));
+}
+
+FrustumCuller::~FrustumCuller() = default;
+
+size_t FrustumCuller::AddSphere(uint32_t object_id, const glm::vec3& center, float radius) {
+  size_t sphere_index = sphere_count_;
+  ++sphere_count_;
+
+  // Padding spheres have negative infinite radiuses, so they are behind
+  // every plane.
+  PadArray(spheres_.center_x, sphere_index, 0.0f);
+  PadArray(spheres_.center_y, sphere_index, 0.0f);
+  PadArray(spheres_.center_z, sphere_index, 0.0f);
+  PadArray(spheres_.radius, sphere_index, -std::numeric_limits<float>::infinity());
+  PadArray(spheres_.object_id, sphere_index, uint32_t{0});
+
+  spheres_.object_id[sphere_index] = object_id;
+  UpdateSphere(sphere_index, center, radius);
+  return sphere_index;
+}
+
+void FrustumCuller::UpdateSphere(size_t sphere_index, const glm::vec3& center, float radius) {
+  assert(sphere_index < sphere_count_);
+  assert(radius >= 0.0f);
+
+  spheres_.center_x[sphere_index] = center.x;
+  spheres_.center_y[sphere_index] = center.y;
+  spheres_.center_z[sphere_index] = center.z;
+  spheres_.radius[sphere_index] = radius;
+}
+
+size_t FrustumCuller::AddBox(uint32_t object_id, const glm::vec3& min, const glm::vec3& max) {
+  size_t box_index = box_count_;
+  ++box_count_;
+
+  // Padding boxes have negative infinite extents, so they are behind every
+  // plane. Zero normal components turn the extent into NaN, which also
+  // fails the test.
+  constexpr float kNegativeInfinity = -std::numeric_limits<float>::infinity();
+  PadArray(boxes_.center_x, box_index, 0.0f);
+  PadArray(boxes_.center_y, box_index, 0.0f);
+  PadArray(boxes_.center_z, box_index, 0.0f);
+  PadArray(boxes_.extent_x, box_index, kNegativeInfinity);
+  PadArray(boxes_.extent_y, box_index, kNegativeInfinity);
+  PadArray(boxes_.extent_z, box_index, kNegativeInfinity);
+  PadArray(boxes_.object_id, box_index, uint32_t{0});
+
+  boxes_.object_id[box_index] = object_id;
+  UpdateBox(box_index, min, max);
+  return box_index;
+}
+
+void FrustumCuller::UpdateBox(size_t box_index, const glm::vec3& min, const glm::vec3& max) {
+  assert(box_index < box_count_);
+  assert(min.x <= max.x && min.y <= max.y && min.z <= max.z);
+
+  boxes_.center_x[box_index] = (min.x + max.x) * 0.5f;
+  boxes_.center_y[box_index] = (min.y + max.y) * 0.5f;
+  boxes_.center_z[box_index] = (min.z + max.z) * 0.5f;
+  boxes_.extent_x[box_index] = (max.x - min.x) * 0.5f;
+  boxes_.extent_y[box_index] = (max.y - min.y) * 0.5f;
+  boxes_.extent_z[box_index] = (max.z - min.z) * 0.5f;
+}
+
+void FrustumCuller::Clear() {
+  sphere_count_ = 0;
+  spheres_ = SphereArrays();
+  box_count_ = 0;
+  boxes_ = BoxArrays();
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, std::vector<uint32_t>& visible_ids) const {
+  size_t padded_sphere_count = spheres_.radius.size();
+  size_t padded_box_count = boxes_.extent_x.size();
+  visible_ids.resize(padded_sphere_count + padded_box_count);
+
+  size_t visible_count = CullSpheres(frustum, 0, padded_sphere_count, visible_ids.data());
+  visible_count += CullBoxes(frustum, 0, padded_box_count, visible_ids.data() + visible_count);
+  visible_ids.resize(visible_count);
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, JobSystem& job_system,
+                         std::vector<uint32_t>& visible_ids) const {
+  size_t padded_sphere_count = spheres_.radius.size();
+  size_t padded_box_count = boxes_.extent_x.size();
+  size_t sphere_batch_count = (padded_sphere_count + kJobBatchSize - 1) / kJobBatchSize;
+  size_t box_batch_count = (padded_box_count + kJobBatchSize - 1) / kJobBatchSize;
+
+  // Each batch writes its IDs at the offset of its first volume, which leaves
+  // room for all the volumes in the batch. The gaps are closed afterwards.
+  visible_ids.resize(padded_sphere_count + padded_box_count);
+  std::vector<size_t> batch_visible_counts(sphere_batch_count + box_batch_count);
+  job_system.ParallelFor(
+      batch_visible_counts.size(), /*batch_size=*/1, [&](size_t begin, size_t end) {
+        for (size_t batch = begin; batch < end; ++batch) {
+          if (batch < sphere_batch_count) {
+            size_t first = batch * kJobBatchSize;
+            size_t last = std::min(padded_sphere_count, first + kJobBatchSize);
+            batch_visible_counts[batch] =
+                CullSpheres(frustum, first, last, visible_ids.data() + first);
+          } else {
+            size_t first = (batch - sphere_batch_count) * kJobBatchSize;
+            size_t last = std::min(padded_box_count, first + kJobBatchSize);
+            batch_visible_counts[batch] = CullBoxes(
+                frustum, first, last, visible_ids.data() + padded_sphere_count + first);
+          }
+        }
+      });
+
+  size_t visible_count = 0;
+  for (size_t batch = 0; batch < batch_visible_counts.size(); ++batch) {
+    size_t offset = (batch < sphere_batch_count)
+        ? batch * kJobBatchSize
+        : padded_sphere_count + (batch - sphere_batch_count) * kJobBatchSize;
+    // Batches only move left. std::copy() can't copy a range onto itself,
+    // which happens until a batch drops a volume.
+    if (offset != visible_count) {
+      auto batch_ids = visible_ids.begin() + offset;
+      std::copy(batch_ids, batch_ids + batch_visible_counts[batch],
+                visible_ids.begin() + visible_count);
+    }
+    visible_count += batch_visible_counts[batch];
+  }
+  visible_ids.resize(visible_count);
+}
+
+size_t FrustumCuller::CullSpheres(const Frustum& frustum, size_t begin, size_t end,
+                                  uint32_t* visible_ids) const {
+  assert(begin % kArrayPadding == 0 && end % kArrayPadding == 0);
+
+  FrustumPlanes planes = GetFrustumPlanes(frustum);
+  const SphereArrays& s = spheres_;
+  switch (simd_level_) {
+#if defined(FRUSTUM_CULLER_HAS_AVX2)
+    case SimdLevel::kAvx2:
+      return CullSpheresAvx2(planes, s.center_x.data(), s.center_y.data(), s.center_z.data(),
+                             s.radius.data(), s.object_id.data(), begin, end, visible_ids);
+#endif  // defined(FRUSTUM_CULLER_HAS_AVX2)
+#if defined(FRUSTUM_CULLER_HAS_SSE)
+    case SimdLevel::kSse:
+      return CullSpheresSse(planes, s.center_x.data(), s.center_y.data(), s.center_z.data(),
+                            s.radius.data(), s.object_id.data(), begin, end, visible_ids);
+#endif  // defined(FRUSTUM_CULLER_HAS_SSE)
+    default:
+      return CullSpheresScalar(planes, s.center_x.data(), s.center_y.data(), s.center_z.data(),
+                               s.radius.data(), s.object_id.data(), begin, end, visible_ids);
+  }
+}
+
+size_t FrustumCuller::CullBoxes(const Frustum& frustum, size_t begin, size_t end,
+                                uint32_t* visible_ids) const {
+  assert(begin % kArrayPadding == 0 && end % kArrayPadding == 0);
+
+  FrustumPlanes planes = GetFrustumPlanes(frustum);
+  const BoxArrays& b = boxes_;
+  switch (simd_level_) {
+#if defined(FRUSTUM_CULLER_HAS_AVX2)
+    case SimdLevel::kAvx2:
+      return CullBoxesAvx2(planes, b.center_x.data(), b.center_y.data(), b.center_z.data(),
+                           b.extent_x.data(), b.extent_y.data(), b.extent_z.data(),
+                           b.object_id.data(), begin, end, visible_ids);
+#endif  // defined(FRUSTUM_CULLER_HAS_AVX2)
+#if defined(FRUSTUM_CULLER_HAS_SSE)
+    case SimdLevel::kSse:
+      return CullBoxesSse(planes, b.center_x.data(), b.center_y.data(), b.center_z.data(),
+                          b.extent_x.data(), b.extent_y.data(), b.extent_z.data(),
+                          b.object_id.data(), begin, end, visible_ids);
+#endif  // defined(FRUSTUM_CULLER_HAS_SSE)
+    default:
+      return CullBoxesScalar(planes, b.center_x.data(), b.center_y.data(), b.center_z.data(),
+                             b.extent_x.data(), b.extent_y.data(), b.extent_z.data(),
+                             b.object_id.data(), begin, end, visible_ids);
+  }
+}
@@ -0,0 +1,119 @@
+#ifndef FRUSTUM_CULLER_H_
+#define FRUSTUM_CULLER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+class JobSystem;
+
+// The six planes bounding a camera's view volume.
+//
+// Each plane is stored as (normal, distance), with the normal pointing into
+// the volume and normalized, so dot(normal, point) + distance is the signed
+// distance from the plane to the point.
+struct Frustum {
+  std::array<glm::vec4, 6> planes;
+
+  // Extracts the planes from a view-projection matrix that maps to Vulkan's
+  // clip space, where depth ranges from 0 to 1.
+  [[nodiscard]] static Frustum FromViewProjection(const glm::mat4& view_projection);
+};
+
+// Tests many bounding volumes against a frustum at once.
+//
+// The volumes are stored as a structure of arrays, so each test loads
+// contiguous values from a few streams, and SIMD instructions test 4 or 8
+// volumes at a time. Bounding spheres are the cheapest to test. Axis-aligned
+// boxes fit long and flat objects better.
+class FrustumCuller {
+ public:
+  // Instruction sets that the culling loops can use.
+  enum class SimdLevel {
+    kScalar,
+    kSse,   // 4 volumes per instruction.
+    kAvx2,  // 8 volumes per instruction.
+  };
+
+  // The widest instruction set supported by this CPU.
+  [[nodiscard]] static SimdLevel DetectSimdLevel();
+
+  // `simd_level` must be supported by this CPU. Other levels are useful for
+  // benchmarking.
+  explicit FrustumCuller(SimdLevel simd_level = DetectSimdLevel());
+
+  FrustumCuller(const FrustumCuller&) = delete;
+  FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+  ~FrustumCuller();
+
+  // Adds an object bounded by a sphere. `object_id` is reported by Cull().
+  //
+  // Returns the index used to update the sphere.
+  size_t AddSphere(uint32_t object_id, const glm::vec3& center, float radius);
+  void UpdateSphere(size_t sphere_index, const glm::vec3& center, float radius);
+
+  // Adds an object bounded by an axis-aligned box. `object_id` is reported by
+  // Cull().
+  //
+  // Returns the index used to update the box.
+  size_t AddBox(uint32_t object_id, const glm::vec3& min, const glm::vec3& max);
+  void UpdateBox(size_t box_index, const glm::vec3& min, const glm::vec3& max);
+
+  // Removes all the bounding volumes.
+  void Clear();
+
+  [[nodiscard]] size_t SphereCount() const { return sphere_count_; }
+  [[nodiscard]] size_t BoxCount() const { return box_count_; }
+
+  // Replaces the contents of `visible_ids` with the IDs of the objects whose
+  // bounding volumes intersect `frustum`.
+  //
+  // Spheres are listed before boxes, and each in the order they were added,
+  // so draw lists built from the result are stable from frame to frame. The
+  // tests are conservative: volumes near the frustum's corners may be
+  // reported even if they don't intersect it.
+  void Cull(const Frustum& frustum, std::vector<uint32_t>& visible_ids) const;
+
+  // Like Cull(), but splits the volumes into chunks tested by `job_system`.
+  void Cull(const Frustum& frustum, JobSystem& job_system,
+            std::vector<uint32_t>& visible_ids) const;
+
+ private:
+  // Spheres and boxes are both stored as centers with extents. Sphere
+  // extents are radiuses. Box extents are half sizes along each axis.
+  //
+  // The arrays are padded to a multiple of 8 volumes with volumes that are
+  // never visible, so the SIMD loops don't need scalar remainders.
+  struct SphereArrays {
+    std::vector<float> center_x, center_y, center_z, radius;
+    std::vector<uint32_t> object_id;
+  };
+  struct BoxArrays {
+    std::vector<float> center_x, center_y, center_z, extent_x, extent_y, extent_z;
+    std::vector<uint32_t> object_id;
+  };
+
+  // Culls the volumes in [begin, end), which must be multiples of 8, and
+  // writes the visible volumes' IDs to `visible_ids`. Returns the number of
+  // IDs written.
+  size_t CullSpheres(const Frustum& frustum, size_t begin, size_t end,
+                     uint32_t* visible_ids) const;
+  size_t CullBoxes(const Frustum& frustum, size_t begin, size_t end,
+                   uint32_t* visible_ids) const;
+
+  const SimdLevel simd_level_;
+
+  size_t sphere_count_ = 0;
+  SphereArrays spheres_;
+
+  size_t box_count_ = 0;
+  BoxArrays boxes_;
+};
+
+#endif  // FRUSTUM_CULLER_H_
@@ -0,0 +1,192 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "frame_writer.h"
+#include "vulkan_command_pool.h"
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_config.h"
+#include "vulkan_device.h"
+#include "vulkan_frame_capture.h"
+#include "vulkan_instance.h"
+#include "vulkan_physical_device_list.h"
+#include "vulkan_render_target.h"
+#include "vulkan_shader_module.h"
+#include "vulkan_sync.h"
+#include "vulkan_yuv_converter.h"
+
+namespace {
+
+constexpr VkExtent2D kFrameExtent = {.width = 640, .height = 480};
+constexpr uint32_t kWorkgroupSize = 8;  // Must match shaders/pattern.comp.
+constexpr int kFramesInFlight = 2;
+constexpr int kCaptureRingSize = 3;
+
+[[nodiscard]] bool EndsWith(std::string_view text, std::string_view suffix) {
+  return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+void RecordFrame(const VulkanDevice& device, VkCommandBuffer command_buffer,
+                 const VulkanComputePipeline& pipeline, VkDescriptorSet descriptor_set,
+                 VkImage target, uint32_t frame_index) {
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .pNext = nullptr,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    .pInheritanceInfo = nullptr,
+  };
+  if (functions.vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+    std::cerr << "vkBeginCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  // The previous frame's contents are overwritten.
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = target,
+    .subresourceRange = VkImageSubresourceRange{
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = 1,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+    },
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+  pipeline.Dispatch(command_buffer, descriptor_set, &frame_index,
+                    (kFrameExtent.width + kWorkgroupSize - 1) / kWorkgroupSize,
+                    (kFrameExtent.height + kWorkgroupSize - 1) / kWorkgroupSize);
+
+  if (functions.vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+    std::cerr << "vkEndCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+}
+
+// Renders `frame_count` frames of an animation, and streams them to `output`.
+void RenderFrames(std::FILE* output, FrameWriter::Format format, int frame_count) {
+  VulkanConfig vulkan_config;
+  VulkanInstance instance(vulkan_config, "Headless Capture");
+  VulkanPhysicalDeviceList physical_devices(instance.VulkanHandle());
+  VulkanDevice device = physical_devices.CreateComputeDevice(vulkan_config);
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  VulkanRenderTarget target(device, kFrameExtent, VK_FORMAT_R8G8B8A8_UNORM,
+                            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+  VulkanComputePipeline pipeline(device, ReadSpirvFile("pattern.spv"),
+                                 {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE}, sizeof(uint32_t));
+  VkDescriptorSet descriptor_set = pipeline.AllocateDescriptorSet();
+  pipeline.BindImage(descriptor_set, /*binding=*/0, target.ViewVulkanHandle(),
+                     VK_IMAGE_LAYOUT_GENERAL);
+
+  // Y4M frames are converted on the GPU, so only 1.5 bytes per pixel are read
+  // back and the writer thread has no per-pixel work.
+  std::optional<VulkanYuvConverter> yuv_converter;
+  if (format == FrameWriter::Format::kY4m)
+    yuv_converter.emplace(device, kFrameExtent, kCaptureRingSize);
+
+  FrameWriter writer(output, format, kFrameExtent.width, kFrameExtent.height,
+                     FrameWriter::PixelOrder::kRgba);
+  VulkanFrameCapture capture(device, device.ComputeQueue(), device.ComputeQueueFamilyIndex(),
+                             kFrameExtent, writer, kCaptureRingSize,
+                             yuv_converter ? &*yuv_converter : nullptr);
+
+  VulkanCommandPool command_pool(device, device.ComputeQueueFamilyIndex(),
+                                 VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+  std::vector<VkCommandBuffer> command_buffers =
+      command_pool.AllocateCommandBuffers(kFramesInFlight);
+  std::vector<VkFence> fences;
+  for (int i = 0; i < kFramesInFlight; ++i)
+    fences.push_back(CreateVulkanFence(device, VK_FENCE_CREATE_SIGNALED_BIT));
+
+  for (int frame_index = 0; frame_index < frame_count; ++frame_index) {
+    int slot = frame_index % kFramesInFlight;
+    WaitForVulkanFence(device, fences[slot]);
+    functions.vkResetFences(device.VulkanHandle(), 1, &fences[slot]);
+
+    RecordFrame(device, command_buffers[slot], pipeline, descriptor_set, target.VulkanHandle(),
+                static_cast<uint32_t>(frame_index));
+
+    VkSubmitInfo submit_info = {
+      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext = nullptr,
+      .waitSemaphoreCount = 0,
+      .pWaitSemaphores = nullptr,
+      .pWaitDstStageMask = nullptr,
+      .commandBufferCount = 1,
+      .pCommandBuffers = &command_buffers[slot],
+      .signalSemaphoreCount = 0,
+      .pSignalSemaphores = nullptr,
+    };
+    if (functions.vkQueueSubmit(device.ComputeQueue(), 1, &submit_info, fences[slot]) !=
+        VK_SUCCESS) {
+      std::cerr << "vkQueueSubmit() failed" << std::endl;
+      std::abort();
+    }
+
+    if (yuv_converter)
+      capture.Capture(target.VulkanHandle(), target.ViewVulkanHandle(), VK_IMAGE_LAYOUT_GENERAL);
+    else
+      capture.Capture(target.VulkanHandle(), VK_IMAGE_LAYOUT_GENERAL);
+  }
+
+  capture.Flush();
+  for (VkFence fence : fences) {
+    WaitForVulkanFence(device, fence);
+    functions.vkDestroyFence(device.VulkanHandle(), fence, /*pAllocator=*/nullptr);
+  }
+}
+
+}  // namespace
+
+// Renders an animation without a window, and streams it out as a Y4M video.
+//
+// Usage: headless_capture [output_path] [frame_count]
+//
+// The video is written to stdout if `output_path` is "-" or missing, so it can
+// be piped into an encoder, such as `ffmpeg -i - out.mp4`. PPM frames are
+// written instead if `output_path` ends in ".ppm", and raw RGBA frames if it
+// ends in ".rgba".
+int main(int argc, char** argv) {
+  const char* output_path = (argc > 1) ? argv[1] : "-";
+  int frame_count = (argc > 2) ? std::atoi(argv[2]) : 120;
+
+  std::FILE* output = (std::strcmp(output_path, "-") == 0) ? stdout
+                                                           : std::fopen(output_path, "wb");
+  if (output == nullptr) {
+    std::cerr << "Failed to open " << output_path << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FrameWriter::Format format = FrameWriter::Format::kY4m;
+  if (EndsWith(output_path, ".ppm"))
+    format = FrameWriter::Format::kPpm;
+  else if (EndsWith(output_path, ".rgba"))
+    format = FrameWriter::Format::kRaw;
+
+  RenderFrames(output, format, frame_count);
+
+  if (output != stdout)
+    std::fclose(output);
+  return EXIT_SUCCESS;
+}
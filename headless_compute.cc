@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_command_pool.h"
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_config.h"
+#include "vulkan_device.h"
+#include "vulkan_instance.h"
+#include "vulkan_physical_device_list.h"
+#include "vulkan_shader_module.h"
+
+namespace {
+
+constexpr uint32_t kValueCount = 1 << 20;
+constexpr uint32_t kWorkgroupSize = 64;  // Must match shaders/square.comp.
+
+}  // namespace
+
+// Squares a large array on the GPU, without creating any windows.
+int main() {
+  VulkanConfig vulkan_config;
+  VulkanInstance instance(vulkan_config, "Headless Compute");
+
+  VulkanPhysicalDeviceList physical_devices(instance.VulkanHandle());
+  physical_devices.Print();
+  VulkanDevice device = physical_devices.CreateComputeDevice(vulkan_config);
+
+  VulkanBuffer values(device, kValueCount * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+  float* value_data = static_cast<float*>(values.MappedData());
+  for (uint32_t i = 0; i < kValueCount; ++i)
+    value_data[i] = static_cast<float>(i % 1024);
+  values.FlushMappedData();
+
+  VulkanComputePipeline pipeline(device, ReadSpirvFile("square.spv"),
+                                 {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER}, sizeof(uint32_t));
+  VkDescriptorSet descriptor_set = pipeline.AllocateDescriptorSet();
+  pipeline.BindBuffer(descriptor_set, /*binding=*/0, values.VulkanHandle());
+
+  VulkanCommandPool command_pool(device, device.ComputeQueueFamilyIndex());
+  command_pool.SubmitAndWait(device.ComputeQueue(), [&](VkCommandBuffer command_buffer) {
+    pipeline.Dispatch(command_buffer, descriptor_set, &kValueCount,
+                      (kValueCount + kWorkgroupSize - 1) / kWorkgroupSize);
+
+    VkMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    };
+    device.Functions().vkCmdPipelineBarrier(
+        command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        /*dependencyFlags=*/0, 1, &barrier, 0, nullptr, 0, nullptr);
+  });
+  values.InvalidateMappedData();
+
+  for (uint32_t i = 0; i < kValueCount; ++i) {
+    float expected = static_cast<float>(i % 1024) * static_cast<float>(i % 1024);
+    if (value_data[i] != expected) {
+      std::cerr << "Mismatch at index " << i << ": " << value_data[i] << " != " << expected
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "Squared " << kValueCount << " values\n";
+  return EXIT_SUCCESS;
+}
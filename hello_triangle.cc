@@ -1,25 +1,83 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <sstream>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <vulkan/vk_platform.h>
 #include <vulkan/vulkan_core.h>
 
+#include "frame_loop.h"
+#include "metrics_segment.h"
+#include "render_thread.h"
+#include "startup_timeline.h"
 #include "vulkan_config.h"
 #include "vulkan_device.h"
 #include "vulkan_extension_list.h"
+#include "vulkan_gpu_profiler.h"
+#include "vulkan_hud.h"
+#include "vulkan_instance.h"
 #include "vulkan_layer_list.h"
+#include "vulkan_memory_budget.h"
 #include "vulkan_physical_device_list.h"
 #include "vulkan_presentation_context.h"
+#include "vulkan_presenter.h"
+#include "vulkan_swap_chain.h"
+#include "window_event.h"
 
 namespace {
 
 constexpr int kWindowWidth = 800;
 constexpr int kwindowHeight = 600;
+constexpr int kFramesInFlight = 2;
+
+constexpr VkImageSubresourceRange kColorSubresourceRange = {
+  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+  .baseMipLevel = 0,
+  .levelCount = 1,
+  .baseArrayLayer = 0,
+  .layerCount = 1,
+};
+
+// Gives each view a distinct hue that pulses slowly, so views are easy to tell apart.
+[[nodiscard]] VkClearColorValue ViewClearColor(size_t view_index, size_t view_count,
+                                               uint64_t frame_index) {
+  constexpr float kPi = 3.14159265f;
+  float hue = 2 * kPi * static_cast<float>(view_index) / static_cast<float>(view_count);
+  float brightness = 0.6f + 0.4f * std::sin(static_cast<float>(frame_index) * 0.02f);
+  return {.float32 = {
+    brightness * (0.5f + 0.5f * std::cos(hue)),
+    brightness * (0.5f + 0.5f * std::cos(hue - 2 * kPi / 3)),
+    brightness * (0.5f + 0.5f * std::cos(hue + 2 * kPi / 3)),
+    1.0f,
+  }};
+}
+
+[[nodiscard]] const char* PresentModeName(VkPresentModeKHR present_mode) {
+  switch (present_mode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+      return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+      return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+      return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+      return "FIFO relaxed";
+    default:
+      return "other";
+  }
+}
 
 // Dispatches messages from the Vulkan validation layer to an application.
 VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallbackThunk(
@@ -30,8 +88,12 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallbackThunk(
 
 class HelloTriangleApplication {
  public:
-  HelloTriangleApplication()
-    : presentation_context_(), vulkan_config_(presentation_context_) {}
+  // Renders to `view_count` windows, scheduling frames according to `loop_mode`.
+  explicit HelloTriangleApplication(int view_count, FrameLoop::Mode loop_mode)
+    : view_count_(view_count), loop_mode_(loop_mode), startup_timeline_(), presentation_context_(),
+      layers_(), extensions_(), vulkan_config_(presentation_context_, layers_, extensions_) {
+    assert(view_count > 0);
+  }
 
   HelloTriangleApplication(const HelloTriangleApplication&) = delete;
   HelloTriangleApplication& operator=(const HelloTriangleApplication&) = delete;
@@ -41,7 +103,7 @@ class HelloTriangleApplication {
   void Run() {
     InitVulkan();
 
-    surface_->MainLoop();
+    MainLoop();
 
     TeardownVulkan();
   }
@@ -49,101 +111,127 @@ class HelloTriangleApplication {
   void OnVulkanDebugMessage(VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
                             VkDebugUtilsMessageTypeFlagsEXT message_type,
                             const VkDebugUtilsMessengerCallbackDataEXT* message_data) {
+    switch (message_severity) {
+      case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
+        ++validation_error_count_;
+        break;
+      case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
+        ++validation_warning_count_;
+        break;
+      case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
+        ++validation_info_count_;
+        break;
+      default:
+        ++validation_verbose_count_;
+        break;
+    }
+
     if (message_severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT ||
         message_type != VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT) {
       std::cerr << "Vulkan validation message: " << message_data->pMessage << std::endl;
 
-      if (message_severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+      // Best practices warnings are advice, so they don't stop the app.
+      std::string_view message_id =
+          message_data->pMessageIdName != nullptr ? message_data->pMessageIdName : "";
+      bool is_best_practice = message_id.substr(0, 13) == "BestPractices";
+      if (message_severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT &&
+          !is_best_practice) {
         std::abort();
+      }
     }
   }
 
  private:
+  // GLFW windows must be created on the main thread. They don't depend on
+  // the Vulkan instance, so another thread creates the instance and probes
+  // the physical devices in the meantime.
   void InitVulkan() {
-    VulkanLayerList layers;
-    layers.Print();
-
-    VulkanExtensionList extensions;
-    extensions.Print();
+    std::optional<VulkanPhysicalDeviceList> physical_devices;
+    std::thread vulkan_thread([this, &physical_devices]() {
+      {
+        StartupTimeline::Step step = startup_timeline_.Measure("Vulkan instance");
+        layers_.Print();
+        extensions_.Print();
+
+        CreateVulkanInstance();
+        SetupVulkanDebugMessenger();
+      }
+
+      StartupTimeline::Step step = startup_timeline_.Measure("Physical devices");
+      physical_devices.emplace(instance_->VulkanHandle());
+      physical_devices->Print();
+    });
+
+    {
+      StartupTimeline::Step step = startup_timeline_.Measure("Windows");
+      for (int i = 0; i < view_count_; ++i)
+        surfaces_.push_back(presentation_context_.CreateSurfaceWindow(kWindowWidth, kwindowHeight));
+    }
+    vulkan_thread.join();
+
+    {
+      StartupTimeline::Step step = startup_timeline_.Measure("Surfaces and device");
+      for (VulkanPresentationSurface& surface : surfaces_)
+        surface.CreateVulkanSurface(instance_->VulkanHandle());
+      SelectPhysicalDevice(*physical_devices);
+      memory_budget_.emplace(*device_);
+    }
+    {
+      StartupTimeline::Step step = startup_timeline_.Measure("Swap chains");
+      CreateSwapChains();
+    }
+    metrics_segment_.emplace();
 
-    CreateVulkanInstance();
-    SetupVulkanDebugMessenger();
-    surface_ = presentation_context_.CreateSurface(instance_, kWindowWidth, kwindowHeight);
-    SelectPhysicalDevice();
+    startup_timeline_.Finish();
+    startup_timeline_.Print(std::cout);
   }
 
   void TeardownVulkan() {
+    metrics_segment_.reset();
+    presenter_.reset();
+    hud_.reset();
+    gpu_profiler_.reset();
+    swap_chains_.clear();
+    memory_budget_.reset();
     device_.reset();
-    surface_.reset();
+    surfaces_.clear();
     TeardownVulkanDebugMessenger();
     TeardownVulkanInstance();
   }
 
   void CreateVulkanInstance() {
-    VkApplicationInfo application_info = {
-      .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-      .pNext = nullptr,
-      .pApplicationName = "Hello Triange",
-      .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
-      .pEngineName = "No engine",
-      .engineVersion = VK_MAKE_VERSION(1, 0, 0),
-      .apiVersion = VK_API_VERSION_1_1,
-    };
+    if (!vulkan_config_.WantValidation()) {
+      instance_.emplace(vulkan_config_, "Hello Triangle");
+      return;
+    }
 
-    const std::vector<const char*>& required_layers = vulkan_config_.RequiredLayers();
-    const std::vector<const char*>& required_extensions =
-        vulkan_config_.RequiredInstanceExtensions();
-    VkInstanceCreateInfo instance_create_info = {
-      .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+    // This mildly duplicates SetupVulkanValidationCallback().
+    VkDebugUtilsMessengerCreateInfoEXT messenger_create_info = {
+      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
       .pNext = nullptr,
-      .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,  // For MoltenVK.
-      .pApplicationInfo = &application_info,
-      .enabledLayerCount = static_cast<uint32_t>(required_layers.size()),
-      .ppEnabledLayerNames = required_layers.data(),
-      .enabledExtensionCount = static_cast<uint32_t>(required_extensions.size()),
-      .ppEnabledExtensionNames = required_extensions.data(),
+      .flags = 0,
+      .messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+          VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
+      .messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+          VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+      .pfnUserCallback = &VulkanDebugCallbackThunk,
+      .pUserData = static_cast<void*>(this),
     };
-
-    // This mildly duplicates SetupVulkanValidationCallback().
-    VkDebugUtilsMessengerCreateInfoEXT messenger_create_info;
-    if (vulkan_config_.WantValidation()) {
-      messenger_create_info =  {
-        .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
-        .pNext = nullptr,
-        .flags = 0,
-        .messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-            VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
-        .messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-            VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
-        .pfnUserCallback = &VulkanDebugCallbackThunk,
-        .pUserData = static_cast<void*>(this),
-      };
-      instance_create_info.pNext = &messenger_create_info;
-    }
-
-    VkResult result = vkCreateInstance(&instance_create_info, /*pAllocator=*/nullptr, &instance_);
-    if (result != VK_SUCCESS) {
-      std::cerr << "vkCreateInstance() failed" << std::endl;
-      std::abort();
-    }
+    instance_.emplace(vulkan_config_, "Hello Triangle", &messenger_create_info);
   }
 
   void TeardownVulkanInstance() {
-    assert(instance_ != VK_NULL_HANDLE);
-    vkDestroyInstance(instance_, /*pAllocator=*/nullptr);
+    assert(instance_.has_value());
+    instance_.reset();
   }
 
   void SetupVulkanDebugMessenger() {
-    assert(instance_ != VK_NULL_HANDLE);
+    assert(instance_.has_value());
 
     if (!vulkan_config_.WantValidation())
       return;
 
-    // vkCreateDebugUtilsMessengerEXT() isn't available for static linking.
-    PFN_vkCreateDebugUtilsMessengerEXT vkCreateDebugUtilsMessengerEXT = nullptr;
-    vkCreateDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
-        vkGetInstanceProcAddr(instance_, "vkCreateDebugUtilsMessengerEXT"));
-    if (!vkCreateDebugUtilsMessengerEXT) {
+    if (!instance_->Functions().vkCreateDebugUtilsMessengerEXT) {
       std::cerr << "Failed to dynamically locate vkCreateDebugUtilsMessengerEXT()" << std::endl;
       std::abort();
     }
@@ -161,8 +249,8 @@ class HelloTriangleApplication {
       .pfnUserCallback = &VulkanDebugCallbackThunk,
       .pUserData = static_cast<void*>(this),
     };
-    VkResult result = vkCreateDebugUtilsMessengerEXT(
-        instance_, &create_info, /*pAllocator=*/nullptr, &debug_messenger_);
+    VkResult result = instance_->Functions().vkCreateDebugUtilsMessengerEXT(
+        instance_->VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &debug_messenger_);
     if (result != VK_SUCCESS) {
       std::cerr << "vkCreateDebugUtilsMessengerEXT() failed" << std::endl;
       std::abort();
@@ -170,38 +258,311 @@ class HelloTriangleApplication {
   }
 
   void TeardownVulkanDebugMessenger() {
-    assert(instance_ != VK_NULL_HANDLE);
+    assert(instance_.has_value());
 
     assert(vulkan_config_.WantValidation() == (debug_messenger_ != VK_NULL_HANDLE));
     if (debug_messenger_ == VK_NULL_HANDLE)
       return;
 
-    // vkDestroyDebugUtilsMessengerEXT() isn't available for static linking.
-    PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerEXT = nullptr;
-    vkDestroyDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
-        vkGetInstanceProcAddr(instance_, "vkDestroyDebugUtilsMessengerEXT"));
-    if (!vkDestroyDebugUtilsMessengerEXT) {
+    if (!instance_->Functions().vkDestroyDebugUtilsMessengerEXT) {
       std::cerr << "Failed to dynamically locate vkDestroyDebugUtilsMessengerEXT()" << std::endl;
       std::abort();
     }
-    vkDestroyDebugUtilsMessengerEXT(instance_, debug_messenger_, /*pAllocator=*/nullptr);
+    instance_->Functions().vkDestroyDebugUtilsMessengerEXT(
+        instance_->VulkanHandle(), debug_messenger_, /*pAllocator=*/nullptr);
   }
 
-  void SelectPhysicalDevice() {
-    assert(instance_ != VK_NULL_HANDLE);
+  void SelectPhysicalDevice(VulkanPhysicalDeviceList& devices) {
+    std::vector<const VulkanPresentationSurface*> surfaces;
+    for (const VulkanPresentationSurface& surface : surfaces_)
+      surfaces.push_back(&surface);
+    device_ = devices.CreateLogicalDevice(vulkan_config_, surfaces);
+  }
 
-    VulkanPhysicalDeviceList devices(instance_);
-    devices.Print();
+  // All the swap chains share the device and its queues.
+  void CreateSwapChains() {
+    assert(device_.has_value());
 
-    device_ = devices.CreateLogicalDevice(vulkan_config_, *surface_);
+    std::vector<const VulkanSwapChain*> swap_chains;
+    for (const VulkanPresentationSurface& surface : surfaces_) {
+      swap_chains_.push_back(std::make_unique<VulkanSwapChain>(*device_, surface));
+      swap_chains.push_back(swap_chains_.back().get());
+    }
+    presenter_.emplace(*device_, std::move(swap_chains), kFramesInFlight);
+    gpu_profiler_.emplace(*device_, kFramesInFlight);
+    hud_.emplace(*device_, swap_chains_.front()->Format(), kFramesInFlight);
   }
 
+  // The main thread only processes windowing system events, and forwards
+  // input to a render thread that paces and submits frames.
+  void MainLoop() {
+    assert(presenter_.has_value());
+
+    FrameLoop::Options options;
+    options.mode = loop_mode_;
+    options.report_stats = [this](const FrameLoopStats& stats) {
+      std::cout << "FPS: " << stats.frames_per_second
+                << " CPU: " << stats.cpu_utilization * 100 << "%";
+      for (uint32_t i = 0; i < static_cast<uint32_t>(memory_budget_->HeapCount()); ++i) {
+        const VulkanHeapBudget& heap = memory_budget_->Heap(i);
+        if (heap.device_local) {
+          std::cout << " VRAM: " << (heap.usage >> 20) << " of " << (heap.budget >> 20)
+                    << " MiB";
+        }
+      }
+      std::cout << std::endl;
+      gpu_profiler_->PrintLatestFrame(std::cout);
+    };
+    RenderThread render_thread(
+        std::move(options),
+        [this](size_t surface_index, const WindowEvent& event) {
+          OnWindowEvent(surface_index, event);
+        },
+        [this]() { RenderFrame(); });
+
+    for (size_t i = 0; i < surfaces_.size(); ++i) {
+      surfaces_[i].SetEventHandler([&render_thread, i](const WindowEvent& event) {
+        (void)render_thread.PostEvent(i, event);
+      });
+    }
+
+    while (std::none_of(surfaces_.begin(), surfaces_.end(),
+                        [](const VulkanPresentationSurface& surface) {
+                          return surface.ShouldClose();
+                        })) {
+      presentation_context_.WaitEvents();
+    }
+
+    render_thread.Stop();
+    for (VulkanPresentationSurface& surface : surfaces_)
+      surface.SetEventHandler(nullptr);
+  }
+
+  // Called on the render thread.
+  void OnWindowEvent(size_t /*surface_index*/, const WindowEvent& event) {
+    if (event.type != WindowEvent::Type::kCharacter)
+      return;
+
+    // The space bar pauses the color animation. H toggles the HUD.
+    if (event.codepoint == ' ')
+      animation_paused_ = !animation_paused_;
+    if (event.codepoint == 'h' || event.codepoint == 'H')
+      hud_visible_ = !hud_visible_;
+  }
+
+  // Called on the render thread.
+  void RenderFrame() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (last_frame_time_ != std::chrono::steady_clock::time_point()) {
+      last_frame_milliseconds_ =
+          std::chrono::duration<double, std::milli>(now - last_frame_time_).count();
+      hud_->RecordFrameTime(last_frame_milliseconds_);
+      metrics_segment_->Metrics().RecordFrameTime(last_frame_milliseconds_ / 1000);
+    }
+    last_frame_time_ = now;
+
+    presenter_->RenderFrame(
+        [this](VkCommandBuffer command_buffer,
+               const std::vector<VulkanPresenter::FrameImage>& images) {
+          RecordFrame(command_buffer, images);
+        });
+    memory_budget_->Update();
+    PublishMetrics();
+    if (!animation_paused_)
+      ++frame_index_;
+  }
+
+  // Publishes the counters read by metrics_dump. Called on the render thread,
+  // after each frame.
+  void PublishMetrics() {
+    MetricsSnapshot& metrics = metrics_segment_->Metrics();
+    // The presenter submits one command buffer per frame.
+    metrics.queue_submit_count = presenter_->FrameNumber() - 1;
+
+    // Each collected frame adds its measured passes once. Time outside of
+    // measured passes doesn't count as busy.
+    if (gpu_profiler_->LatestFrameNumber() != published_gpu_frame_number_) {
+      published_gpu_frame_number_ = gpu_profiler_->LatestFrameNumber();
+      for (const VulkanGpuPassStats& pass : gpu_profiler_->LatestFrame()) {
+        if (pass.milliseconds.has_value())
+          metrics.queue_busy_seconds += *pass.milliseconds / 1000;
+      }
+    }
+
+    metrics.heap_count = static_cast<uint32_t>(
+        std::min(memory_budget_->HeapCount(), kMaxMetricsHeapCount));
+    for (uint32_t i = 0; i < metrics.heap_count; ++i) {
+      const VulkanHeapBudget& heap = memory_budget_->Heap(i);
+      metrics.heaps[i].budget_bytes = heap.budget;
+      metrics.heaps[i].usage_bytes = heap.usage;
+      metrics.heaps[i].allocated_bytes = heap.allocated;
+      metrics.heaps[i].device_local = heap.device_local ? 1 : 0;
+    }
+
+    metrics.validation_error_count = validation_error_count_.load(std::memory_order_relaxed);
+    metrics.validation_warning_count = validation_warning_count_.load(std::memory_order_relaxed);
+    metrics.validation_info_count = validation_info_count_.load(std::memory_order_relaxed);
+    metrics.validation_verbose_count = validation_verbose_count_.load(std::memory_order_relaxed);
+
+    metrics_segment_->Publish();
+  }
+
+  // Clears every view, in the same command buffer. The HUD is drawn over the
+  // first view, so it only needs a render pass for one swap chain format.
+  void RecordFrame(VkCommandBuffer command_buffer,
+                   const std::vector<VulkanPresenter::FrameImage>& images) {
+    const VulkanDeviceFunctions& functions = device_->Functions();
+    gpu_profiler_->Collect(presenter_->RetiredFrameNumber());
+    gpu_profiler_->BeginFrame(command_buffer, presenter_->FrameNumber());
+    if (hud_visible_)
+      BuildHud();
+
+    for (size_t i = 0; i < images.size(); ++i) {
+      const VulkanPresenter::FrameImage& image = images[i];
+      bool can_clear = (image.swap_chain->ImageUsage() & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+
+      VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image.image,
+        .subresourceRange = kColorSubresourceRange,
+      };
+      if (can_clear) {
+        VulkanGpuProfiler::Scope view_scope = gpu_profiler_->Measure(command_buffer, "View");
+        functions.vkCmdPipelineBarrier(
+            command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkClearColorValue clear_color = ViewClearColor(i, images.size(), frame_index_);
+        functions.vkCmdClearColorImage(command_buffer, image.image,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1,
+                                       &kColorSubresourceRange);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      }
+
+      VkPipelineStageFlags last_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+      if (hud_visible_ && i == 0) {
+        barrier.dstAccessMask =
+            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        functions.vkCmdPipelineBarrier(
+            command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, /*dependencyFlags=*/0, 0, nullptr, 0,
+            nullptr, 1, &barrier);
+
+        {
+          VulkanGpuProfiler::Scope hud_scope =
+              gpu_profiler_->Measure(command_buffer, "HUD", /*count_samples=*/true);
+          hud_->Draw(command_buffer, image.image_view, image.swap_chain->Extent());
+        }
+
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        last_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+      }
+
+      // The presentation engine doesn't need memory visibility.
+      barrier.dstAccessMask = 0;
+      barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+      functions.vkCmdPipelineBarrier(
+          command_buffer, last_stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+          /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+  }
+
+  // Lays out the latest measurements in the HUD.
+  void BuildHud() {
+    hud_->BeginFrame(presenter_->FrameNumber());
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2);
+    auto add_line = [this, &line](uint32_t color = VulkanHud::kTextColor) {
+      hud_->AddLine(line.str(), color);
+      line.str("");
+    };
+
+    line << "Frame: " << last_frame_milliseconds_ << " ms";
+    add_line();
+
+    const VulkanSwapChain& swap_chain = *swap_chains_.front();
+    line << "Present: " << PresentModeName(swap_chain.PresentMode()) << ", "
+         << swap_chain.Images().size() << " images";
+    add_line();
+    line << "Queue families: graphics " << device_->GraphicsQueueFamilyIndex() << ", present "
+         << device_->PresentationQueueFamilyIndex();
+    add_line();
+
+    // GPU results lag a few frames behind.
+    for (const VulkanGpuPassStats& pass : gpu_profiler_->LatestFrame()) {
+      line << pass.name << ": CPU " << pass.cpu_milliseconds << " ms";
+      if (pass.milliseconds.has_value())
+        line << ", GPU " << *pass.milliseconds << " ms";
+      add_line();
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(memory_budget_->HeapCount()); ++i) {
+      const VulkanHeapBudget& heap = memory_budget_->Heap(i);
+      line << "Heap " << i << (heap.device_local ? " (device): " : " (host): ")
+           << (heap.usage >> 20) << " of " << (heap.budget >> 20) << " MiB";
+      switch (heap.pressure) {
+        case VulkanMemoryPressure::kNormal:
+          add_line();
+          break;
+        case VulkanMemoryPressure::kHigh:
+          add_line(VulkanHud::Color(240, 200, 48));
+          break;
+        case VulkanMemoryPressure::kOverBudget:
+          add_line(VulkanHud::Color(240, 64, 48));
+          break;
+      }
+    }
+  }
+
+  const int view_count_;
+  const FrameLoop::Mode loop_mode_;
+  // Used by the render thread while MainLoop() runs.
+  uint64_t frame_index_ = 0;
+  bool animation_paused_ = false;
+  bool hud_visible_ = true;
+  std::chrono::steady_clock::time_point last_frame_time_;
+  double last_frame_milliseconds_ = 0;
+  uint64_t published_gpu_frame_number_ = 0;
+
+  // Counted by the debug messenger, which may run on any thread.
+  std::atomic<uint64_t> validation_error_count_ = 0;
+  std::atomic<uint64_t> validation_warning_count_ = 0;
+  std::atomic<uint64_t> validation_info_count_ = 0;
+  std::atomic<uint64_t> validation_verbose_count_ = 0;
+
+  // Constructed first, so startup is measured from the windowing system's
+  // initialization.
+  StartupTimeline startup_timeline_;
   VulkanPresentationContext presentation_context_;
+  // Enumerated once, for both VulkanConfig and the startup printout.
+  const VulkanLayerList layers_;
+  const VulkanExtensionList extensions_;
   VulkanConfig vulkan_config_;
-  VkInstance instance_ = VK_NULL_HANDLE;
+  std::optional<VulkanInstance> instance_;
   VkDebugUtilsMessengerEXT debug_messenger_ = VK_NULL_HANDLE;
-  std::optional<VulkanPresentationSurface> surface_;
+  std::vector<VulkanPresentationSurface> surfaces_;
   std::optional<VulkanDevice> device_;
+  // Updated by the render thread.
+  std::optional<VulkanMemoryBudget> memory_budget_;
+  std::vector<std::unique_ptr<VulkanSwapChain>> swap_chains_;
+  // Used by the render thread. Destroyed after the presenter waits for the GPU.
+  std::optional<VulkanGpuProfiler> gpu_profiler_;
+  std::optional<VulkanHud> hud_;
+  std::optional<VulkanPresenter> presenter_;
+  // Updated by the render thread.
+  std::optional<MetricsSegment> metrics_segment_;
 };
 
 VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallbackThunk(
@@ -219,8 +580,30 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallbackThunk(
 
 }  // namespace
 
-int main() {
-  HelloTriangleApplication app;
+// Usage: hello_triangle [view_count [continuous|capped|on-demand]]
+int main(int argc, char** argv) {
+  int view_count = (argc > 1) ? std::atoi(argv[1]) : 1;
+  if (view_count <= 0) {
+    std::cerr << "The view count must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  FrameLoop::Mode loop_mode = FrameLoop::Mode::kCapped;
+  if (argc > 2) {
+    std::string_view mode_name = argv[2];
+    if (mode_name == "continuous") {
+      loop_mode = FrameLoop::Mode::kContinuous;
+    } else if (mode_name == "capped") {
+      loop_mode = FrameLoop::Mode::kCapped;
+    } else if (mode_name == "on-demand") {
+      loop_mode = FrameLoop::Mode::kOnDemand;
+    } else {
+      std::cerr << "Unknown frame loop mode: " << mode_name << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  HelloTriangleApplication app(view_count, loop_mode);
 
   app.Run();
   return 0;
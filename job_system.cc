@@ -0,0 +1,205 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Identifies the pool and the worker running on the current thread.
+thread_local const JobSystem* current_job_system = nullptr;
+thread_local size_t current_worker_index = 0;
+
+[[nodiscard]] int DefaultWorkerCount() {
+  unsigned int hardware_threads = std::thread::hardware_concurrency();
+  return std::max(1, static_cast<int>(hardware_threads) - 1);
+}
+
+}  // namespace
+
+JobCounter::~JobCounter() {
+  assert(IsDone());
+  assert(continuations_.empty());
+}
+
+JobSystem::JobSystem(int worker_count) {
+  if (worker_count <= 0)
+    worker_count = DefaultWorkerCount();
+
+  workers_.reserve(worker_count);
+  for (int i = 0; i < worker_count; ++i)
+    workers_.push_back(std::make_unique<Worker>());
+
+  // Workers start after all the deques exist, because they steal from each
+  // other right away.
+  threads_.reserve(worker_count);
+  for (int i = 0; i < worker_count; ++i)
+    threads_.emplace_back(&JobSystem::WorkerMain, this, static_cast<size_t>(i));
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  sleep_condition_.notify_all();
+
+  for (std::thread& thread : threads_)
+    thread.join();
+
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    assert(worker->jobs.empty());
+    (void)worker;
+  }
+}
+
+void JobSystem::Schedule(std::function<void()> job, JobCounter* counter) {
+  if (counter != nullptr)
+    counter->pending_.fetch_add(1, std::memory_order_relaxed);
+  Push(Job{.function = std::move(job), .counter = counter});
+}
+
+void JobSystem::ScheduleAfter(JobCounter& dependency, std::function<void()> job,
+                              JobCounter* counter) {
+  // The job would wait for itself.
+  assert(&dependency != counter);
+
+  if (counter != nullptr)
+    counter->pending_.fetch_add(1, std::memory_order_relaxed);
+
+  {
+    std::lock_guard<std::mutex> lock(dependency.mutex_);
+    if (dependency.pending_.load(std::memory_order_acquire) != 0) {
+      dependency.continuations_.push_back(
+          JobCounter::Continuation{.job = std::move(job), .counter = counter});
+      return;
+    }
+  }
+  Push(Job{.function = std::move(job), .counter = counter});
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+  while (!counter.IsDone()) {
+    if (!RunOneJob())
+      std::this_thread::yield();
+  }
+
+  // The job that finished last may still hold the mutex. Waiting for it makes
+  // it safe to destroy the counter after this returns.
+  std::lock_guard<std::mutex> lock(counter.mutex_);
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batch_size,
+                            const std::function<void(size_t begin, size_t end)>& body) {
+  if (count == 0)
+    return;
+
+  if (batch_size == 0) {
+    size_t thread_count = workers_.size() + 1;
+    batch_size = std::max<size_t>(1, count / (thread_count * 4));
+  }
+
+  JobCounter counter;
+  for (size_t begin = 0; begin < count; begin += batch_size) {
+    size_t end = std::min(count, begin + batch_size);
+    Schedule([&body, begin, end]() { body(begin, end); }, &counter);
+  }
+  Wait(counter);
+}
+
+void JobSystem::Push(Job job) {
+  size_t worker_index = (current_job_system == this)
+      ? current_worker_index
+      : next_external_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  {
+    Worker& worker = *workers_[worker_index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.jobs.push_back(std::move(job));
+  }
+
+  work_epoch_.fetch_add(1, std::memory_order_seq_cst);
+  if (sleeping_workers_.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    sleep_condition_.notify_one();
+  }
+}
+
+bool JobSystem::RunOneJob() {
+  Job job;
+  if (!TakeJob(job))
+    return false;
+  Run(job);
+  return true;
+}
+
+bool JobSystem::TakeJob(Job& job) {
+  size_t worker_count = workers_.size();
+  bool is_worker = (current_job_system == this);
+  size_t first_victim = is_worker ? current_worker_index : 0;
+
+  if (is_worker) {
+    Worker& worker = *workers_[current_worker_index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.jobs.empty()) {
+      job = std::move(worker.jobs.back());
+      worker.jobs.pop_back();
+      return true;
+    }
+  }
+
+  for (size_t i = is_worker ? 1 : 0; i < worker_count; ++i) {
+    Worker& victim = *workers_[(first_victim + i) % worker_count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void JobSystem::Run(Job& job) {
+  job.function();
+
+  JobCounter* counter = job.counter;
+  if (counter == nullptr)
+    return;
+
+  std::vector<JobCounter::Continuation> continuations;
+  {
+    std::lock_guard<std::mutex> lock(counter->mutex_);
+    if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      continuations.swap(counter->continuations_);
+  }
+  for (JobCounter::Continuation& continuation : continuations)
+    Push(Job{.function = std::move(continuation.job), .counter = continuation.counter});
+}
+
+void JobSystem::WorkerMain(size_t worker_index) {
+  current_job_system = this;
+  current_worker_index = worker_index;
+
+  while (true) {
+    uint64_t epoch = work_epoch_.load(std::memory_order_seq_cst);
+    if (RunOneJob())
+      continue;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    if (stopping_)
+      break;
+    sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+    sleep_condition_.wait(lock, [this, epoch]() {
+      return stopping_ || work_epoch_.load(std::memory_order_seq_cst) != epoch;
+    });
+    sleeping_workers_.fetch_sub(1, std::memory_order_seq_cst);
+  }
+}
@@ -0,0 +1,137 @@
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Tracks a group of jobs, so other work can wait for them or depend on them.
+//
+// A counter must outlive the jobs it tracks. Waiting on it with
+// JobSystem::Wait() guarantees that.
+class JobCounter {
+ public:
+  JobCounter() = default;
+
+  JobCounter(const JobCounter&) = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  ~JobCounter();
+
+  // True when all the jobs tracked by this counter have finished.
+  [[nodiscard]] bool IsDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+ private:
+  friend class JobSystem;
+
+  struct Continuation {
+    std::function<void()> job;
+    JobCounter* counter;
+  };
+
+  std::atomic<int> pending_ = 0;
+
+  // Guards the transitions to zero, so the jobs scheduled by ScheduleAfter()
+  // are never lost.
+  std::mutex mutex_;
+  std::vector<Continuation> continuations_;  // Guarded by `mutex_`.
+};
+
+// Work-stealing thread pool.
+//
+// Each worker has its own deque of jobs. Workers run their own jobs in LIFO
+// order, which is cache-friendly for jobs that schedule more jobs, and steal
+// from the other end of other workers' deques when they run out.
+//
+// Threads waiting on a JobCounter run jobs while they wait, so jobs can wait
+// on other jobs without deadlocking the pool.
+class JobSystem {
+ public:
+  // Zero `worker_count` uses one worker per hardware thread, minus one for the
+  // thread that owns the JobSystem, which usually runs jobs while waiting.
+  explicit JobSystem(int worker_count = 0);
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // All scheduled jobs must have finished.
+  ~JobSystem();
+
+  [[nodiscard]] int WorkerCount() const { return static_cast<int>(workers_.size()); }
+
+  // Runs `job` on the pool. `counter`, if not null, tracks the job.
+  //
+  // May be called from any thread, including from jobs.
+  void Schedule(std::function<void()> job, JobCounter* counter = nullptr);
+
+  // Runs `job` after all the jobs tracked by `dependency` finish.
+  //
+  // `counter` starts tracking `job` right away, so it can be waited on before
+  // `job` is scheduled.
+  void ScheduleAfter(JobCounter& dependency, std::function<void()> job,
+                     JobCounter* counter = nullptr);
+
+  // Blocks until all the jobs tracked by `counter` finish, running jobs in the
+  // meantime.
+  void Wait(JobCounter& counter);
+
+  // Calls `body(begin, end)` for consecutive ranges covering [0, `count`),
+  // and waits for all of them.
+  //
+  // Zero `batch_size` picks a size that gives each thread a few batches to
+  // balance the load.
+  void ParallelFor(size_t count, size_t batch_size,
+                   const std::function<void(size_t begin, size_t end)>& body);
+
+ private:
+  struct Job {
+    std::function<void()> function;
+    JobCounter* counter = nullptr;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Job> jobs;  // Guarded by `mutex`.
+  };
+
+  void Push(Job job);
+
+  // Returns false if no job was found.
+  bool RunOneJob();
+
+  // Takes a job from the current worker's deque, or steals one.
+  bool TakeJob(Job& job);
+
+  void Run(Job& job);
+
+  void WorkerMain(size_t worker_index);
+
+  // Unique pointers keep the workers' mutexes at stable addresses.
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Distributes the jobs scheduled from outside the pool.
+  std::atomic<size_t> next_external_worker_ = 0;
+
+  // Idle workers sleep until `work_epoch_` changes. Schedulers only lock the
+  // mutex if a worker is sleeping. All operations on the two atomics are
+  // sequentially consistent, so either a scheduler sees a sleeping worker, or
+  // the worker sees the new epoch.
+  std::atomic<uint64_t> work_epoch_ = 0;
+  std::atomic<int> sleeping_workers_ = 0;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  bool stopping_ = false;  // Guarded by `sleep_mutex_`.
+
+  std::vector<std::thread> threads_;
+};
+
+#endif  // JOB_SYSTEM_H_
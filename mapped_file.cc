@@ -0,0 +1,94 @@
+#include "mapped_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << "Failed to open " << path << std::endl;
+    std::abort();
+  }
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0) {
+    std::cerr << "fstat() failed on " << path << std::endl;
+    std::abort();
+  }
+  size_ = static_cast<size_t>(file_stat.st_size);
+
+  // Zero-length mappings are invalid.
+  if (size_ != 0) {
+    void* mapping = ::mmap(/*addr=*/nullptr, size_, PROT_READ, MAP_PRIVATE, fd, /*offset=*/0);
+    if (mapping == MAP_FAILED) {
+      std::cerr << "mmap() failed on " << path << std::endl;
+      std::abort();
+    }
+
+    // Parsers read files front to back.
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(mapping);
+    is_mapped_ = true;
+  }
+
+  // The mapping keeps the file's contents available.
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (is_mapped_)
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+#else  // !defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    std::cerr << "Failed to open " << path << std::endl;
+    std::abort();
+  }
+
+  std::streamsize size = file.tellg();
+  buffer_.resize(static_cast<size_t>(size));
+  file.seekg(0);
+  if (!file.read(buffer_.data(), size)) {
+    std::cerr << "Failed to read " << path << std::endl;
+    std::abort();
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif  // !defined(_WIN32)
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+    : data_(std::exchange(rhs.data_, nullptr)),
+      size_(std::exchange(rhs.size_, 0)),
+      is_mapped_(std::exchange(rhs.is_mapped_, false)),
+      buffer_(std::move(rhs.buffer_)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+  std::swap(data_, rhs.data_);
+  std::swap(size_, rhs.size_);
+  std::swap(is_mapped_, rhs.is_mapped_);
+  std::swap(buffer_, rhs.buffer_);
+  return *this;
+}
@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only view of a file's contents.
+//
+// On POSIX systems the file is memory-mapped, so parsers can read it in place
+// without copying it. Other systems read the file into memory.
+class MappedFile {
+ public:
+  // Aborts if the file cannot be read.
+  explicit MappedFile(const std::string& path);
+
+  // Moving supported so instances can be returned.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&& rhs) noexcept;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+  ~MappedFile();
+
+  [[nodiscard]] std::string_view Contents() const {
+    return std::string_view(data_, size_);
+  }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+
+  // True if `data_` points to a memory mapping.
+  bool is_mapped_ = false;
+
+  // Backs `data_` when the file is not memory-mapped.
+  std::vector<char> buffer_;
+};
+
+#endif  // MAPPED_FILE_H_
@@ -0,0 +1,57 @@
+#ifndef MESH_DATA_H_
+#define MESH_DATA_H_
+
+#include <cstdint>
+#include <vector>
+
+// Interleaved vertex layout consumed by shaders/mesh.vert.
+//
+// All the attributes used by one vertex shader invocation share a cache line
+// fetch, unlike separate per-attribute streams.
+struct MeshVertex {
+  float position[3];
+  float normal[3];
+  float uv[2];
+};
+static_assert(sizeof(MeshVertex) == 32, "MeshVertex must not have padding");
+
+// Indexed triangle list, in the layout uploaded by VulkanMesh.
+struct MeshData {
+  std::vector<MeshVertex> vertices;
+
+  // Three indices per triangle, with counter-clockwise front faces.
+  std::vector<uint32_t> indices;
+};
+
+// Box that holds all the positions in a mesh.
+//
+// Quantized positions are fractions of the box's extent along each axis.
+struct MeshBounds {
+  float min[3];
+  float extent[3];
+};
+
+// Compact vertex layout consumed by shaders/mesh.vert, half of MeshVertex.
+struct QuantizedMeshVertex {
+  // 16-bit normalized fractions of the mesh's bounds. The fourth component
+  // pads the attribute to a format that all devices can fetch.
+  uint16_t position[4];
+
+  // Octahedral encoding of the unit normal, as 16-bit signed normalized values.
+  int16_t normal[2];
+
+  // Half-precision floats, which cover texture coordinates outside [0, 1].
+  uint16_t uv[2];
+};
+static_assert(sizeof(QuantizedMeshVertex) == 16, "QuantizedMeshVertex must not have padding");
+
+// Indexed triangle list with quantized vertices, produced by QuantizeMesh().
+struct QuantizedMeshData {
+  std::vector<QuantizedMeshVertex> vertices;
+  std::vector<uint32_t> indices;
+
+  // Needed to convert the quantized positions back to model space.
+  MeshBounds bounds;
+};
+
+#endif  // MESH_DATA_H_
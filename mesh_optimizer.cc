@@ -0,0 +1,376 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "mesh_data.h"
+
+namespace {
+
+// Size of the LRU cache modeled by OptimizeVertexCache(). The algorithm works
+// well for all real cache sizes, because the score decays smoothly.
+constexpr size_t kForsythCacheSize = 32;
+
+// Size of the FIFO cache used to find cluster boundaries for overdraw
+// optimization.
+constexpr size_t kClusterCacheSize = 16;
+
+// Scoring function from Forsyth's paper. Vertices used by the last triangle
+// get a fixed score, so the next triangle does not favor any of its edges.
+// Vertices used by few remaining triangles get a boost, so the algorithm
+// finishes regions instead of leaving lone triangles behind.
+[[nodiscard]] float ForsythVertexScore(int cache_position, uint32_t live_triangle_count) {
+  constexpr float kCacheDecayPower = 1.5f;
+  constexpr float kLastTriangleScore = 0.75f;
+  constexpr float kValenceBoostScale = 2.0f;
+  constexpr float kValenceBoostPower = 0.5f;
+
+  // No remaining triangle needs the vertex.
+  if (live_triangle_count == 0)
+    return -1.0f;
+
+  float score = 0.0f;
+  if (cache_position >= 0) {
+    if (cache_position < 3) {
+      score = kLastTriangleScore;
+    } else {
+      float scaled = 1.0f - static_cast<float>(cache_position - 3) /
+                                static_cast<float>(kForsythCacheSize - 3);
+      score = std::pow(scaled, kCacheDecayPower);
+    }
+  }
+  score += kValenceBoostScale *
+           std::pow(static_cast<float>(live_triangle_count), -kValenceBoostPower);
+  return score;
+}
+
+// Simulates a FIFO post-transform cache. A vertex is cached if it was
+// transformed less than `cache_size` misses ago.
+class FifoCacheModel {
+ public:
+  explicit FifoCacheModel(size_t vertex_count, size_t cache_size)
+      : cache_size_(static_cast<uint32_t>(cache_size)),
+        timestamps_(vertex_count, 0),
+        time_(cache_size_ + 1) {}
+
+  // Returns true if the vertex had to be transformed.
+  bool Access(uint32_t vertex) {
+    if (time_ - timestamps_[vertex] <= cache_size_)
+      return false;
+    timestamps_[vertex] = time_++;
+    return true;
+  }
+
+  // Evicts all vertices.
+  void Reset() { time_ += cache_size_ + 1; }
+
+ private:
+  const uint32_t cache_size_;
+  std::vector<uint32_t> timestamps_;
+  uint32_t time_;
+};
+
+// Sums of area-weighted triangle centers and normals.
+struct ClusterGeometry {
+  double weighted_center[3] = {0, 0, 0};
+  double normal[3] = {0, 0, 0};
+  double area = 0;
+
+  void AddTriangle(const float* p0, const float* p1, const float* p2) {
+    double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+    // The cross product's length is twice the triangle's area.
+    double triangle_normal[3] = {
+      e1[1] * e2[2] - e1[2] * e2[1],
+      e1[2] * e2[0] - e1[0] * e2[2],
+      e1[0] * e2[1] - e1[1] * e2[0],
+    };
+    double triangle_area = std::sqrt(triangle_normal[0] * triangle_normal[0] +
+                                     triangle_normal[1] * triangle_normal[1] +
+                                     triangle_normal[2] * triangle_normal[2]);
+    for (int k = 0; k < 3; ++k) {
+      weighted_center[k] += triangle_area * (p0[k] + p1[k] + p2[k]) / 3.0;
+      normal[k] += triangle_normal[k];
+    }
+    area += triangle_area;
+  }
+
+  void Add(const ClusterGeometry& other) {
+    for (int k = 0; k < 3; ++k) {
+      weighted_center[k] += other.weighted_center[k];
+      normal[k] += other.normal[k];
+    }
+    area += other.area;
+  }
+
+  // How far the cluster's centroid is from the mesh's centroid, along the
+  // cluster's average normal. Higher values mean the cluster is more likely
+  // to occlude the rest of the mesh.
+  [[nodiscard]] float OutwardDistance(const ClusterGeometry& mesh) const {
+    double normal_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                                     normal[2] * normal[2]);
+    if (area <= 0 || mesh.area <= 0 || normal_length <= 0)
+      return 0;
+
+    double distance = 0;
+    for (int k = 0; k < 3; ++k) {
+      double offset = weighted_center[k] / area - mesh.weighted_center[k] / mesh.area;
+      distance += offset * normal[k] / normal_length;
+    }
+    return static_cast<float>(distance);
+  }
+};
+
+[[nodiscard]] int TriangleMisses(FifoCacheModel& cache, const uint32_t* triangle) {
+  return int{cache.Access(triangle[0])} + int{cache.Access(triangle[1])} +
+         int{cache.Access(triangle[2])};
+}
+
+}  // namespace
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count) {
+  assert(indices.size() % 3 == 0);
+  size_t triangle_count = indices.size() / 3;
+  if (triangle_count == 0)
+    return;
+
+  // The triangles using each vertex are stored at
+  // triangles[offsets[v]...offsets[v] + live_triangle_counts[v]). Emitted
+  // triangles are removed from the lists.
+  std::vector<uint32_t> live_triangle_counts(vertex_count, 0);
+  for (uint32_t index : indices) {
+    assert(index < vertex_count);
+    ++live_triangle_counts[index];
+  }
+  std::vector<uint32_t> offsets(vertex_count + 1, 0);
+  for (size_t i = 0; i < vertex_count; ++i)
+    offsets[i + 1] = offsets[i] + live_triangle_counts[i];
+  std::vector<uint32_t> triangles(indices.size());
+  {
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+      triangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  std::vector<int> cache_positions(vertex_count, -1);
+  std::vector<float> vertex_scores(vertex_count);
+  for (size_t i = 0; i < vertex_count; ++i)
+    vertex_scores[i] = ForsythVertexScore(-1, live_triangle_counts[i]);
+
+  std::vector<float> triangle_scores(triangle_count);
+  for (size_t i = 0; i < triangle_count; ++i) {
+    triangle_scores[i] = vertex_scores[indices[3 * i]] + vertex_scores[indices[3 * i + 1]] +
+                         vertex_scores[indices[3 * i + 2]];
+  }
+
+  std::vector<bool> emitted(triangle_count, false);
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+
+  // Holds the vertices of the newest triangle before the cache's previous
+  // contents, so it can temporarily exceed the cache size by 3.
+  uint32_t cache[kForsythCacheSize + 3];
+  size_t cache_size = 0;
+
+  size_t best_triangle = static_cast<size_t>(
+      std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin());
+  size_t dead_end_cursor = 0;
+  for (size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+    if (best_triangle == std::numeric_limits<size_t>::max()) {
+      // No triangle uses a cached vertex. Restarting anywhere is as good as
+      // the full scan in Forsyth's paper, and keeps the algorithm linear.
+      while (emitted[dead_end_cursor])
+        ++dead_end_cursor;
+      best_triangle = dead_end_cursor;
+    }
+
+    const uint32_t* triangle = &indices[3 * best_triangle];
+    output.insert(output.end(), triangle, triangle + 3);
+    emitted[best_triangle] = true;
+
+    uint32_t new_cache[kForsythCacheSize + 3];
+    size_t new_cache_size = 0;
+    for (int i = 0; i < 3; ++i) {
+      uint32_t vertex = triangle[i];
+
+      uint32_t* vertex_triangles = &triangles[offsets[vertex]];
+      uint32_t& live_count = live_triangle_counts[vertex];
+      uint32_t* entry = std::find(vertex_triangles, vertex_triangles + live_count,
+                                  static_cast<uint32_t>(best_triangle));
+      assert(entry != vertex_triangles + live_count);
+      std::swap(*entry, vertex_triangles[live_count - 1]);
+      --live_count;
+
+      if (std::find(new_cache, new_cache + new_cache_size, vertex) == new_cache + new_cache_size)
+        new_cache[new_cache_size++] = vertex;
+    }
+    for (size_t i = 0; i < cache_size; ++i) {
+      uint32_t vertex = cache[i];
+      if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+        new_cache[new_cache_size++] = vertex;
+    }
+
+    // Updates the scores of all the vertices that entered, moved within, or
+    // left the cache, and the scores of their triangles.
+    for (size_t i = 0; i < new_cache_size; ++i) {
+      uint32_t vertex = new_cache[i];
+      int position = (i < kForsythCacheSize) ? static_cast<int>(i) : -1;
+      cache_positions[vertex] = position;
+
+      float score = ForsythVertexScore(position, live_triangle_counts[vertex]);
+      float score_delta = score - vertex_scores[vertex];
+      vertex_scores[vertex] = score;
+
+      const uint32_t* vertex_triangles = &triangles[offsets[vertex]];
+      for (uint32_t j = 0; j < live_triangle_counts[vertex]; ++j)
+        triangle_scores[vertex_triangles[j]] += score_delta;
+    }
+
+    cache_size = std::min(new_cache_size, kForsythCacheSize);
+    std::copy(new_cache, new_cache + cache_size, cache);
+
+    // The best next triangle uses at least one cached vertex, unless all of
+    // their triangles were emitted.
+    best_triangle = std::numeric_limits<size_t>::max();
+    float best_score = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < cache_size; ++i) {
+      uint32_t vertex = cache[i];
+      const uint32_t* vertex_triangles = &triangles[offsets[vertex]];
+      for (uint32_t j = 0; j < live_triangle_counts[vertex]; ++j) {
+        uint32_t candidate = vertex_triangles[j];
+        if (triangle_scores[candidate] > best_score) {
+          best_score = triangle_scores[candidate];
+          best_triangle = candidate;
+        }
+      }
+    }
+  }
+
+  indices = std::move(output);
+}
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices,
+                      float cache_miss_threshold) {
+  assert(indices.size() % 3 == 0);
+  assert(cache_miss_threshold >= 1.0f);
+  size_t triangle_count = indices.size() / 3;
+  if (triangle_count < 2)
+    return;
+
+  // Hard boundaries: triangles whose 3 vertices all miss the cache. The first
+  // triangle always starts a cluster, even if it is degenerate and only
+  // misses 2 vertices.
+  std::vector<size_t> cluster_starts = {0};
+  FifoCacheModel cache(vertices.size(), kClusterCacheSize);
+  (void)TriangleMisses(cache, &indices[0]);
+  for (size_t i = 1; i < triangle_count; ++i) {
+    if (TriangleMisses(cache, &indices[3 * i]) == 3)
+      cluster_starts.push_back(i);
+  }
+  cluster_starts.push_back(triangle_count);
+
+  // Soft boundaries: split a cluster after a prefix whose cache miss ratio is
+  // within the threshold of the whole cluster's ratio.
+  std::vector<size_t> soft_cluster_starts;
+  for (size_t c = 0; c + 1 < cluster_starts.size(); ++c) {
+    size_t start = cluster_starts[c], end = cluster_starts[c + 1];
+
+    cache.Reset();
+    int cluster_misses = 0;
+    for (size_t i = start; i < end; ++i)
+      cluster_misses += TriangleMisses(cache, &indices[3 * i]);
+    float target_ratio = cache_miss_threshold * static_cast<float>(cluster_misses) /
+                         static_cast<float>(end - start);
+
+    soft_cluster_starts.push_back(start);
+    cache.Reset();
+    int prefix_misses = 0;
+    size_t prefix_start = start;
+    for (size_t i = start; i + 1 < end; ++i) {
+      prefix_misses += TriangleMisses(cache, &indices[3 * i]);
+      float prefix_ratio =
+          static_cast<float>(prefix_misses) / static_cast<float>(i + 1 - prefix_start);
+      if (prefix_ratio <= target_ratio) {
+        soft_cluster_starts.push_back(i + 1);
+        prefix_start = i + 1;
+        prefix_misses = 0;
+        cache.Reset();
+      }
+    }
+  }
+  soft_cluster_starts.push_back(triangle_count);
+  size_t cluster_count = soft_cluster_starts.size() - 1;
+
+  // Area-weighted centroids and normals, for the mesh and for each cluster.
+  std::vector<ClusterGeometry> clusters(cluster_count);
+  ClusterGeometry mesh;
+  for (size_t c = 0; c < cluster_count; ++c) {
+    for (size_t i = soft_cluster_starts[c]; i < soft_cluster_starts[c + 1]; ++i) {
+      clusters[c].AddTriangle(vertices[indices[3 * i]].position,
+                              vertices[indices[3 * i + 1]].position,
+                              vertices[indices[3 * i + 2]].position);
+    }
+    mesh.Add(clusters[c]);
+  }
+
+  std::vector<float> cluster_sort_keys(cluster_count);
+  for (size_t c = 0; c < cluster_count; ++c)
+    cluster_sort_keys[c] = clusters[c].OutwardDistance(mesh);
+
+  std::vector<size_t> cluster_order(cluster_count);
+  for (size_t c = 0; c < cluster_count; ++c)
+    cluster_order[c] = c;
+  std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](size_t lhs, size_t rhs) {
+    return cluster_sort_keys[lhs] > cluster_sort_keys[rhs];
+  });
+
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  for (size_t cluster : cluster_order) {
+    output.insert(output.end(), indices.begin() + 3 * soft_cluster_starts[cluster],
+                  indices.begin() + 3 * soft_cluster_starts[cluster + 1]);
+  }
+  indices = std::move(output);
+}
+
+void OptimizeVertexFetch(MeshData& mesh) {
+  constexpr uint32_t kUnassigned = std::numeric_limits<uint32_t>::max();
+
+  std::vector<uint32_t> remap(mesh.vertices.size(), kUnassigned);
+  std::vector<MeshVertex> vertices;
+  vertices.reserve(mesh.vertices.size());
+  for (uint32_t& index : mesh.indices) {
+    if (remap[index] == kUnassigned) {
+      remap[index] = static_cast<uint32_t>(vertices.size());
+      vertices.push_back(mesh.vertices[index]);
+    }
+    index = remap[index];
+  }
+  mesh.vertices = std::move(vertices);
+}
+
+void OptimizeMesh(MeshData& mesh) {
+  OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+  OptimizeOverdraw(mesh.indices, mesh.vertices);
+  OptimizeVertexFetch(mesh);
+}
+
+double AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertex_count,
+                             size_t cache_size) {
+  assert(indices.size() % 3 == 0);
+  if (indices.empty())
+    return 0;
+
+  FifoCacheModel cache(vertex_count, cache_size);
+  size_t misses = 0;
+  for (uint32_t index : indices)
+    misses += cache.Access(index) ? 1 : 0;
+  return static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+}
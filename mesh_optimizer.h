@@ -0,0 +1,41 @@
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mesh_data.h"
+
+// Reorders triangles so that consecutive triangles share vertices, which
+// raises the hit rate of the GPU's post-transform vertex cache.
+//
+// Uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", which does not
+// depend on the exact cache size or replacement policy of the GPU.
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count);
+
+// Reorders the triangles produced by OptimizeVertexCache() to reduce overdraw.
+//
+// The triangles are split into clusters at the points where the vertex cache
+// would be cold anyway, or where splitting raises the cache miss ratio by at
+// most `cache_miss_threshold` times. Clusters that face away from the mesh's
+// center are drawn first, because they are likely to occlude other clusters
+// from most view directions.
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices,
+                      float cache_miss_threshold = 1.05f);
+
+// Reorders vertices in the order the triangles first use them, which improves
+// the locality of vertex fetches. Vertices that no triangle uses are removed.
+void OptimizeVertexFetch(MeshData& mesh);
+
+// Runs all the optimizations above, in the right order.
+void OptimizeMesh(MeshData& mesh);
+
+// Average number of vertex shader invocations per triangle, for a FIFO
+// post-transform cache holding `cache_size` vertices.
+//
+// 3.0 is the worst case. Well-optimized meshes get close to 0.5.
+[[nodiscard]] double AverageCacheMissRatio(const std::vector<uint32_t>& indices,
+                                           size_t vertex_count, size_t cache_size = 16);
+
+#endif  // MESH_OPTIMIZER_H_
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "mesh_data.h"
+#include "mesh_optimizer.h"
+#include "obj_mesh_loader.h"
+
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+[[nodiscard]] std::vector<Triangle> SortedTriangles(const std::vector<uint32_t>& indices) {
+  std::vector<Triangle> triangles;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+// A strip of 5 quads, preceded by a degenerate triangle.
+constexpr char kDegenerateFirstFaceObj[] =
+    "v 0 0 0\nv 1 0 0\nv 2 0 0\nv 3 0 0\n"
+    "v 0 1 0\nv 1 1 0\nv 2 1 0\nv 3 1 0\n"
+    "f 7 7 8\n"
+    "f 1 2 6\nf 1 6 5\nf 2 3 7\nf 2 7 6\nf 3 4 8\n";
+
+[[nodiscard]] bool TestOverdrawKeepsDegenerateFirstTriangle() {
+  MeshData mesh = ParseObjMesh(kDegenerateFirstFaceObj, "degenerate_first_face.obj");
+  std::vector<uint32_t> indices = mesh.indices;
+  OptimizeOverdraw(indices, mesh.vertices);
+  if (SortedTriangles(indices) != SortedTriangles(mesh.indices)) {
+    std::cerr << "OptimizeOverdraw() changed the triangles of a mesh whose first triangle is "
+              << "degenerate" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+[[nodiscard]] bool TestOptimizeMeshKeepsDegenerateTriangles() {
+  MeshData mesh = ParseObjMesh(kDegenerateFirstFaceObj, "degenerate_first_face.obj");
+  size_t triangle_count = mesh.indices.size() / 3;
+  OptimizeMesh(mesh);
+  if (mesh.indices.size() / 3 != triangle_count) {
+    std::cerr << "OptimizeMesh() output " << mesh.indices.size() / 3 << " triangles, expected "
+              << triangle_count << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool passed = true;
+  passed &= TestOverdrawKeepsDegenerateFirstTriangle();
+  passed &= TestOptimizeMeshKeepsDegenerateTriangles();
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
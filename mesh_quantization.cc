@@ -0,0 +1,173 @@
+#include "mesh_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "mesh_data.h"
+
+namespace {
+
+// Like std::copysign(1.0f, value), but maps both zeroes to 1.0f.
+[[nodiscard]] float SignNotZero(float value) { return (value < 0.0f) ? -1.0f : 1.0f; }
+
+[[nodiscard]] uint16_t QuantizeUnorm16(float value) {
+  return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+[[nodiscard]] int16_t QuantizeSnorm16(float value) {
+  return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+}  // namespace
+
+MeshBounds ComputeMeshBounds(const MeshData& mesh) {
+  MeshBounds bounds{};
+  if (mesh.vertices.empty())
+    return bounds;
+
+  float max[3];
+  for (int axis = 0; axis < 3; ++axis)
+    bounds.min[axis] = max[axis] = mesh.vertices[0].position[axis];
+  for (const MeshVertex& vertex : mesh.vertices) {
+    for (int axis = 0; axis < 3; ++axis) {
+      bounds.min[axis] = std::min(bounds.min[axis], vertex.position[axis]);
+      max[axis] = std::max(max[axis], vertex.position[axis]);
+    }
+  }
+  for (int axis = 0; axis < 3; ++axis)
+    bounds.extent[axis] = max[axis] - bounds.min[axis];
+  return bounds;
+}
+
+QuantizedMeshData QuantizeMesh(const MeshData& mesh) {
+  QuantizedMeshData quantized;
+  quantized.bounds = ComputeMeshBounds(mesh);
+  quantized.indices = mesh.indices;
+
+  // Flat axes have zero extent, and all their positions quantize to zero.
+  float inverse_extent[3];
+  for (int axis = 0; axis < 3; ++axis) {
+    float extent = quantized.bounds.extent[axis];
+    inverse_extent[axis] = (extent > 0.0f) ? 1.0f / extent : 0.0f;
+  }
+
+  quantized.vertices.reserve(mesh.vertices.size());
+  for (const MeshVertex& vertex : mesh.vertices) {
+    QuantizedMeshVertex& quantized_vertex = quantized.vertices.emplace_back();
+    for (int axis = 0; axis < 3; ++axis) {
+      quantized_vertex.position[axis] = QuantizeUnorm16(
+          (vertex.position[axis] - quantized.bounds.min[axis]) * inverse_extent[axis]);
+    }
+    quantized_vertex.position[3] = 0;
+
+    float encoded_normal[2];
+    EncodeOctahedralNormal(vertex.normal, encoded_normal);
+    quantized_vertex.normal[0] = QuantizeSnorm16(encoded_normal[0]);
+    quantized_vertex.normal[1] = QuantizeSnorm16(encoded_normal[1]);
+
+    quantized_vertex.uv[0] = FloatToHalf(vertex.uv[0]);
+    quantized_vertex.uv[1] = FloatToHalf(vertex.uv[1]);
+  }
+  return quantized;
+}
+
+void EncodeOctahedralNormal(const float normal[3], float encoded[2]) {
+  float l1_norm = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+  if (l1_norm == 0.0f) {
+    encoded[0] = encoded[1] = 0.0f;
+    return;
+  }
+
+  float x = normal[0] / l1_norm;
+  float y = normal[1] / l1_norm;
+  if (normal[2] < 0.0f) {
+    // Folds the lower half of the octahedron over the upper half's diagonals.
+    float folded_x = (1.0f - std::abs(y)) * SignNotZero(x);
+    float folded_y = (1.0f - std::abs(x)) * SignNotZero(y);
+    x = folded_x;
+    y = folded_y;
+  }
+  encoded[0] = x;
+  encoded[1] = y;
+}
+
+void DecodeOctahedralNormal(const float encoded[2], float normal[3]) {
+  float x = encoded[0];
+  float y = encoded[1];
+  float z = 1.0f - std::abs(x) - std::abs(y);
+  if (z < 0.0f) {
+    float unfolded_x = (1.0f - std::abs(y)) * SignNotZero(x);
+    float unfolded_y = (1.0f - std::abs(x)) * SignNotZero(y);
+    x = unfolded_x;
+    y = unfolded_y;
+  }
+
+  float length = std::sqrt(x * x + y * y + z * z);
+  normal[0] = x / length;
+  normal[1] = y / length;
+  normal[2] = z / length;
+}
+
+uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t exponent = (bits >> 23) & 0xff;
+  uint32_t mantissa = bits & 0x7fffff;
+
+  // Infinities stay infinite, and NaNs stay NaNs.
+  if (exponent == 0xff)
+    return static_cast<uint16_t>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+
+  int32_t half_exponent = static_cast<int32_t>(exponent) - 127 + 15;
+  if (half_exponent >= 31)
+    return static_cast<uint16_t>(sign | 0x7c00);
+
+  if (half_exponent <= 0) {
+    // Values below half of the smallest subnormal half round to zero.
+    if (half_exponent < -10)
+      return static_cast<uint16_t>(sign);
+
+    uint32_t significand = mantissa | 0x800000;
+    uint32_t shift = static_cast<uint32_t>(14 - half_exponent);
+    uint32_t half_mantissa = significand >> shift;
+    uint32_t remainder = significand & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half_mantissa & 1)))
+      ++half_mantissa;
+    return static_cast<uint16_t>(sign | half_mantissa);
+  }
+
+  // Rounding up may carry into the exponent, which is the correct result,
+  // including the overflow to infinity.
+  uint32_t half = sign | (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+  uint32_t remainder = mantissa & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    ++half;
+  return static_cast<uint16_t>(half);
+}
+
+float HalfToFloat(uint16_t half) {
+  uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exponent = (half >> 10) & 0x1f;
+  uint32_t mantissa = half & 0x3ff;
+
+  if (exponent == 0) {
+    float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -magnitude : magnitude;
+  }
+
+  uint32_t bits;
+  if (exponent == 0x1f)
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  else
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
@@ -0,0 +1,35 @@
+#ifndef MESH_QUANTIZATION_H_
+#define MESH_QUANTIZATION_H_
+
+#include <cstdint>
+
+#include "mesh_data.h"
+
+// Computes the box that holds all of `mesh`'s positions.
+[[nodiscard]] MeshBounds ComputeMeshBounds(const MeshData& mesh);
+
+// Converts `mesh` to the compact QuantizedMeshVertex layout.
+//
+// Positions keep 1/65535 of the mesh's extent along each axis, which is well
+// below a pixel for meshes that are not magnified far beyond the screen. The
+// triangles and their order are unchanged, so optimizations from
+// OptimizeMesh() carry over.
+[[nodiscard]] QuantizedMeshData QuantizeMesh(const MeshData& mesh);
+
+// Encodes a unit vector as two coordinates in [-1, 1], by projecting it onto
+// an octahedron and unfolding the octahedron's lower half.
+//
+// Unlike storing two components and reconstructing the third, the encoding
+// spreads precision evenly over the sphere.
+void EncodeOctahedralNormal(const float normal[3], float encoded[2]);
+
+// Inverse of EncodeOctahedralNormal(). The result is normalized.
+void DecodeOctahedralNormal(const float encoded[2], float normal[3]);
+
+// Converts to an IEEE 754 half-precision float, rounding to the nearest value.
+[[nodiscard]] uint16_t FloatToHalf(float value);
+
+// Converts from an IEEE 754 half-precision float. The conversion is exact.
+[[nodiscard]] float HalfToFloat(uint16_t half);
+
+#endif  // MESH_QUANTIZATION_H_
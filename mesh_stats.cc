@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "mesh_data.h"
+#include "mesh_optimizer.h"
+#include "mesh_quantization.h"
+#include "obj_mesh_loader.h"
+
+namespace {
+
+void PrintCacheStats(const char* label, const MeshData& mesh) {
+  std::cout << label << ": ACMR "
+            << AverageCacheMissRatio(mesh.indices, mesh.vertices.size(), /*cache_size=*/16)
+            << " (16 entries), "
+            << AverageCacheMissRatio(mesh.indices, mesh.vertices.size(), /*cache_size=*/32)
+            << " (32 entries)" << std::endl;
+}
+
+// Reports the memory saved by QuantizeMesh(), and the precision lost.
+void PrintQuantizationStats(const MeshData& mesh) {
+  QuantizedMeshData quantized = QuantizeMesh(mesh);
+
+  float max_position_error = 0.0f;
+  float max_normal_error_degrees = 0.0f;
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    const MeshVertex& vertex = mesh.vertices[i];
+    const QuantizedMeshVertex& quantized_vertex = quantized.vertices[i];
+
+    for (int axis = 0; axis < 3; ++axis) {
+      float fraction = quantized_vertex.position[axis] / 65535.0f;
+      float position = quantized.bounds.min[axis] + quantized.bounds.extent[axis] * fraction;
+      max_position_error =
+          std::max(max_position_error, std::abs(position - vertex.position[axis]));
+    }
+
+    float encoded_normal[2] = {quantized_vertex.normal[0] / 32767.0f,
+                               quantized_vertex.normal[1] / 32767.0f};
+    float normal[3];
+    DecodeOctahedralNormal(encoded_normal, normal);
+    float cosine = normal[0] * vertex.normal[0] + normal[1] * vertex.normal[1] +
+                   normal[2] * vertex.normal[2];
+    float error_degrees = std::acos(std::clamp(cosine, -1.0f, 1.0f)) * (180.0f / 3.14159265f);
+    max_normal_error_degrees = std::max(max_normal_error_degrees, error_degrees);
+  }
+
+  std::cout << "Vertex data: " << mesh.vertices.size() * sizeof(MeshVertex) << " bytes, "
+            << quantized.vertices.size() * sizeof(QuantizedMeshVertex)
+            << " bytes quantized. Max position error " << max_position_error
+            << ", max normal error " << max_normal_error_degrees << " degrees" << std::endl;
+}
+
+}  // namespace
+
+// Usage: mesh_stats mesh.obj
+//
+// Reports how much OptimizeMesh() reduces vertex shading work for a mesh, and
+// how much QuantizeMesh() reduces its vertex memory.
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " mesh.obj" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto load_start = std::chrono::steady_clock::now();
+  MeshData mesh = LoadObjMesh(argv[1]);
+  auto load_end = std::chrono::steady_clock::now();
+
+  std::cout << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3
+            << " triangles, loaded in "
+            << std::chrono::duration<double, std::milli>(load_end - load_start).count() << " ms"
+            << std::endl;
+  PrintCacheStats("Original", mesh);
+
+  auto optimize_start = std::chrono::steady_clock::now();
+  OptimizeMesh(mesh);
+  auto optimize_end = std::chrono::steady_clock::now();
+
+  PrintCacheStats("Optimized", mesh);
+  std::cout << "Optimized in "
+            << std::chrono::duration<double, std::milli>(optimize_end - optimize_start).count()
+            << " ms" << std::endl;
+
+  PrintQuantizationStats(mesh);
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "metrics_segment.h"
+
+// Usage: metrics_dump [segment_name]
+//
+// Prints the metrics published by a running sample in the Prometheus text
+// exposition format, for scraping through a textfile collector or an exporter
+// that runs commands.
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    std::cerr << "Usage: " << argv[0] << " [segment_name]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string name = argc == 2 ? argv[1] : kDefaultMetricsSegmentName;
+
+  std::optional<MetricsSegmentReader> reader = MetricsSegmentReader::Open(name);
+  if (!reader) {
+    std::cerr << "No metrics segment " << name << " with version " << MetricsSegment::kVersion
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::optional<MetricsSnapshot> snapshot = reader->Read();
+  if (!snapshot) {
+    std::cerr << "The publisher of " << name << " stopped while publishing" << std::endl;
+    return EXIT_FAILURE;
+  }
+  WritePrometheusMetrics(*snapshot, reader->PublishCount(), std::cout);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,282 @@
+#include "metrics_segment.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Readers copy the snapshot byte by byte, while it may be changing.
+static_assert(std::is_trivially_copyable_v<MetricsSnapshot>);
+
+struct MetricsSegment::Layout {
+  // Written last, once the rest of the header is valid.
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  // Odd while a snapshot is being published. Grows by two per Publish().
+  std::atomic<uint64_t> sequence;
+  MetricsSnapshot snapshot;
+};
+
+// Atomics shared across processes must not rely on a process-local lock.
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+namespace {
+
+// "VKMS" in little endian.
+constexpr uint32_t kMagic = 0x534d4b56;
+
+// Publishing copies a few hundred bytes, so a reader that keeps seeing a
+// publish in progress has almost certainly caught a crashed publisher.
+constexpr int kMaxReadAttempts = 1000;
+
+void InitializeLayout(MetricsSegment::Layout* layout) {
+  layout->version = MetricsSegment::kVersion;
+  layout->sequence.store(0, std::memory_order_relaxed);
+  layout->magic.store(kMagic, std::memory_order_release);
+}
+
+}  // namespace
+
+#if !defined(_WIN32)
+
+MetricsSegment::MetricsSegment(const std::string& name) : name_(name) {
+  // O_EXCL makes sure readers never see a segment from a previous run being
+  // resized. A segment still published by another process loses its name,
+  // and keeps it from being removed below.
+  ::shm_unlink(name_.c_str());
+  int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, /*mode=*/0644);
+  if (fd < 0) {
+    std::cerr << "shm_open() failed on " << name_ << std::endl;
+    std::abort();
+  }
+  if (::ftruncate(fd, sizeof(Layout)) != 0) {
+    std::cerr << "ftruncate() failed on " << name_ << std::endl;
+    std::abort();
+  }
+  struct stat segment_stat;
+  if (::fstat(fd, &segment_stat) != 0) {
+    std::cerr << "fstat() failed on " << name_ << std::endl;
+    std::abort();
+  }
+  device_id_ = static_cast<uint64_t>(segment_stat.st_dev);
+  inode_ = static_cast<uint64_t>(segment_stat.st_ino);
+
+  void* mapping = ::mmap(/*addr=*/nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, /*offset=*/0);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "mmap() failed on " << name_ << std::endl;
+    std::abort();
+  }
+  // The mapping keeps the segment alive.
+  ::close(fd);
+
+  // ftruncate() zero-filled the segment, so the magic isn't set yet.
+  layout_ = new (mapping) Layout();
+  InitializeLayout(layout_);
+}
+
+MetricsSegment::~MetricsSegment() {
+  layout_->~Layout();
+  ::munmap(layout_, sizeof(Layout));
+
+  // Another process may have replaced the segment since. Its segment must
+  // stay readable.
+  int fd = ::shm_open(name_.c_str(), O_RDONLY, /*mode=*/0);
+  if (fd < 0)
+    return;
+  struct stat segment_stat;
+  bool is_own_segment = ::fstat(fd, &segment_stat) == 0 &&
+                        static_cast<uint64_t>(segment_stat.st_dev) == device_id_ &&
+                        static_cast<uint64_t>(segment_stat.st_ino) == inode_;
+  ::close(fd);
+  if (is_own_segment)
+    ::shm_unlink(name_.c_str());
+}
+
+#else  // !defined(_WIN32)
+
+MetricsSegment::MetricsSegment(const std::string& name) : name_(name), layout_(new Layout()) {
+  InitializeLayout(layout_);
+}
+
+MetricsSegment::~MetricsSegment() { delete layout_; }
+
+#endif  // !defined(_WIN32)
+
+void MetricsSegment::Publish() {
+  // This is the only writer, so the sequence can't change under it.
+  uint64_t sequence = layout_->sequence.load(std::memory_order_relaxed);
+  layout_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  // Keeps the snapshot's writes after the odd sequence.
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(&layout_->snapshot, &metrics_, sizeof(metrics_));
+  layout_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void MetricsSnapshot::RecordFrameTime(double seconds) {
+  size_t bucket = 0;
+  while (bucket < std::size(kFrameTimeBucketBounds) && seconds > kFrameTimeBucketBounds[bucket])
+    ++bucket;
+  ++frame_time_buckets[bucket];
+  ++frame_count;
+  frame_time_sum_seconds += seconds;
+}
+
+#if !defined(_WIN32)
+
+std::optional<MetricsSegmentReader> MetricsSegmentReader::Open(const std::string& name) {
+  int fd = ::shm_open(name.c_str(), O_RDONLY, /*mode=*/0);
+  if (fd < 0)
+    return std::nullopt;
+
+  // The publisher may not have resized the segment yet.
+  struct stat segment_stat;
+  if (::fstat(fd, &segment_stat) != 0 ||
+      static_cast<size_t>(segment_stat.st_size) < sizeof(MetricsSegment::Layout)) {
+    ::close(fd);
+    return std::nullopt;
+  }
+
+  void* mapping = ::mmap(/*addr=*/nullptr, sizeof(MetricsSegment::Layout), PROT_READ,
+                         MAP_SHARED, fd, /*offset=*/0);
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+    return std::nullopt;
+
+  auto* layout = static_cast<const MetricsSegment::Layout*>(mapping);
+  if (layout->magic.load(std::memory_order_acquire) != kMagic ||
+      layout->version != MetricsSegment::kVersion) {
+    ::munmap(mapping, sizeof(MetricsSegment::Layout));
+    return std::nullopt;
+  }
+  return MetricsSegmentReader(layout);
+}
+
+MetricsSegmentReader::~MetricsSegmentReader() {
+  if (layout_ != nullptr)
+    ::munmap(const_cast<MetricsSegment::Layout*>(layout_), sizeof(MetricsSegment::Layout));
+}
+
+#else  // !defined(_WIN32)
+
+std::optional<MetricsSegmentReader> MetricsSegmentReader::Open(const std::string& name) {
+  (void)name;
+  return std::nullopt;
+}
+
+MetricsSegmentReader::~MetricsSegmentReader() = default;
+
+#endif  // !defined(_WIN32)
+
+MetricsSegmentReader::MetricsSegmentReader(const MetricsSegment::Layout* layout)
+    : layout_(layout) {}
+
+MetricsSegmentReader::MetricsSegmentReader(MetricsSegmentReader&& rhs) noexcept
+    : layout_(std::exchange(rhs.layout_, nullptr)) {}
+
+MetricsSegmentReader& MetricsSegmentReader::operator=(MetricsSegmentReader&& rhs) noexcept {
+  std::swap(layout_, rhs.layout_);
+  return *this;
+}
+
+std::optional<MetricsSnapshot> MetricsSegmentReader::Read() const {
+  for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    uint64_t sequence = layout_->sequence.load(std::memory_order_acquire);
+    if (sequence % 2 == 0) {
+      MetricsSnapshot snapshot;
+      std::memcpy(&snapshot, &layout_->snapshot, sizeof(snapshot));
+      // Keeps the snapshot's reads before the sequence is checked again.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (layout_->sequence.load(std::memory_order_relaxed) == sequence)
+        return snapshot;
+    }
+    std::this_thread::yield();
+  }
+  return std::nullopt;
+}
+
+uint64_t MetricsSegmentReader::PublishCount() const {
+  return layout_->sequence.load(std::memory_order_acquire) / 2;
+}
+
+void WritePrometheusMetrics(const MetricsSnapshot& snapshot, uint64_t publish_count,
+                            std::ostream& stream) {
+  // Bucket bounds such as 1/60 and sums of seconds need more than the
+  // default 6 digits.
+  std::streamsize old_precision = stream.precision(std::numeric_limits<double>::max_digits10);
+
+  stream << "# HELP vulkan_tutorial_frame_time_seconds Time between presented frames.\n"
+         << "# TYPE vulkan_tutorial_frame_time_seconds histogram\n";
+  uint64_t cumulative_count = 0;
+  for (size_t i = 0; i < std::size(kFrameTimeBucketBounds); ++i) {
+    cumulative_count += snapshot.frame_time_buckets[i];
+    stream << "vulkan_tutorial_frame_time_seconds_bucket{le=\"" << kFrameTimeBucketBounds[i]
+           << "\"} " << cumulative_count << "\n";
+  }
+  stream << "vulkan_tutorial_frame_time_seconds_bucket{le=\"+Inf\"} " << snapshot.frame_count
+         << "\n"
+         << "vulkan_tutorial_frame_time_seconds_sum " << snapshot.frame_time_sum_seconds << "\n"
+         << "vulkan_tutorial_frame_time_seconds_count " << snapshot.frame_count << "\n";
+
+  stream << "# HELP vulkan_tutorial_queue_submits_total Command buffer submissions.\n"
+         << "# TYPE vulkan_tutorial_queue_submits_total counter\n"
+         << "vulkan_tutorial_queue_submits_total " << snapshot.queue_submit_count << "\n"
+         << "# HELP vulkan_tutorial_queue_busy_seconds_total GPU time of measured passes.\n"
+         << "# TYPE vulkan_tutorial_queue_busy_seconds_total counter\n"
+         << "vulkan_tutorial_queue_busy_seconds_total " << snapshot.queue_busy_seconds << "\n";
+
+  const struct {
+    const char* name;
+    const char* help;
+    uint64_t MetricsSnapshot::Heap::*value;
+  } heap_metrics[] = {
+      {"vulkan_tutorial_heap_budget_bytes", "Memory the process can use without degrading.",
+       &MetricsSnapshot::Heap::budget_bytes},
+      {"vulkan_tutorial_heap_usage_bytes", "Memory the process uses.",
+       &MetricsSnapshot::Heap::usage_bytes},
+      {"vulkan_tutorial_heap_allocated_bytes", "Memory allocated through VulkanDevice.",
+       &MetricsSnapshot::Heap::allocated_bytes},
+  };
+  size_t heap_count = std::min<size_t>(snapshot.heap_count, kMaxMetricsHeapCount);
+  for (const auto& metric : heap_metrics) {
+    stream << "# HELP " << metric.name << " " << metric.help << "\n"
+           << "# TYPE " << metric.name << " gauge\n";
+    for (size_t i = 0; i < heap_count; ++i) {
+      const MetricsSnapshot::Heap& heap = snapshot.heaps[i];
+      stream << metric.name << "{heap=\"" << i << "\",device_local=\""
+             << (heap.device_local != 0 ? "true" : "false") << "\"} " << heap.*metric.value
+             << "\n";
+    }
+  }
+
+  stream << "# HELP vulkan_tutorial_validation_messages_total Debug messenger messages.\n"
+         << "# TYPE vulkan_tutorial_validation_messages_total counter\n"
+         << "vulkan_tutorial_validation_messages_total{severity=\"error\"} "
+         << snapshot.validation_error_count << "\n"
+         << "vulkan_tutorial_validation_messages_total{severity=\"warning\"} "
+         << snapshot.validation_warning_count << "\n"
+         << "vulkan_tutorial_validation_messages_total{severity=\"info\"} "
+         << snapshot.validation_info_count << "\n"
+         << "vulkan_tutorial_validation_messages_total{severity=\"verbose\"} "
+         << snapshot.validation_verbose_count << "\n";
+
+  stream << "# HELP vulkan_tutorial_metrics_publishes_total Snapshots published.\n"
+         << "# TYPE vulkan_tutorial_metrics_publishes_total counter\n"
+         << "vulkan_tutorial_metrics_publishes_total " << publish_count << "\n";
+
+  stream.precision(old_precision);
+}
@@ -0,0 +1,148 @@
+#ifndef METRICS_SEGMENT_H_
+#define METRICS_SEGMENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <string>
+
+// Name of the shared memory segment published by the samples.
+constexpr char kDefaultMetricsSegmentName[] = "/vulkan_tutorial_metrics";
+
+// Upper bounds of the frame time histogram's buckets, in seconds. The last
+// bucket has no upper bound.
+constexpr double kFrameTimeBucketBounds[] = {
+  0.004, 0.008, 1.0 / 120, 1.0 / 60, 1.0 / 30, 0.05, 0.1, 0.25,
+};
+constexpr size_t kFrameTimeBucketCount = std::size(kFrameTimeBucketBounds) + 1;
+
+// Memory heaps beyond this count are not published. Matches
+// VK_MAX_MEMORY_HEAPS, without depending on the Vulkan headers.
+constexpr size_t kMaxMetricsHeapCount = 16;
+
+// The counters published in a metrics segment.
+//
+// The layout is part of the segment's format, so it can only be changed
+// together with MetricsSegment::kVersion. Counters only grow while the
+// publishing process runs.
+struct MetricsSnapshot {
+  // Not cumulative. Bucket i counts frames that took at most
+  // kFrameTimeBucketBounds[i], and more than the previous bound.
+  uint64_t frame_time_buckets[kFrameTimeBucketCount];
+  uint64_t frame_count;
+  double frame_time_sum_seconds;
+
+  uint64_t queue_submit_count;
+
+  // GPU time measured by VulkanGpuProfiler. The queue's utilization is the
+  // rate at which this grows.
+  double queue_busy_seconds;
+
+  // Indexed by heap.
+  struct Heap {
+    uint64_t budget_bytes;
+    uint64_t usage_bytes;
+    // Allocated by VulkanDevice::AllocateMemory().
+    uint64_t allocated_bytes;
+    uint32_t device_local;
+    uint32_t padding;
+  } heaps[kMaxMetricsHeapCount];
+  uint32_t heap_count;
+  uint32_t padding;
+
+  // Messages received by the debug utils messenger, by severity.
+  uint64_t validation_error_count;
+  uint64_t validation_warning_count;
+  uint64_t validation_info_count;
+  uint64_t validation_verbose_count;
+
+  // Adds a frame to the frame time histogram.
+  void RecordFrameTime(double seconds);
+};
+
+// Publishes a MetricsSnapshot in a POSIX shared memory segment.
+//
+// Other processes read the segment with MetricsSegmentReader, without
+// interacting with the publishing process. Publishing is a sequence lock
+// write: two counter increments around a copy of the snapshot. It never
+// blocks or makes system calls, so it can be done on the render thread
+// every frame.
+//
+// On systems without POSIX shared memory, the snapshot is published to
+// private memory, where no reader can see it.
+class MetricsSegment {
+ public:
+  // Changes whenever MetricsSnapshot's layout changes.
+  static constexpr uint32_t kVersion = 1;
+
+  // Creates the segment `name`, which must start with a slash.
+  //
+  // A segment left behind by a process with the same name is replaced.
+  // Readers that mapped it keep seeing its last values. The most recently
+  // created segment keeps the name until its publisher exits.
+  explicit MetricsSegment(const std::string& name = kDefaultMetricsSegmentName);
+
+  MetricsSegment(const MetricsSegment&) = delete;
+  MetricsSegment& operator=(const MetricsSegment&) = delete;
+
+  // Removes the segment's name, unless another segment replaced it. Readers
+  // that mapped it keep seeing its last values.
+  ~MetricsSegment();
+
+  // The values written by the next Publish().
+  //
+  // Must only be used by the thread that calls Publish().
+  [[nodiscard]] MetricsSnapshot& Metrics() { return metrics_; }
+
+  // Copies Metrics() into the segment.
+  void Publish();
+
+  // The segment's layout. Shared with MetricsSegmentReader.
+  struct Layout;
+
+ private:
+  const std::string name_;
+  Layout* layout_;
+  MetricsSnapshot metrics_ = {};
+  // Identify the segment created by this instance, from fstat().
+  uint64_t device_id_ = 0;
+  uint64_t inode_ = 0;
+};
+
+// Reads the snapshots published by a MetricsSegment in another process.
+class MetricsSegmentReader {
+ public:
+  // Returns null if the segment doesn't exist, or has a different version.
+  [[nodiscard]] static std::optional<MetricsSegmentReader> Open(
+      const std::string& name = kDefaultMetricsSegmentName);
+
+  // Moving supported so instances can be returned.
+  MetricsSegmentReader(const MetricsSegmentReader&) = delete;
+  MetricsSegmentReader(MetricsSegmentReader&& rhs) noexcept;
+  MetricsSegmentReader& operator=(const MetricsSegmentReader&) = delete;
+  MetricsSegmentReader& operator=(MetricsSegmentReader&& rhs) noexcept;
+
+  ~MetricsSegmentReader();
+
+  // Returns the latest published snapshot.
+  //
+  // Retries while the snapshot is being published. Returns null if the
+  // publisher appears to have stopped in the middle of publishing.
+  [[nodiscard]] std::optional<MetricsSnapshot> Read() const;
+
+  // The number of snapshots published so far.
+  [[nodiscard]] uint64_t PublishCount() const;
+
+ private:
+  explicit MetricsSegmentReader(const MetricsSegment::Layout* layout);
+
+  const MetricsSegment::Layout* layout_;
+};
+
+// Writes `snapshot` in the Prometheus text exposition format.
+void WritePrometheusMetrics(const MetricsSnapshot& snapshot, uint64_t publish_count,
+                            std::ostream& stream);
+
+#endif  // METRICS_SEGMENT_H_
@@ -0,0 +1,352 @@
+#include "obj_mesh_loader.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh_data.h"
+
+namespace {
+
+// Identifies a unique vertex. Each member is an index into the corresponding
+// OBJ attribute list, or -1 if the face did not reference that attribute.
+struct ObjVertexKey {
+  int32_t position;
+  int32_t uv;
+  int32_t normal;
+
+  bool operator==(const ObjVertexKey& other) const {
+    return position == other.position && uv == other.uv && normal == other.normal;
+  }
+};
+
+struct ObjVertexKeyHash {
+  size_t operator()(const ObjVertexKey& key) const {
+    uint64_t hash = static_cast<uint32_t>(key.position);
+    hash = hash * 0x9e3779b97f4a7c15ull + static_cast<uint32_t>(key.uv);
+    hash = hash * 0x9e3779b97f4a7c15ull + static_cast<uint32_t>(key.normal);
+    return static_cast<size_t>(hash ^ (hash >> 29));
+  }
+};
+
+// Parses one OBJ file. The text is read in place, one line at a time.
+class ObjParser {
+ public:
+  explicit ObjParser(std::string_view text, std::string_view source_name)
+      : text_(text), source_name_(source_name) {}
+
+  ObjParser(const ObjParser&) = delete;
+  ObjParser& operator=(const ObjParser&) = delete;
+
+  [[nodiscard]] MeshData Parse() {
+    // Typical OBJ files have about as many vertices as lines.
+    vertex_indexes_.reserve(text_.size() / 32);
+
+    while (!text_.empty()) {
+      size_t line_end = text_.find('\n');
+      line_ = text_.substr(0, line_end);
+      text_.remove_prefix((line_end == std::string_view::npos) ? text_.size() : line_end + 1);
+      ++line_number_;
+      ParseLine();
+    }
+
+    ComputeMissingNormals();
+    return std::move(mesh_);
+  }
+
+ private:
+  void ParseLine() {
+    SkipSpaces();
+    if (line_.empty() || line_[0] == '#')
+      return;
+
+    std::string_view keyword = ReadToken();
+    if (keyword == "v") {
+      positions_.push_back(ReadFloat());
+      positions_.push_back(ReadFloat());
+      positions_.push_back(ReadFloat());
+      // An optional w coordinate or vertex color follows in some exporters.
+    } else if (keyword == "vt") {
+      uvs_.push_back(ReadFloat());
+      SkipSpaces();
+      uvs_.push_back(AtLineEnd() ? 0.0f : ReadFloat());
+    } else if (keyword == "vn") {
+      normals_.push_back(ReadFloat());
+      normals_.push_back(ReadFloat());
+      normals_.push_back(ReadFloat());
+    } else if (keyword == "f") {
+      ParseFace();
+    }
+  }
+
+  void ParseFace() {
+    face_vertices_.clear();
+    SkipSpaces();
+    while (!AtLineEnd()) {
+      face_vertices_.push_back(ReadFaceVertex());
+      SkipSpaces();
+    }
+    if (face_vertices_.size() < 3)
+      Fail("Face with fewer than 3 vertices");
+
+    // Triangle fan.
+    for (size_t i = 2; i < face_vertices_.size(); ++i) {
+      mesh_.indices.push_back(face_vertices_[0]);
+      mesh_.indices.push_back(face_vertices_[i - 1]);
+      mesh_.indices.push_back(face_vertices_[i]);
+    }
+  }
+
+  // Parses a v, v/vt, v//vn or v/vt/vn reference, and returns the index of
+  // the corresponding mesh vertex.
+  uint32_t ReadFaceVertex() {
+    ObjVertexKey key = {.position = -1, .uv = -1, .normal = -1};
+    key.position = ResolveIndex(ReadInteger(), positions_.size() / 3);
+    if (!line_.empty() && line_[0] == '/') {
+      line_.remove_prefix(1);
+      if (!line_.empty() && line_[0] != '/')
+        key.uv = ResolveIndex(ReadInteger(), uvs_.size() / 2);
+      if (!line_.empty() && line_[0] == '/') {
+        line_.remove_prefix(1);
+        key.normal = ResolveIndex(ReadInteger(), normals_.size() / 3);
+      }
+    }
+
+    auto [it, inserted] = vertex_indexes_.try_emplace(
+        key, static_cast<uint32_t>(mesh_.vertices.size()));
+    if (inserted)
+      mesh_.vertices.push_back(BuildVertex(key));
+    return it->second;
+  }
+
+  [[nodiscard]] MeshVertex BuildVertex(const ObjVertexKey& key) const {
+    const float* position = &positions_[3 * key.position];
+    MeshVertex vertex = {
+      .position = {position[0], position[1], position[2]},
+      .normal = {0, 0, 0},
+      .uv = {0, 0},
+    };
+    if (key.normal >= 0) {
+      const float* normal = &normals_[3 * key.normal];
+      vertex.normal[0] = normal[0];
+      vertex.normal[1] = normal[1];
+      vertex.normal[2] = normal[2];
+    }
+    if (key.uv >= 0) {
+      // OBJ texture coordinates start at the bottom of the image, Vulkan's
+      // start at the top.
+      vertex.uv[0] = uvs_[2 * key.uv];
+      vertex.uv[1] = 1.0f - uvs_[2 * key.uv + 1];
+    }
+    return vertex;
+  }
+
+  // Gives vertices without normals the area-weighted average of the normals
+  // of the faces that use them.
+  void ComputeMissingNormals() {
+    std::vector<bool> needs_normal(mesh_.vertices.size(), false);
+    bool any_missing = false;
+    for (const auto& [key, vertex_index] : vertex_indexes_) {
+      if (key.normal < 0) {
+        needs_normal[vertex_index] = true;
+        any_missing = true;
+      }
+    }
+    if (!any_missing)
+      return;
+
+    for (size_t i = 0; i < mesh_.indices.size(); i += 3) {
+      const float* p0 = mesh_.vertices[mesh_.indices[i]].position;
+      const float* p1 = mesh_.vertices[mesh_.indices[i + 1]].position;
+      const float* p2 = mesh_.vertices[mesh_.indices[i + 2]].position;
+      float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+      // The cross product's length is twice the triangle's area.
+      float face_normal[3] = {
+        e1[1] * e2[2] - e1[2] * e2[1],
+        e1[2] * e2[0] - e1[0] * e2[2],
+        e1[0] * e2[1] - e1[1] * e2[0],
+      };
+      for (size_t j = 0; j < 3; ++j) {
+        uint32_t vertex_index = mesh_.indices[i + j];
+        if (!needs_normal[vertex_index])
+          continue;
+        float* normal = mesh_.vertices[vertex_index].normal;
+        normal[0] += face_normal[0];
+        normal[1] += face_normal[1];
+        normal[2] += face_normal[2];
+      }
+    }
+
+    for (size_t i = 0; i < mesh_.vertices.size(); ++i) {
+      if (!needs_normal[i])
+        continue;
+      float* normal = mesh_.vertices[i].normal;
+      float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                               normal[2] * normal[2]);
+      if (length > 0) {
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+      } else {
+        normal[2] = 1;
+      }
+    }
+  }
+
+  // Converts a 1-based or negative OBJ index into a 0-based index.
+  int32_t ResolveIndex(int64_t obj_index, size_t element_count) {
+    int64_t index =
+        (obj_index > 0) ? obj_index - 1 : static_cast<int64_t>(element_count) + obj_index;
+    if (obj_index == 0 || index < 0 || index >= static_cast<int64_t>(element_count))
+      Fail("Index out of range");
+    return static_cast<int32_t>(index);
+  }
+
+  [[nodiscard]] bool AtLineEnd() const { return line_.empty() || line_[0] == '#'; }
+
+  void SkipSpaces() {
+    while (!line_.empty() && (line_[0] == ' ' || line_[0] == '\t' || line_[0] == '\r'))
+      line_.remove_prefix(1);
+  }
+
+  [[nodiscard]] std::string_view ReadToken() {
+    size_t length = 0;
+    while (length < line_.size() && line_[length] != ' ' && line_[length] != '\t' &&
+           line_[length] != '\r') {
+      ++length;
+    }
+    std::string_view token = line_.substr(0, length);
+    line_.remove_prefix(length);
+    return token;
+  }
+
+  [[nodiscard]] int64_t ReadInteger() {
+    bool negative = false;
+    if (!line_.empty() && (line_[0] == '-' || line_[0] == '+')) {
+      negative = (line_[0] == '-');
+      line_.remove_prefix(1);
+    }
+    if (line_.empty() || !IsDigit(line_[0]))
+      Fail("Expected an integer");
+
+    int64_t value = 0;
+    while (!line_.empty() && IsDigit(line_[0])) {
+      value = value * 10 + (line_[0] - '0');
+      if (value > INT32_MAX)
+        Fail("Integer too large");
+      line_.remove_prefix(1);
+    }
+    return negative ? -value : value;
+  }
+
+  // Parses decimal floating point numbers, with optional exponents. This
+  // avoids std::strtof(), which needs null-terminated input and consults the
+  // locale.
+  [[nodiscard]] float ReadFloat() {
+    SkipSpaces();
+    bool negative = false;
+    if (!line_.empty() && (line_[0] == '-' || line_[0] == '+')) {
+      negative = (line_[0] == '-');
+      line_.remove_prefix(1);
+    }
+
+    // 19 decimal digits always fit in 64 bits. Further digits are beyond
+    // float precision, and only shift the exponent.
+    uint64_t mantissa = 0;
+    int mantissa_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+    while (!line_.empty() && IsDigit(line_[0])) {
+      if (mantissa_digits < 19) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(line_[0] - '0');
+        if (mantissa != 0)
+          ++mantissa_digits;
+      } else {
+        ++exponent;
+      }
+      has_digits = true;
+      line_.remove_prefix(1);
+    }
+    if (!line_.empty() && line_[0] == '.') {
+      line_.remove_prefix(1);
+      while (!line_.empty() && IsDigit(line_[0])) {
+        if (mantissa_digits < 19) {
+          mantissa = mantissa * 10 + static_cast<uint64_t>(line_[0] - '0');
+          if (mantissa != 0)
+            ++mantissa_digits;
+          --exponent;
+        }
+        has_digits = true;
+        line_.remove_prefix(1);
+      }
+    }
+    if (!has_digits)
+      Fail("Expected a number");
+
+    if (!line_.empty() && (line_[0] == 'e' || line_[0] == 'E')) {
+      line_.remove_prefix(1);
+      exponent += static_cast<int>(ReadInteger());
+    }
+
+    // Powers of ten up to 1e22 are exact doubles, so the common cases need a
+    // single multiplication or division.
+    static constexpr double kPowersOfTen[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    double value = static_cast<double>(mantissa);
+    if (exponent >= 0 && exponent <= 22) {
+      value *= kPowersOfTen[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+      value /= kPowersOfTen[-exponent];
+    } else {
+      value *= std::pow(10.0, exponent);
+    }
+    return static_cast<float>(negative ? -value : value);
+  }
+
+  [[nodiscard]] static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+  [[noreturn]] void Fail(const char* message) const {
+    std::cerr << source_name_ << ":" << line_number_ << ": " << message << std::endl;
+    std::abort();
+  }
+
+  std::string_view text_;
+  const std::string_view source_name_;
+
+  std::string_view line_;
+  size_t line_number_ = 0;
+
+  // Attributes declared so far, flattened.
+  std::vector<float> positions_;
+  std::vector<float> uvs_;
+  std::vector<float> normals_;
+
+  std::vector<uint32_t> face_vertices_;
+  std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertex_indexes_;
+
+  MeshData mesh_;
+};
+
+}  // namespace
+
+MeshData ParseObjMesh(std::string_view obj_text, std::string_view source_name) {
+  ObjParser parser(obj_text, source_name);
+  return parser.Parse();
+}
+
+MeshData LoadObjMesh(const std::string& path) {
+  MappedFile file(path);
+  return ParseObjMesh(file.Contents(), path);
+}
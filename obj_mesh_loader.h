@@ -0,0 +1,23 @@
+#ifndef OBJ_MESH_LOADER_H_
+#define OBJ_MESH_LOADER_H_
+
+#include <string>
+#include <string_view>
+
+#include "mesh_data.h"
+
+// Parses the geometry in a Wavefront OBJ file.
+//
+// Supports the v, vt, vn and f statements, including negative (relative)
+// indices. Polygons are split into triangle fans. Vertices that share a
+// position, texture coordinate and normal are merged. Vertices without
+// normals get smooth normals computed from the faces that use them.
+//
+// Other statements (materials, groups, smoothing) are ignored. Aborts on
+// malformed input, reporting `source_name` and the line number.
+[[nodiscard]] MeshData ParseObjMesh(std::string_view obj_text, std::string_view source_name);
+
+// Memory-maps the OBJ file at `path` and parses it in place.
+[[nodiscard]] MeshData LoadObjMesh(const std::string& path);
+
+#endif  // OBJ_MESH_LOADER_H_
@@ -0,0 +1,98 @@
+#include "render_thread.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "frame_loop.h"
+#include "window_event.h"
+
+RenderThread::RenderThread(FrameLoop::Options loop_options, EventHandler handle_event,
+                           std::function<void()> render_frame, size_t event_queue_capacity)
+    : handle_event_(std::move(handle_event)),
+      render_frame_(std::move(render_frame)),
+      event_queue_(event_queue_capacity),
+      frame_loop_(*this, std::move(loop_options)),
+      thread_([this]() {
+        frame_loop_.Run([this]() { return stop_requested_.load(std::memory_order_acquire); },
+                        render_frame_);
+      }) {
+  assert(handle_event_);
+  assert(render_frame_);
+}
+
+RenderThread::~RenderThread() {
+  if (thread_.joinable())
+    Stop();
+}
+
+bool RenderThread::PostEvent(size_t surface_index, const WindowEvent& event) {
+  if (!event_queue_.TryPush(QueuedEvent{.surface_index = surface_index, .event = event})) {
+    dropped_event_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Read-modify-write operations on the same variable are totally ordered. If
+  // this operation comes after the one in WaitForWork(), it sees that the
+  // render thread is about to sleep. Otherwise, the render thread's operation
+  // reads this one's value, which makes the new event visible to it.
+  if (render_thread_sleeping_.fetch_add(0, std::memory_order_acq_rel) != 0) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_condition_.notify_one();
+  }
+  return true;
+}
+
+void RenderThread::Stop() {
+  assert(thread_.joinable());
+  assert(std::this_thread::get_id() != thread_.get_id());
+
+  stop_requested_.store(true, std::memory_order_release);
+  Wake();
+  thread_.join();
+}
+
+void RenderThread::PollEvents() {
+  QueuedEvent queued_event;
+  while (event_queue_.TryPop(queued_event))
+    handle_event_(queued_event.surface_index, queued_event.event);
+}
+
+void RenderThread::WaitEvents() {
+  WaitForWork(/*timeout_seconds=*/0);
+  PollEvents();
+}
+
+void RenderThread::WaitEventsTimeout(double timeout_seconds) {
+  assert(timeout_seconds > 0);
+  WaitForWork(timeout_seconds);
+  PollEvents();
+}
+
+void RenderThread::Wake() {
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wake_requested_ = true;
+  }
+  wait_condition_.notify_one();
+}
+
+void RenderThread::WaitForWork(double timeout_seconds) {
+  std::unique_lock<std::mutex> lock(wait_mutex_);
+  render_thread_sleeping_.exchange(1, std::memory_order_acq_rel);
+
+  auto has_work = [this]() { return wake_requested_ || !event_queue_.IsEmpty(); };
+  if (timeout_seconds > 0) {
+    wait_condition_.wait_for(lock, std::chrono::duration<double>(timeout_seconds), has_work);
+  } else {
+    wait_condition_.wait(lock, has_work);
+  }
+
+  wake_requested_ = false;
+  render_thread_sleeping_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,99 @@
+#ifndef RENDER_THREAD_H_
+#define RENDER_THREAD_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "event_source.h"
+#include "frame_loop.h"
+#include "spsc_queue.h"
+#include "window_event.h"
+
+// Renders frames on a dedicated thread, decoupled from the windowing system.
+//
+// The windowing system's thread forwards input with PostEvent(), and the
+// render thread handles it between frames. The two threads only share a
+// lock-free queue, so slow event processing does not delay frame submission,
+// and long frames do not delay event processing.
+class RenderThread : private EventSource {
+ public:
+  // Handles an event posted for the surface at `surface_index`.
+  using EventHandler = std::function<void(size_t surface_index, const WindowEvent& event)>;
+
+  // Starts the render thread.
+  //
+  // `handle_event` and `render_frame` are called on the render thread.
+  // `loop_options` schedules frames on the render thread, like in FrameLoop.
+  explicit RenderThread(FrameLoop::Options loop_options, EventHandler handle_event,
+                        std::function<void()> render_frame, size_t event_queue_capacity = 1024);
+
+  RenderThread(const RenderThread&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+
+  // Calls Stop() if necessary.
+  ~RenderThread() override;
+
+  // Queues an event for the render thread.
+  //
+  // Must be called on a single thread, usually the windowing system's thread.
+  // Returns false if the queue is full, in which case the event is dropped.
+  bool PostEvent(size_t surface_index, const WindowEvent& event);
+
+  // Causes a frame to be rendered soon, in FrameLoop::Mode::kOnDemand mode.
+  //
+  // May be called from any thread.
+  void RequestRedraw() { frame_loop_.RequestRedraw(); }
+
+  // Blocks until the render thread finishes its current frame and exits.
+  void Stop();
+
+  // Number of events dropped because the queue was full.
+  [[nodiscard]] uint64_t DroppedEventCount() const {
+    return dropped_event_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct QueuedEvent {
+    size_t surface_index = 0;
+    WindowEvent event;
+  };
+
+  // EventSource implementation, used by `frame_loop_` on the render thread.
+  void PollEvents() override;
+  void WaitEvents() override;
+  void WaitEventsTimeout(double timeout_seconds) override;
+  void Wake() override;
+
+  // Blocks until an event is queued, or Wake() is called.
+  //
+  // `timeout_seconds` is ignored if it's not positive.
+  void WaitForWork(double timeout_seconds);
+
+  const EventHandler handle_event_;
+  const std::function<void()> render_frame_;
+
+  SpscQueue<QueuedEvent> event_queue_;
+  std::atomic<uint64_t> dropped_event_count_ = 0;
+
+  // Lets the render thread sleep while the queue is empty. The producer only
+  // locks the mutex when the render thread is sleeping.
+  std::mutex wait_mutex_;
+  std::condition_variable wait_condition_;
+  std::atomic<int> render_thread_sleeping_ = 0;
+  bool wake_requested_ = false;  // Guarded by `wait_mutex_`.
+
+  std::atomic<bool> stop_requested_ = false;
+
+  FrameLoop frame_loop_;
+
+  // Must be the last member, so the thread starts after everything else is
+  // initialized.
+  std::thread thread_;
+};
+
+#endif  // RENDER_THREAD_H_
@@ -0,0 +1,243 @@
+#include "scene_store.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<glm::mat4> && std::is_trivially_copyable_v<glm::vec4>,
+              "Components are moved between chunk slots with memcpy()");
+
+constexpr size_t kCacheLineSize = 64;
+
+// Indexed by the components' bit positions.
+constexpr std::array<size_t, 4> kComponentSizes = {
+  sizeof(glm::mat4),
+  sizeof(glm::vec4),
+  sizeof(uint32_t),
+  sizeof(uint32_t),
+};
+
+[[nodiscard]] size_t AlignToCacheLine(size_t offset) {
+  return (offset + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+}
+
+// Lays out the arrays of a chunk holding `capacity` entities with
+// `components`. Returns the number of bytes used.
+size_t LayOutChunk(SceneComponentMask components, size_t capacity,
+                   std::array<size_t, kComponentSizes.size()>& component_offsets) {
+  size_t size = sizeof(SceneEntity) * capacity;
+  for (size_t component = 0; component < kComponentSizes.size(); ++component) {
+    component_offsets[component] = 0;
+    if (!(components & (1u << component)))
+      continue;
+    size = AlignToCacheLine(size);
+    component_offsets[component] = size;
+    size += kComponentSizes[component] * capacity;
+  }
+  return size;
+}
+
+[[nodiscard]] size_t ComponentIndex(SceneComponent component) {
+  size_t index = 0;
+  while (!(component & (1u << index)))
+    ++index;
+  return index;
+}
+
+}  // namespace
+
+SceneStore::SceneStore() = default;
+
+SceneStore::~SceneStore() = default;
+
+SceneEntity SceneStore::AddEntity(SceneComponentMask components) {
+  assert(components != 0);
+  assert((components & ~kSceneRenderable) == 0);
+
+  uint32_t archetype_index = FindOrCreateArchetype(components);
+  Archetype& archetype = archetypes_[archetype_index];
+
+  SceneEntity entity;
+  if (free_indexes_.empty()) {
+    entity = {.index = static_cast<uint32_t>(records_.size()), .generation = 0};
+    records_.push_back({});
+  } else {
+    uint32_t index = free_indexes_.back();
+    free_indexes_.pop_back();
+    entity = {.index = index, .generation = records_[index].generation};
+  }
+
+  size_t row = archetype.entity_count;
+  size_t chunk_index = row / archetype.chunk_capacity;
+  size_t slot = row % archetype.chunk_capacity;
+  if (chunk_index == archetype.chunks.size())
+    archetype.chunks.push_back(std::make_unique<Chunk>());
+  std::byte* chunk_data = archetype.chunks[chunk_index]->data;
+  ++archetype.entity_count;
+  ++entity_count_;
+
+  records_[entity.index] = {
+    .generation = entity.generation,
+    .archetype = archetype_index,
+    .row = static_cast<uint32_t>(row),
+  };
+
+  new (chunk_data + sizeof(SceneEntity) * slot) SceneEntity(entity);
+  const std::array<size_t, kComponentCount>& offsets = archetype.component_offsets;
+  if (components & kSceneTransform)
+    new (chunk_data + offsets[0] + sizeof(glm::mat4) * slot) glm::mat4(1.0f);
+  if (components & kSceneBounds)
+    new (chunk_data + offsets[1] + sizeof(glm::vec4) * slot) glm::vec4(0.0f);
+  if (components & kSceneMesh)
+    new (chunk_data + offsets[2] + sizeof(uint32_t) * slot) uint32_t(0);
+  if (components & kSceneMaterial)
+    new (chunk_data + offsets[3] + sizeof(uint32_t) * slot) uint32_t(0);
+  return entity;
+}
+
+void SceneStore::RemoveEntity(SceneEntity entity) {
+  assert(IsAlive(entity));
+
+  EntityRecord& record = records_[entity.index];
+  Archetype& archetype = archetypes_[record.archetype];
+  size_t row = record.row;
+  size_t last_row = archetype.entity_count - 1;
+
+  // Moves the archetype's last entity into the hole.
+  if (row != last_row) {
+    size_t capacity = archetype.chunk_capacity;
+    std::byte* data = archetype.chunks[row / capacity]->data;
+    std::byte* last_data = archetype.chunks[last_row / capacity]->data;
+    size_t slot = row % capacity;
+    size_t last_slot = last_row % capacity;
+
+    std::memcpy(data + sizeof(SceneEntity) * slot, last_data + sizeof(SceneEntity) * last_slot,
+                sizeof(SceneEntity));
+    for (size_t component = 0; component < kComponentCount; ++component) {
+      if (!(archetype.components & (1u << component)))
+        continue;
+      size_t offset = archetype.component_offsets[component];
+      size_t size = kComponentSizes[component];
+      std::memcpy(data + offset + size * slot, last_data + offset + size * last_slot, size);
+    }
+
+    SceneEntity moved_entity;
+    std::memcpy(&moved_entity, data + sizeof(SceneEntity) * slot, sizeof(SceneEntity));
+    records_[moved_entity.index].row = static_cast<uint32_t>(row);
+  }
+  --archetype.entity_count;
+  --entity_count_;
+
+  // One empty chunk is kept, so entities added and removed at a chunk
+  // boundary don't allocate every time.
+  size_t used_chunk_count =
+      (archetype.entity_count + archetype.chunk_capacity - 1) / archetype.chunk_capacity;
+  if (archetype.chunks.size() > used_chunk_count + 1)
+    archetype.chunks.pop_back();
+
+  record.archetype = kNoArchetype;
+  ++record.generation;
+  free_indexes_.push_back(entity.index);
+}
+
+bool SceneStore::IsAlive(SceneEntity entity) const {
+  if (entity.index >= records_.size())
+    return false;
+  const EntityRecord& record = records_[entity.index];
+  return record.generation == entity.generation && record.archetype != kNoArchetype;
+}
+
+glm::mat4& SceneStore::Transform(SceneEntity entity) {
+  return *reinterpret_cast<glm::mat4*>(ComponentAddress(entity, kSceneTransform));
+}
+
+glm::vec4& SceneStore::Bounds(SceneEntity entity) {
+  return *reinterpret_cast<glm::vec4*>(ComponentAddress(entity, kSceneBounds));
+}
+
+uint32_t& SceneStore::MeshId(SceneEntity entity) {
+  return *reinterpret_cast<uint32_t*>(ComponentAddress(entity, kSceneMesh));
+}
+
+uint32_t& SceneStore::MaterialId(SceneEntity entity) {
+  return *reinterpret_cast<uint32_t*>(ComponentAddress(entity, kSceneMaterial));
+}
+
+std::vector<SceneChunkView> SceneStore::Chunks(SceneComponentMask required_components) {
+  std::vector<SceneChunkView> chunk_views;
+  for (Archetype& archetype : archetypes_) {
+    if ((archetype.components & required_components) != required_components)
+      continue;
+
+    const std::array<size_t, kComponentCount>& offsets = archetype.component_offsets;
+    for (size_t first_row = 0; first_row < archetype.entity_count;
+         first_row += archetype.chunk_capacity) {
+      std::byte* data = archetype.chunks[first_row / archetype.chunk_capacity]->data;
+      auto component_array = [&](SceneComponent component) -> std::byte* {
+        return (archetype.components & component) ? data + offsets[ComponentIndex(component)]
+                                                  : nullptr;
+      };
+
+      SceneChunkView& view = chunk_views.emplace_back();
+      view.size_ = std::min(archetype.chunk_capacity, archetype.entity_count - first_row);
+      view.components_ = archetype.components;
+      view.entities_ = reinterpret_cast<SceneEntity*>(data);
+      view.transforms_ = reinterpret_cast<glm::mat4*>(component_array(kSceneTransform));
+      view.bounds_ = reinterpret_cast<glm::vec4*>(component_array(kSceneBounds));
+      view.mesh_ids_ = reinterpret_cast<uint32_t*>(component_array(kSceneMesh));
+      view.material_ids_ = reinterpret_cast<uint32_t*>(component_array(kSceneMaterial));
+    }
+  }
+  return chunk_views;
+}
+
+uint32_t SceneStore::FindOrCreateArchetype(SceneComponentMask components) {
+  for (size_t i = 0; i < archetypes_.size(); ++i) {
+    if (archetypes_[i].components == components)
+      return static_cast<uint32_t>(i);
+  }
+
+  Archetype& archetype = archetypes_.emplace_back();
+  archetype.components = components;
+
+  size_t entity_size = sizeof(SceneEntity);
+  for (size_t component = 0; component < kComponentCount; ++component) {
+    if (components & (1u << component))
+      entity_size += kComponentSizes[component];
+  }
+
+  // Aligning the arrays wastes up to a cache line per component.
+  archetype.chunk_capacity = kChunkSize / entity_size;
+  while (LayOutChunk(components, archetype.chunk_capacity, archetype.component_offsets) >
+         kChunkSize) {
+    --archetype.chunk_capacity;
+  }
+  assert(archetype.chunk_capacity > 0);
+  return static_cast<uint32_t>(archetypes_.size() - 1);
+}
+
+std::byte* SceneStore::ComponentAddress(SceneEntity entity, SceneComponent component) {
+  assert(IsAlive(entity));
+
+  const EntityRecord& record = records_[entity.index];
+  const Archetype& archetype = archetypes_[record.archetype];
+  assert(archetype.components & component);
+
+  size_t capacity = archetype.chunk_capacity;
+  size_t component_index = ComponentIndex(component);
+  std::byte* data = archetype.chunks[record.row / capacity]->data;
+  return data + archetype.component_offsets[component_index] +
+         kComponentSizes[component_index] * (record.row % capacity);
+}
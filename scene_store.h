@@ -0,0 +1,155 @@
+#ifndef SCENE_STORE_H_
+#define SCENE_STORE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+// Bits identifying the components an entity can have.
+enum SceneComponent : uint32_t {
+  kSceneTransform = 1 << 0,  // glm::mat4, from model space to world space.
+  kSceneBounds = 1 << 1,     // glm::vec4, model-space sphere center and radius.
+  kSceneMesh = 1 << 2,       // uint32_t mesh ID.
+  kSceneMaterial = 1 << 3,   // uint32_t material ID.
+};
+using SceneComponentMask = uint32_t;
+
+// Entities that can be drawn have all the components.
+constexpr SceneComponentMask kSceneRenderable =
+    kSceneTransform | kSceneBounds | kSceneMesh | kSceneMaterial;
+
+// Identifies an entity in a SceneStore.
+//
+// The generation tells apart entities that reuse the slot of a removed one.
+struct SceneEntity {
+  uint32_t index;
+  uint32_t generation;
+
+  [[nodiscard]] bool operator==(const SceneEntity& other) const {
+    return index == other.index && generation == other.generation;
+  }
+  [[nodiscard]] bool operator!=(const SceneEntity& other) const { return !(*this == other); }
+};
+
+// The entities in one chunk, with one array per component.
+//
+// The arrays of components that the chunk's entities don't have are null.
+// Views are invalidated by adding and removing entities.
+class SceneChunkView {
+ public:
+  [[nodiscard]] size_t Size() const { return size_; }
+  [[nodiscard]] SceneComponentMask Components() const { return components_; }
+
+  [[nodiscard]] const SceneEntity* Entities() const { return entities_; }
+  [[nodiscard]] glm::mat4* Transforms() const { return transforms_; }
+  [[nodiscard]] glm::vec4* Bounds() const { return bounds_; }
+  [[nodiscard]] uint32_t* MeshIds() const { return mesh_ids_; }
+  [[nodiscard]] uint32_t* MaterialIds() const { return material_ids_; }
+
+ private:
+  friend class SceneStore;
+
+  size_t size_;
+  SceneComponentMask components_;
+  const SceneEntity* entities_;
+  glm::mat4* transforms_;
+  glm::vec4* bounds_;
+  uint32_t* mesh_ids_;
+  uint32_t* material_ids_;
+};
+
+// Renderable entities, grouped by the set of components they have.
+//
+// Each group of entities with the same components (an archetype) is stored
+// in fixed-size chunks. Each chunk holds one cache-line-aligned array per
+// component, so systems that read a few components walk linear memory and
+// don't pull the other components into the cache.
+//
+// The entities in an archetype are packed into its first chunks. Removing an
+// entity moves the archetype's last entity into its slot, so both adding
+// and removing take constant time. Entity order within an archetype is not
+// preserved.
+class SceneStore {
+ public:
+  // Chunks are sized to fit comfortably in the L1 data cache.
+  static constexpr size_t kChunkSize = 16 * 1024;
+
+  SceneStore();
+
+  SceneStore(const SceneStore&) = delete;
+  SceneStore& operator=(const SceneStore&) = delete;
+
+  ~SceneStore();
+
+  // Adds an entity with the given components, which must not be empty.
+  //
+  // Transforms start as the identity. The other components are zeroed.
+  SceneEntity AddEntity(SceneComponentMask components);
+
+  // `entity` must be alive.
+  void RemoveEntity(SceneEntity entity);
+
+  [[nodiscard]] bool IsAlive(SceneEntity entity) const;
+
+  [[nodiscard]] size_t EntityCount() const { return entity_count_; }
+
+  // `entity` must be alive, and have the component.
+  [[nodiscard]] glm::mat4& Transform(SceneEntity entity);
+  [[nodiscard]] glm::vec4& Bounds(SceneEntity entity);
+  [[nodiscard]] uint32_t& MeshId(SceneEntity entity);
+  [[nodiscard]] uint32_t& MaterialId(SceneEntity entity);
+
+  // The non-empty chunks of the archetypes that have all the
+  // `required_components`.
+  //
+  // Chunks don't share any memory, so they can be processed in parallel, for
+  // example with JobSystem::ParallelFor().
+  [[nodiscard]] std::vector<SceneChunkView> Chunks(SceneComponentMask required_components);
+
+ private:
+  static constexpr uint32_t kNoArchetype = UINT32_MAX;
+  static constexpr size_t kComponentCount = 4;
+
+  struct alignas(64) Chunk {
+    std::byte data[kChunkSize];
+  };
+
+  // Entities with the same components.
+  struct Archetype {
+    SceneComponentMask components;
+
+    // Entities per chunk, and the offset of each component's array in a
+    // chunk, indexed by the component's bit position. The entity array is at
+    // offset 0.
+    size_t chunk_capacity;
+    std::array<size_t, kComponentCount> component_offsets;
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    size_t entity_count = 0;
+  };
+
+  // Locates an entity. Freed records have no archetype.
+  struct EntityRecord {
+    uint32_t generation;
+    uint32_t archetype;
+    uint32_t row;  // Index in the archetype. Determines the chunk.
+  };
+
+  // Returns the index of the archetype in `archetypes_`.
+  [[nodiscard]] uint32_t FindOrCreateArchetype(SceneComponentMask components);
+
+  // Address of an entity's component, in the component's array.
+  [[nodiscard]] std::byte* ComponentAddress(SceneEntity entity, SceneComponent component);
+
+  std::vector<Archetype> archetypes_;
+  std::vector<EntityRecord> records_;
+  std::vector<uint32_t> free_indexes_;
+  size_t entity_count_ = 0;
+};
+
+#endif  // SCENE_STORE_H_
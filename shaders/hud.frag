@@ -0,0 +1,33 @@
+#version 450
+
+// Glyph index for quads filled with a solid color. Matches VulkanHud.
+const uint kSolidGlyph = 0xffffffffu;
+
+// 3x5 pixel glyphs for ASCII 32 (space) through 95 (underscore). Pixel
+// (x, y) is bit y * 3 + x, with y = 0 at the top.
+const uint kFont[64] = uint[](
+  0x0000, 0x2092, 0x002d, 0x5f7d, 0x3c9e, 0x42a1, 0x6aaa, 0x0012,
+  0x4494, 0x1491, 0x0aa8, 0x05d0, 0x1400, 0x01c0, 0x2000, 0x12a4,
+  0x7b6f, 0x749a, 0x73e7, 0x79e7, 0x49ed, 0x79cf, 0x7bcf, 0x4927,
+  0x7bef, 0x79ef, 0x0410, 0x1410, 0x4454, 0x0e38, 0x1511, 0x21a7,
+  0x736f, 0x5bea, 0x3aeb, 0x624e, 0x3b6b, 0x72cf, 0x12cf, 0x6b4e,
+  0x5bed, 0x7497, 0x2b24, 0x5aed, 0x7249, 0x5bfd, 0x5b6b, 0x2b6a,
+  0x12eb, 0x676a, 0x5aeb, 0x388e, 0x2497, 0x7b6d, 0x2b6d, 0x5fed,
+  0x5aad, 0x24ad, 0x72a7, 0x324b, 0x4889, 0x6926, 0x002a, 0x7000
+);
+
+layout(location = 0) in vec2 fragGlyphCoords;
+layout(location = 1) flat in uint fragGlyph;
+layout(location = 2) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+  float coverage = 1.0;
+  if (fragGlyph != kSolidGlyph) {
+    // Glyph coordinates span [0, 3] x [0, 5] across the glyph's quad.
+    ivec2 pixel = clamp(ivec2(fragGlyphCoords), ivec2(0), ivec2(2, 4));
+    coverage = float((kFont[fragGlyph] >> (pixel.y * 3 + pixel.x)) & 1u);
+  }
+  outColor = vec4(fragColor.rgb, fragColor.a * coverage);
+}
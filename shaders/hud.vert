@@ -0,0 +1,24 @@
+#version 450
+
+// Matches VulkanHud's Vertex. Positions are in framebuffer pixels, with the
+// origin at the top-left corner.
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inGlyphCoords;
+layout(location = 2) in uint inGlyph;
+layout(location = 3) in vec4 inColor;
+
+// Matches VulkanHud's PushConstants.
+layout(push_constant) uniform PushConstants {
+  vec2 inverseTargetSize;
+} pushConstants;
+
+layout(location = 0) out vec2 fragGlyphCoords;
+layout(location = 1) flat out uint fragGlyph;
+layout(location = 2) out vec4 fragColor;
+
+void main() {
+  gl_Position = vec4(inPosition * 2.0 * pushConstants.inverseTargetSize - 1.0, 0.0, 1.0);
+  fragGlyphCoords = inGlyphCoords;
+  fragGlyph = inGlyph;
+  fragColor = inColor;
+}
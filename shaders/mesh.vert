@@ -0,0 +1,40 @@
+#version 450
+
+// Selects the vertex layout. Matches VulkanMesh::PipelineInput.
+//
+// With MeshVertex, the normal is a 3D vector. With QuantizedMeshVertex, the
+// normal is octahedral-encoded in the first two components.
+layout(constant_id = 0) const bool kOctahedralNormals = false;
+
+// Normalized integer formats are converted to floats by the vertex fetch.
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUv;
+
+// Matches VulkanMesh::PushConstants.
+layout(push_constant) uniform PushConstants {
+  mat4 modelViewProjection;
+  vec4 positionOffset;
+  vec4 positionScale;
+} pushConstants;
+
+layout(location = 0) out vec3 fragColor;
+
+vec3 DecodeOctahedralNormal(vec2 encoded) {
+  vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  if (normal.z < 0.0) {
+    vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    normal.xy = (1.0 - abs(normal.yx)) * signs;
+  }
+  return normal;
+}
+
+void main() {
+  vec3 position = pushConstants.positionOffset.xyz + pushConstants.positionScale.xyz * inPosition;
+  gl_Position = pushConstants.modelViewProjection * vec4(position, 1.0);
+
+  vec3 normal = kOctahedralNormals ? DecodeOctahedralNormal(inNormal.xy) : inNormal;
+
+  // Shades by normal direction until meshes get materials.
+  fragColor = normalize(normal) * 0.5 + 0.5;
+}
@@ -0,0 +1,77 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Lock-free bounded queue between one producer thread and one consumer thread.
+//
+// TryPush() and TryPop() never block and never allocate. Each index is written
+// by a single thread, so the only synchronization is one release store and one
+// acquire load per operation.
+template <typename T>
+class SpscQueue {
+ public:
+  // `capacity` must be a power of two.
+  explicit SpscQueue(size_t capacity)
+      : capacity_mask_(capacity - 1), slots_(std::make_unique<T[]>(capacity)) {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer only. Returns false if the queue is full.
+  [[nodiscard]] bool TryPush(T value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > capacity_mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > capacity_mask_)
+        return false;
+    }
+
+    slots_[tail & capacity_mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if the queue is empty.
+  [[nodiscard]] bool TryPop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_)
+        return false;
+    }
+
+    value = std::move(slots_[head & capacity_mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. The queue may stop being empty right after this returns.
+  [[nodiscard]] bool IsEmpty() const {
+    return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  // Keeps the producer's and the consumer's data on separate cache lines, so
+  // the threads don't invalidate each other's caches on every operation.
+  static constexpr size_t kCacheLineSize = 64;
+
+  const size_t capacity_mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  // Written by the consumer.
+  alignas(kCacheLineSize) std::atomic<size_t> head_ = 0;
+  size_t cached_tail_ = 0;
+
+  // Written by the producer.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_ = 0;
+  size_t cached_head_ = 0;
+};
+
+#endif  // SPSC_QUEUE_H_
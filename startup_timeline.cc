@@ -0,0 +1,78 @@
+#include "startup_timeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] double Milliseconds(StartupTimeline::Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}  // namespace
+
+StartupTimeline::Step::Step(StartupTimeline& timeline, std::string_view name)
+    : timeline_(timeline), name_(name), start_time_(Clock::now()) {}
+
+StartupTimeline::Step::~Step() {
+  timeline_.Record(StepRecord{
+    .name = name_,
+    .thread_id = std::this_thread::get_id(),
+    .start_time = start_time_,
+    .end_time = Clock::now(),
+  });
+}
+
+StartupTimeline::StartupTimeline() : start_time_(Clock::now()), end_time_(start_time_) {}
+
+StartupTimeline::~StartupTimeline() = default;
+
+StartupTimeline::Step StartupTimeline::Measure(std::string_view name) {
+  return Step(*this, name);
+}
+
+void StartupTimeline::Finish() {
+  end_time_ = Clock::now();
+}
+
+void StartupTimeline::Print(std::ostream& stream) const {
+  std::vector<StepRecord> steps;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    steps = steps_;
+  }
+  std::sort(steps.begin(), steps.end(), [](const StepRecord& lhs, const StepRecord& rhs) {
+    return lhs.start_time < rhs.start_time;
+  });
+
+  // Threads are numbered in the order they start steps.
+  std::vector<std::thread::id> thread_ids;
+  Clock::duration total_step_time = Clock::duration::zero();
+  stream << "Startup steps:\n";
+  for (const StepRecord& step : steps) {
+    auto thread_it = std::find(thread_ids.begin(), thread_ids.end(), step.thread_id);
+    if (thread_it == thread_ids.end())
+      thread_it = thread_ids.insert(thread_ids.end(), step.thread_id);
+
+    stream << "  [thread " << (thread_it - thread_ids.begin()) << "] " << step.name << ": "
+           << Milliseconds(step.start_time - start_time_) << " ms + "
+           << Milliseconds(step.end_time - step.start_time) << " ms\n";
+    total_step_time += step.end_time - step.start_time;
+  }
+  stream << "Startup took " << Milliseconds(end_time_ - start_time_) << " ms, steps took "
+         << Milliseconds(total_step_time) << " ms" << std::endl;
+}
+
+void StartupTimeline::Record(StepRecord record) {
+  assert(record.end_time >= record.start_time);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  steps_.push_back(std::move(record));
+}
@@ -0,0 +1,74 @@
+#ifndef STARTUP_TIMELINE_H_
+#define STARTUP_TIMELINE_H_
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Records when each startup step runs, on every thread.
+//
+// When steps overlap, the startup time is shorter than the sum of the steps'
+// durations. The report shows both, so overlapping steps can be checked for
+// actually running concurrently.
+class StartupTimeline {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Measures a step from construction to destruction.
+  class Step {
+   public:
+    Step(const Step&) = delete;
+    Step& operator=(const Step&) = delete;
+
+    ~Step();
+
+   private:
+    friend class StartupTimeline;
+
+    Step(StartupTimeline& timeline, std::string_view name);
+
+    StartupTimeline& timeline_;
+    const std::string name_;
+    const Clock::time_point start_time_;
+  };
+
+  // Startup is measured from construction.
+  StartupTimeline();
+
+  StartupTimeline(const StartupTimeline&) = delete;
+  StartupTimeline& operator=(const StartupTimeline&) = delete;
+
+  ~StartupTimeline();
+
+  // Can be called from any thread.
+  [[nodiscard]] Step Measure(std::string_view name);
+
+  // Ends the measurement. Steps must not be running.
+  void Finish();
+
+  // Prints the steps in start order, the startup time, which is the critical
+  // path through the steps, and the steps' total duration.
+  void Print(std::ostream& stream) const;
+
+ private:
+  struct StepRecord {
+    std::string name;
+    std::thread::id thread_id;
+    Clock::time_point start_time;
+    Clock::time_point end_time;
+  };
+
+  void Record(StepRecord record);
+
+  const Clock::time_point start_time_;
+  Clock::time_point end_time_;
+
+  mutable std::mutex mutex_;
+  std::vector<StepRecord> steps_;  // Guarded by `mutex_`.
+};
+
+#endif  // STARTUP_TIMELINE_H_
@@ -0,0 +1,194 @@
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "job_system.h"
+
+namespace {
+
+// Levels smaller than this are updated on the calling thread, because
+// scheduling jobs would cost more than the work.
+constexpr size_t kJobBatchSize = 1024;
+
+}  // namespace
+
+TransformHierarchy::TransformHierarchy() = default;
+
+TransformHierarchy::~TransformHierarchy() = default;
+
+TransformHierarchy::NodeId TransformHierarchy::AddNode(NodeId parent,
+                                                       const glm::mat4& local_transform) {
+  uint32_t depth = 0;
+  uint32_t parent_slot = 0;
+  if (parent != kNoParent) {
+    assert(parent < records_.size() && records_[parent].depth != kFreeRecord);
+    NodeRecord& parent_record = records_[parent];
+    depth = parent_record.depth + 1;
+    parent_slot = parent_record.slot;
+    ++parent_record.child_count;
+  }
+  if (depth == levels_.size())
+    levels_.emplace_back();
+
+  NodeId node;
+  if (free_ids_.empty()) {
+    node = static_cast<NodeId>(records_.size());
+    records_.emplace_back();
+  } else {
+    node = free_ids_.back();
+    free_ids_.pop_back();
+  }
+
+  Level& level = levels_[depth];
+  records_[node] = {
+    .depth = depth,
+    .slot = static_cast<uint32_t>(level.node_ids.size()),
+    .child_count = 0,
+    .parent = parent,
+  };
+  level.node_ids.push_back(node);
+  level.parent_slots.push_back(parent_slot);
+  level.local_transforms.push_back(local_transform);
+  level.world_transforms.push_back(local_transform);
+  level.dirty.push_back(1);
+  level.last_changed_updates.push_back(0);
+  level.has_dirty = true;
+  ++node_count_;
+  return node;
+}
+
+void TransformHierarchy::RemoveNode(NodeId node) {
+  assert(node < records_.size() && records_[node].depth != kFreeRecord);
+  NodeRecord& record = records_[node];
+  assert(record.child_count == 0);
+
+  if (record.parent != kNoParent)
+    --records_[record.parent].child_count;
+
+  // Moves the level's last node into the removed node's slot.
+  Level& level = levels_[record.depth];
+  uint32_t slot = record.slot;
+  uint32_t last_slot = static_cast<uint32_t>(level.node_ids.size() - 1);
+  if (slot != last_slot) {
+    NodeId moved_node = level.node_ids[last_slot];
+    level.node_ids[slot] = moved_node;
+    level.parent_slots[slot] = level.parent_slots[last_slot];
+    level.local_transforms[slot] = level.local_transforms[last_slot];
+    level.world_transforms[slot] = level.world_transforms[last_slot];
+    level.dirty[slot] = level.dirty[last_slot];
+    level.last_changed_updates[slot] = level.last_changed_updates[last_slot];
+    records_[moved_node].slot = slot;
+
+    if (records_[moved_node].child_count != 0) {
+      Level& child_level = levels_[record.depth + 1];
+      for (uint32_t& parent_slot : child_level.parent_slots) {
+        if (parent_slot == last_slot)
+          parent_slot = slot;
+      }
+    }
+  }
+  level.node_ids.pop_back();
+  level.parent_slots.pop_back();
+  level.local_transforms.pop_back();
+  level.world_transforms.pop_back();
+  level.dirty.pop_back();
+  level.last_changed_updates.pop_back();
+
+  // Empty levels are only removed from the bottom, so depths stay valid.
+  while (!levels_.empty() && levels_.back().node_ids.empty())
+    levels_.pop_back();
+
+  record.depth = kFreeRecord;
+  free_ids_.push_back(node);
+  --node_count_;
+}
+
+void TransformHierarchy::SetLocalTransform(NodeId node, const glm::mat4& local_transform) {
+  assert(node < records_.size() && records_[node].depth != kFreeRecord);
+  const NodeRecord& record = records_[node];
+  Level& level = levels_[record.depth];
+  level.local_transforms[record.slot] = local_transform;
+  level.dirty[record.slot] = 1;
+  level.has_dirty = true;
+}
+
+const glm::mat4& TransformHierarchy::LocalTransform(NodeId node) const {
+  assert(node < records_.size() && records_[node].depth != kFreeRecord);
+  const NodeRecord& record = records_[node];
+  return levels_[record.depth].local_transforms[record.slot];
+}
+
+const glm::mat4& TransformHierarchy::WorldTransform(NodeId node) const {
+  assert(node < records_.size() && records_[node].depth != kFreeRecord);
+  const NodeRecord& record = records_[node];
+  return levels_[record.depth].world_transforms[record.slot];
+}
+
+void TransformHierarchy::Update(JobSystem& job_system, glm::mat4* gpu_transforms,
+                                uint32_t frames_in_flight) {
+  assert(frames_in_flight > 0);
+  ++update_counter_;
+
+  bool level_above_changed = false;
+  for (size_t depth = 0; depth < levels_.size(); ++depth) {
+    Level& level = levels_[depth];
+
+    // Nodes only change if they are dirty, or if their parents changed.
+    bool level_changed = level.has_dirty || level_above_changed;
+    level.has_dirty = false;
+    if (level_changed)
+      level.last_changed_update = update_counter_;
+    level_above_changed = level_changed;
+
+    // Unchanged levels may still owe writes to the buffers of other frames.
+    bool level_needs_writes = gpu_transforms != nullptr &&
+                              update_counter_ - level.last_changed_update < frames_in_flight;
+    if (!level_changed && !level_needs_writes)
+      continue;
+
+    size_t node_count = level.node_ids.size();
+    if (node_count <= kJobBatchSize) {
+      UpdateLevelNodes(depth, 0, node_count, gpu_transforms, frames_in_flight);
+      continue;
+    }
+    job_system.ParallelFor(node_count, kJobBatchSize, [&](size_t begin, size_t end) {
+      UpdateLevelNodes(depth, begin, end, gpu_transforms, frames_in_flight);
+    });
+  }
+}
+
+void TransformHierarchy::UpdateLevelNodes(size_t depth, size_t begin, size_t end,
+                                          glm::mat4* gpu_transforms,
+                                          uint32_t frames_in_flight) {
+  Level& level = levels_[depth];
+  const Level* parent_level = (depth > 0) ? &levels_[depth - 1] : nullptr;
+
+  for (size_t slot = begin; slot < end; ++slot) {
+    bool changed = level.dirty[slot] != 0;
+    if (parent_level != nullptr) {
+      uint32_t parent_slot = level.parent_slots[slot];
+      changed |= parent_level->last_changed_updates[parent_slot] == update_counter_;
+      if (changed) {
+        level.world_transforms[slot] =
+            parent_level->world_transforms[parent_slot] * level.local_transforms[slot];
+      }
+    } else if (changed) {
+      level.world_transforms[slot] = level.local_transforms[slot];
+    }
+
+    if (changed) {
+      level.dirty[slot] = 0;
+      level.last_changed_updates[slot] = update_counter_;
+    }
+    if (gpu_transforms != nullptr &&
+        update_counter_ - level.last_changed_updates[slot] < frames_in_flight) {
+      gpu_transforms[level.node_ids[slot]] = level.world_transforms[slot];
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef TRANSFORM_HIERARCHY_H_
+#define TRANSFORM_HIERARCHY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+class JobSystem;
+
+// Computes world transforms for a forest of parent/child transforms.
+//
+// Nodes are stored by depth: all the roots, then all their children, and so
+// on. Each depth level is a structure of arrays. Updating a level only reads
+// the world transforms of the level above it, which are already final, so
+// each level's nodes are updated in parallel.
+//
+// Only the nodes whose local transforms changed, and their descendants, are
+// recomputed. Levels without changes are skipped entirely.
+class TransformHierarchy {
+ public:
+  // Node IDs are small, dense and stable, so they can index GPU buffers.
+  using NodeId = uint32_t;
+  static constexpr NodeId kNoParent = UINT32_MAX;
+
+  TransformHierarchy();
+
+  TransformHierarchy(const TransformHierarchy&) = delete;
+  TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+  ~TransformHierarchy();
+
+  // `parent` must be a node in this hierarchy, or kNoParent for roots.
+  NodeId AddNode(NodeId parent, const glm::mat4& local_transform);
+
+  // Removes a node without children. IDs of removed nodes are reused.
+  //
+  // Takes time proportional to the number of nodes one level below `node`.
+  void RemoveNode(NodeId node);
+
+  // Marks the node's subtree for recomputing by the next Update().
+  void SetLocalTransform(NodeId node, const glm::mat4& local_transform);
+  [[nodiscard]] const glm::mat4& LocalTransform(NodeId node) const;
+
+  // The transform computed by the last Update().
+  [[nodiscard]] const glm::mat4& WorldTransform(NodeId node) const;
+
+  [[nodiscard]] size_t NodeCount() const { return node_count_; }
+
+  // One more than the largest ID of a live node.
+  [[nodiscard]] size_t IdLimit() const { return records_.size(); }
+
+  // Recomputes the world transforms that changed since the last update.
+  //
+  // If `gpu_transforms` is not null, each world transform that changed
+  // during the last `frames_in_flight` updates is written at index NodeId.
+  // Per-frame buffers are rewritten once each, in rotation, so every buffer
+  // catches up with the changes made while the GPU was reading it. The
+  // buffer must hold IdLimit() matrices. It is only written, never read,
+  // so it can be a write-combined mapping.
+  void Update(JobSystem& job_system, glm::mat4* gpu_transforms = nullptr,
+              uint32_t frames_in_flight = 1);
+
+ private:
+  // All the nodes at one depth.
+  struct Level {
+    std::vector<NodeId> node_ids;
+    std::vector<uint32_t> parent_slots;  // Indexes in the level above.
+    std::vector<glm::mat4> local_transforms;
+    std::vector<glm::mat4> world_transforms;
+
+    // Set by SetLocalTransform(). Bytes, so jobs can clear them concurrently.
+    std::vector<uint8_t> dirty;
+
+    // The Update() counter value when the world transform last changed.
+    std::vector<uint32_t> last_changed_updates;
+
+    // True if any node has `dirty` set.
+    bool has_dirty = false;
+
+    // Upper bound on the updates that changed a node in this level.
+    uint32_t last_changed_update = 0;
+  };
+
+  // Locates a node. Freed records have no level.
+  struct NodeRecord {
+    uint32_t depth;
+    uint32_t slot;
+    uint32_t child_count;
+    NodeId parent;
+  };
+  static constexpr uint32_t kFreeRecord = UINT32_MAX;
+
+  // Updates the nodes in [begin, end) of `levels_[depth]`.
+  void UpdateLevelNodes(size_t depth, size_t begin, size_t end, glm::mat4* gpu_transforms,
+                        uint32_t frames_in_flight);
+
+  std::vector<Level> levels_;
+  std::vector<NodeRecord> records_;
+  std::vector<NodeId> free_ids_;
+  size_t node_count_ = 0;
+
+  // Incremented by each Update().
+  uint32_t update_counter_ = 0;
+};
+
+#endif  // TRANSFORM_HIERARCHY_H_
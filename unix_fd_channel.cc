@@ -0,0 +1,189 @@
+#include "unix_fd_channel.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] sockaddr_un SocketAddress(const std::string& socket_path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path too long: " << socket_path << std::endl;
+    std::abort();
+  }
+  std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+  return address;
+}
+
+// SOCK_SEQPACKET preserves message boundaries, so each Receive() call gets
+// exactly one Send() call's message and file descriptors.
+[[nodiscard]] int CreateSocket() {
+  int socket_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (socket_fd < 0) {
+    std::cerr << "socket() failed: " << std::strerror(errno) << std::endl;
+    std::abort();
+  }
+  return socket_fd;
+}
+
+}  // namespace
+
+UnixFdChannel UnixFdChannel::Accept(const std::string& socket_path) {
+  sockaddr_un address = SocketAddress(socket_path);
+  int listen_fd = CreateSocket();
+
+  // A stale socket file left by a crashed process would make bind() fail.
+  ::unlink(socket_path.c_str());
+  if (::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    std::cerr << "bind() failed: " << std::strerror(errno) << std::endl;
+    std::abort();
+  }
+  if (::listen(listen_fd, /*backlog=*/1) != 0) {
+    std::cerr << "listen() failed: " << std::strerror(errno) << std::endl;
+    std::abort();
+  }
+
+  int socket_fd;
+  do {
+    socket_fd = ::accept4(listen_fd, /*addr=*/nullptr, /*addrlen=*/nullptr, SOCK_CLOEXEC);
+  } while (socket_fd < 0 && errno == EINTR);
+  if (socket_fd < 0) {
+    std::cerr << "accept4() failed: " << std::strerror(errno) << std::endl;
+    std::abort();
+  }
+
+  ::close(listen_fd);
+  ::unlink(socket_path.c_str());
+  return UnixFdChannel(socket_fd);
+}
+
+UnixFdChannel UnixFdChannel::Connect(const std::string& socket_path) {
+  sockaddr_un address = SocketAddress(socket_path);
+  int socket_fd = CreateSocket();
+
+  if (::connect(socket_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    std::cerr << "connect() to " << socket_path << " failed: " << std::strerror(errno)
+              << std::endl;
+    std::abort();
+  }
+  return UnixFdChannel(socket_fd);
+}
+
+UnixFdChannel::UnixFdChannel(int socket_fd) : socket_fd_(socket_fd) {
+  assert(socket_fd >= 0);
+}
+
+UnixFdChannel::UnixFdChannel(UnixFdChannel&& rhs) noexcept : socket_fd_(rhs.socket_fd_) {
+  rhs.socket_fd_ = -1;
+}
+
+UnixFdChannel& UnixFdChannel::operator=(UnixFdChannel&& rhs) noexcept {
+  std::swap(socket_fd_, rhs.socket_fd_);
+  return *this;
+}
+
+UnixFdChannel::~UnixFdChannel() {
+  if (socket_fd_ >= 0)
+    ::close(socket_fd_);
+}
+
+bool UnixFdChannel::Send(const void* data, size_t size, const std::vector<int>& fds) {
+  assert(socket_fd_ >= 0);
+  assert(data != nullptr);
+  assert(size > 0);
+  assert(fds.size() <= kMaxFdsPerMessage);
+
+  iovec data_vector = {.iov_base = const_cast<void*>(data), .iov_len = size};
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+  msghdr message{};
+  message.msg_iov = &data_vector;
+  message.msg_iovlen = 1;
+  if (!fds.empty()) {
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+    cmsghdr* control_header = CMSG_FIRSTHDR(&message);
+    control_header->cmsg_level = SOL_SOCKET;
+    control_header->cmsg_type = SCM_RIGHTS;
+    control_header->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    std::memcpy(CMSG_DATA(control_header), fds.data(), sizeof(int) * fds.size());
+  }
+
+  ssize_t sent_size;
+  do {
+    sent_size = ::sendmsg(socket_fd_, &message, MSG_NOSIGNAL);
+  } while (sent_size < 0 && errno == EINTR);
+  if (sent_size < 0) {
+    if (errno == EPIPE || errno == ECONNRESET)
+      return false;
+    std::cerr << "sendmsg() failed: " << std::strerror(errno) << std::endl;
+    std::abort();
+  }
+  assert(static_cast<size_t>(sent_size) == size);
+  return true;
+}
+
+bool UnixFdChannel::Receive(void* data, size_t size, std::vector<int>* fds) {
+  assert(socket_fd_ >= 0);
+  assert(data != nullptr);
+  assert(size > 0);
+
+  iovec data_vector = {.iov_base = data, .iov_len = size};
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+  msghdr message{};
+  message.msg_iov = &data_vector;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  ssize_t received_size;
+  do {
+    received_size = ::recvmsg(socket_fd_, &message, MSG_CMSG_CLOEXEC);
+  } while (received_size < 0 && errno == EINTR);
+  if (received_size == 0)
+    return false;
+  if (received_size < 0) {
+    if (errno == ECONNRESET)
+      return false;
+    std::cerr << "recvmsg() failed: " << std::strerror(errno) << std::endl;
+    std::abort();
+  }
+
+  for (cmsghdr* control_header = CMSG_FIRSTHDR(&message); control_header != nullptr;
+       control_header = CMSG_NXTHDR(&message, control_header)) {
+    if (control_header->cmsg_level != SOL_SOCKET || control_header->cmsg_type != SCM_RIGHTS)
+      continue;
+
+    size_t fd_count = (control_header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    const unsigned char* fd_data = CMSG_DATA(control_header);
+    for (size_t i = 0; i < fd_count; ++i) {
+      int fd;
+      std::memcpy(&fd, fd_data + i * sizeof(int), sizeof(int));
+      if (fds != nullptr)
+        fds->push_back(fd);
+      else
+        ::close(fd);
+    }
+  }
+
+  if ((message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0 ||
+      static_cast<size_t>(received_size) != size) {
+    std::cerr << "Received a message of unexpected size" << std::endl;
+    std::abort();
+  }
+  return true;
+}
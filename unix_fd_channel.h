@@ -0,0 +1,51 @@
+#ifndef UNIX_FD_CHANNEL_H_
+#define UNIX_FD_CHANNEL_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A connection to another process over a Unix domain socket.
+//
+// Messages can carry file descriptors, which the kernel duplicates into the
+// receiving process (SCM_RIGHTS). Message boundaries are preserved.
+class UnixFdChannel {
+ public:
+  // The most file descriptors that a message can carry.
+  static constexpr size_t kMaxFdsPerMessage = 64;
+
+  // Waits for a process to connect to a socket at `socket_path`.
+  //
+  // The socket file is removed once the connection is established.
+  [[nodiscard]] static UnixFdChannel Accept(const std::string& socket_path);
+
+  // Connects to a process waiting in Accept().
+  [[nodiscard]] static UnixFdChannel Connect(const std::string& socket_path);
+
+  // Moving supported so instances can be returned.
+  UnixFdChannel(const UnixFdChannel&) = delete;
+  UnixFdChannel(UnixFdChannel&& rhs) noexcept;
+  UnixFdChannel& operator=(const UnixFdChannel&) = delete;
+  UnixFdChannel& operator=(UnixFdChannel&& rhs) noexcept;
+
+  ~UnixFdChannel();
+
+  // Sends a message with `size` bytes at `data`, and copies of `fds`.
+  //
+  // The caller keeps ownership of `fds`. Returns false if the peer
+  // disconnected.
+  [[nodiscard]] bool Send(const void* data, size_t size, const std::vector<int>& fds = {});
+
+  // Receives a message of exactly `size` bytes into `data`.
+  //
+  // The file descriptors carried by the message are appended to `fds`, and
+  // are owned by the caller. Returns false if the peer disconnected.
+  [[nodiscard]] bool Receive(void* data, size_t size, std::vector<int>* fds = nullptr);
+
+ private:
+  explicit UnixFdChannel(int socket_fd);
+
+  int socket_fd_;
+};
+
+#endif  // UNIX_FD_CHANNEL_H_
@@ -0,0 +1,186 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <optional>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_command_pool.h"
+#include "vulkan_config.h"
+#include "vulkan_device.h"
+#include "vulkan_instance.h"
+#include "vulkan_layer_list.h"
+#include "vulkan_physical_device_list.h"
+#include "vulkan_render_target.h"
+
+namespace {
+
+constexpr VkExtent2D kTargetExtent = {.width = 256, .height = 256};
+
+// Each frame clears and reads back the target this many times, so frames
+// have enough commands for the validation cost to show.
+constexpr int kPassesPerFrame = 64;
+
+constexpr int kWarmupFrameCount = 20;
+
+constexpr VkImageSubresourceRange kColorSubresourceRange = {
+  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+  .baseMipLevel = 0,
+  .levelCount = 1,
+  .baseArrayLayer = 0,
+  .layerCount = 1,
+};
+
+void RecordFrame(const VulkanDevice& device, VkCommandBuffer command_buffer,
+                 const VulkanRenderTarget& target, const VulkanBuffer& readback, int frame_index) {
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  VkImageMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = target.VulkanHandle(),
+    .subresourceRange = kColorSubresourceRange,
+  };
+  VkBufferImageCopy region = {
+    .bufferOffset = 0,
+    .bufferRowLength = 0,
+    .bufferImageHeight = 0,
+    .imageSubresource = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .mipLevel = 0,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+    },
+    .imageOffset = {.x = 0, .y = 0, .z = 0},
+    .imageExtent = {.width = kTargetExtent.width, .height = kTargetExtent.height, .depth = 1},
+  };
+  // Every pass copies to the same range, so each copy must wait for the
+  // previous one, including the last copy of the previous frame.
+  VkBufferMemoryBarrier readback_barrier = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .buffer = readback.VulkanHandle(),
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+
+  for (int pass = 0; pass < kPassesPerFrame; ++pass) {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    functions.vkCmdPipelineBarrier(
+        command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    float shade = static_cast<float>((frame_index + pass) % 256) / 255.0f;
+    VkClearColorValue clear_color = {.float32 = {shade, shade, shade, 1.0f}};
+    functions.vkCmdClearColorImage(command_buffer, target.VulkanHandle(),
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1,
+                                   &kColorSubresourceRange);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    functions.vkCmdPipelineBarrier(
+        command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        /*dependencyFlags=*/0, 0, nullptr, 1, &readback_barrier, 1, &barrier);
+
+    functions.vkCmdCopyImageToBuffer(command_buffer, target.VulkanHandle(),
+                                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                     readback.VulkanHandle(), 1, &region);
+  }
+}
+
+// Returns the average wall-clock time per frame, in milliseconds. Each frame
+// is submitted and waited for, so this includes recording, submission, GPU
+// execution and the fence wait.
+[[nodiscard]] double MeasureFrameTime(VulkanValidationLevel validation_level, int frame_count) {
+  VulkanConfig vulkan_config(validation_level);
+  VulkanInstance instance(vulkan_config, "Validation Benchmark");
+  VulkanPhysicalDeviceList physical_devices(instance.VulkanHandle());
+  VulkanDevice device = physical_devices.CreateComputeDevice(vulkan_config);
+
+  VulkanRenderTarget target(device, kTargetExtent, VK_FORMAT_R8G8B8A8_UNORM,
+                            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+  VulkanBuffer readback(device, VkDeviceSize{kTargetExtent.width} * kTargetExtent.height * 4,
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+  VulkanCommandPool command_pool(device, device.ComputeQueueFamilyIndex());
+
+  auto render_frame = [&](int frame_index) {
+    command_pool.SubmitAndWait(device.ComputeQueue(), [&](VkCommandBuffer command_buffer) {
+      RecordFrame(device, command_buffer, target, readback, frame_index);
+    });
+  };
+
+  // The first frames pay for lazy initialization in the driver and layers.
+  for (int i = 0; i < kWarmupFrameCount; ++i)
+    render_frame(i);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frame_count; ++i)
+    render_frame(i);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / frame_count;
+}
+
+}  // namespace
+
+// Usage: validation_benchmark [frame_count]
+//
+// Measures the wall-clock time per frame at each validation level, and
+// reports each level's overhead relative to running without validation.
+int main(int argc, char** argv) {
+  int frame_count = 200;
+  if (argc > 2) {
+    std::cerr << "Usage: " << argv[0] << " [frame_count]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (argc == 2) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed_count = std::strtol(argv[1], &end, /*base=*/10);
+    if (end == argv[1] || *end != '\0' || errno != 0 || parsed_count <= 0 ||
+        parsed_count > std::numeric_limits<int>::max()) {
+      std::cerr << "Usage: " << argv[0] << " [frame_count]: the frame count must be a "
+                << "positive integer, got " << argv[1] << std::endl;
+      std::abort();
+    }
+    frame_count = static_cast<int>(parsed_count);
+  }
+
+  bool has_validation_layer = VulkanLayerList().Contains("VK_LAYER_KHRONOS_validation");
+
+  std::optional<double> baseline_time;
+  for (VulkanValidationLevel validation_level :
+       {VulkanValidationLevel::kOff, VulkanValidationLevel::kCore,
+        VulkanValidationLevel::kSynchronization, VulkanValidationLevel::kFull}) {
+    const char* level_name = VulkanValidationLevelName(validation_level);
+    if (validation_level != VulkanValidationLevel::kOff && !has_validation_layer) {
+      std::cout << level_name << ": skipped, the validation layer is not installed" << std::endl;
+      continue;
+    }
+
+    double frame_time = MeasureFrameTime(validation_level, frame_count);
+    if (!baseline_time.has_value())
+      baseline_time = frame_time;
+    std::cout << level_name << ": " << frame_time << " ms wall time per frame, +"
+              << frame_time - *baseline_time << " ms over no validation" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include "vulkan_buffer.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+namespace {
+
+[[nodiscard]] VkBuffer CreateBuffer(const VulkanDevice& device, VkDeviceSize size,
+                                    VkBufferUsageFlags usage) {
+  VkBufferCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .size = size,
+    .usage = usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = 0,
+    .pQueueFamilyIndices = nullptr,
+  };
+
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateBuffer(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &buffer);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateBuffer() failed" << std::endl;
+    std::abort();
+  }
+  return buffer;
+}
+
+[[nodiscard]] VulkanDevice::MemoryAllocation AllocateBufferMemory(
+    const VulkanDevice& device, VkBuffer buffer, VkMemoryPropertyFlags required_properties,
+    VkMemoryPropertyFlags preferred_properties) {
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  VkMemoryRequirements requirements;
+  functions.vkGetBufferMemoryRequirements(device.VulkanHandle(), buffer, &requirements);
+
+  VulkanDevice::MemoryAllocation allocation =
+      device.AllocateMemory(requirements, required_properties, preferred_properties);
+
+  VkResult result = functions.vkBindBufferMemory(
+      device.VulkanHandle(), buffer, allocation.memory, /*memoryOffset=*/0);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkBindBufferMemory() failed" << std::endl;
+    std::abort();
+  }
+  return allocation;
+}
+
+[[nodiscard]] void* MapBufferMemory(const VulkanDevice& device,
+                                    const VulkanDevice::MemoryAllocation& allocation) {
+  if (!(allocation.property_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    return nullptr;
+
+  void* mapped_data = nullptr;
+  VkResult result = device.Functions().vkMapMemory(
+      device.VulkanHandle(), allocation.memory, /*offset=*/0, VK_WHOLE_SIZE, /*flags=*/0,
+      &mapped_data);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkMapMemory() failed" << std::endl;
+    std::abort();
+  }
+  return mapped_data;
+}
+
+}  // namespace
+
+VulkanBuffer::VulkanBuffer(const VulkanDevice& device, VkDeviceSize size, VkBufferUsageFlags usage,
+                           VkMemoryPropertyFlags required_properties,
+                           VkMemoryPropertyFlags preferred_properties)
+    : device_(&device),
+      buffer_(CreateBuffer(device, size, usage)),
+      allocation_(AllocateBufferMemory(device, buffer_, required_properties, preferred_properties)),
+      size_(size),
+      mapped_data_(MapBufferMemory(device, allocation_)) {
+}
+
+VulkanBuffer::VulkanBuffer(VulkanBuffer&& rhs) noexcept
+    : device_(rhs.device_), buffer_(rhs.buffer_), allocation_(rhs.allocation_), size_(rhs.size_),
+      mapped_data_(rhs.mapped_data_) {
+  rhs.buffer_ = VK_NULL_HANDLE;
+  rhs.allocation_.memory = VK_NULL_HANDLE;
+  rhs.mapped_data_ = nullptr;
+}
+
+VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& rhs) noexcept {
+  std::swap(device_, rhs.device_);
+  std::swap(buffer_, rhs.buffer_);
+  std::swap(allocation_, rhs.allocation_);
+  std::swap(size_, rhs.size_);
+  std::swap(mapped_data_, rhs.mapped_data_);
+  return *this;
+}
+
+VulkanBuffer::~VulkanBuffer() {
+  if (buffer_ == VK_NULL_HANDLE) {
+    assert(allocation_.memory == VK_NULL_HANDLE);
+    return;
+  }
+
+  const VulkanDeviceFunctions& functions = device_->Functions();
+  functions.vkDestroyBuffer(device_->VulkanHandle(), buffer_, /*pAllocator=*/nullptr);
+  if (mapped_data_ != nullptr)
+    functions.vkUnmapMemory(device_->VulkanHandle(), allocation_.memory);
+  device_->FreeMemory(allocation_);
+}
+
+void VulkanBuffer::FlushMappedData() const {
+  assert(mapped_data_ != nullptr);
+  if (allocation_.property_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    return;
+
+  VkMappedMemoryRange range = {
+    .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+    .pNext = nullptr,
+    .memory = allocation_.memory,
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+  VkResult result = device_->Functions().vkFlushMappedMemoryRanges(
+      device_->VulkanHandle(), 1, &range);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkFlushMappedMemoryRanges() failed" << std::endl;
+    std::abort();
+  }
+}
+
+void VulkanBuffer::InvalidateMappedData() const {
+  assert(mapped_data_ != nullptr);
+  if (allocation_.property_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    return;
+
+  VkMappedMemoryRange range = {
+    .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+    .pNext = nullptr,
+    .memory = allocation_.memory,
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+  VkResult result = device_->Functions().vkInvalidateMappedMemoryRanges(
+      device_->VulkanHandle(), 1, &range);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkInvalidateMappedMemoryRanges() failed" << std::endl;
+    std::abort();
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef VULKAN_BUFFER_H_
+#define VULKAN_BUFFER_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+// A VkBuffer backed by its own memory allocation.
+//
+// Host-visible buffers are persistently mapped.
+class VulkanBuffer {
+ public:
+  // `device` must outlive this instance.
+  //
+  // The buffer's memory has all the `required_properties`, and has the
+  // `preferred_properties` if the device offers a matching memory type.
+  explicit VulkanBuffer(const VulkanDevice& device, VkDeviceSize size, VkBufferUsageFlags usage,
+                        VkMemoryPropertyFlags required_properties,
+                        VkMemoryPropertyFlags preferred_properties = 0);
+
+  // Moving supported so instances can be stored in vectors.
+  VulkanBuffer(const VulkanBuffer&) = delete;
+  VulkanBuffer(VulkanBuffer&& rhs) noexcept;
+  VulkanBuffer& operator=(const VulkanBuffer&) = delete;
+  VulkanBuffer& operator=(VulkanBuffer&& rhs) noexcept;
+
+  ~VulkanBuffer();
+
+  [[nodiscard]] VkBuffer VulkanHandle() const {
+    assert(buffer_ != VK_NULL_HANDLE);
+    return buffer_;
+  }
+
+  [[nodiscard]] VkDeviceSize Size() const { return size_; }
+
+  // Null if the buffer's memory is not host-visible.
+  [[nodiscard]] void* MappedData() const { return mapped_data_; }
+
+  // Makes host writes to the mapped memory visible to the device.
+  //
+  // No-op if the buffer's memory is host-coherent.
+  void FlushMappedData() const;
+
+  // Makes device writes to the buffer visible to the host via MappedData().
+  //
+  // No-op if the buffer's memory is host-coherent.
+  void InvalidateMappedData() const;
+
+ private:
+  const VulkanDevice* device_;
+  VkBuffer buffer_;
+  VulkanDevice::MemoryAllocation allocation_;
+  VkDeviceSize size_;
+  void* mapped_data_;
+};
+
+#endif  // VULKAN_BUFFER_H_
@@ -0,0 +1,118 @@
+#include "vulkan_command_pool.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+#include "vulkan_sync.h"
+
+namespace {
+
+[[nodiscard]] VkCommandPool CreateCommandPool(
+    const VulkanDevice& device, uint32_t queue_family_index, VkCommandPoolCreateFlags flags) {
+  VkCommandPoolCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = flags,
+    .queueFamilyIndex = queue_family_index,
+  };
+
+  VkCommandPool command_pool = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateCommandPool(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &command_pool);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateCommandPool() failed" << std::endl;
+    std::abort();
+  }
+  return command_pool;
+}
+
+}  // namespace
+
+VulkanCommandPool::VulkanCommandPool(const VulkanDevice& device, uint32_t queue_family_index,
+                                     VkCommandPoolCreateFlags flags)
+    : device_(device), command_pool_(CreateCommandPool(device, queue_family_index, flags)) {
+}
+
+VulkanCommandPool::~VulkanCommandPool() {
+  device_.Functions().vkDestroyCommandPool(
+      device_.VulkanHandle(), command_pool_, /*pAllocator=*/nullptr);
+}
+
+std::vector<VkCommandBuffer> VulkanCommandPool::AllocateCommandBuffers(uint32_t count) {
+  VkCommandBufferAllocateInfo allocate_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+    .pNext = nullptr,
+    .commandPool = command_pool_,
+    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+    .commandBufferCount = count,
+  };
+
+  std::vector<VkCommandBuffer> command_buffers(count, VK_NULL_HANDLE);
+  VkResult result = device_.Functions().vkAllocateCommandBuffers(
+      device_.VulkanHandle(), &allocate_info, command_buffers.data());
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkAllocateCommandBuffers() failed" << std::endl;
+    std::abort();
+  }
+  return command_buffers;
+}
+
+void VulkanCommandPool::SubmitAndWait(
+    VkQueue queue, const std::function<void(VkCommandBuffer)>& record) {
+  assert(queue != VK_NULL_HANDLE);
+
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  VkCommandBuffer command_buffer = AllocateCommandBuffers(1)[0];
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .pNext = nullptr,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    .pInheritanceInfo = nullptr,
+  };
+  VkResult result = functions.vkBeginCommandBuffer(command_buffer, &begin_info);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkBeginCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  record(command_buffer);
+
+  result = functions.vkEndCommandBuffer(command_buffer);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkEndCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .pNext = nullptr,
+    .waitSemaphoreCount = 0,
+    .pWaitSemaphores = nullptr,
+    .pWaitDstStageMask = nullptr,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &command_buffer,
+    .signalSemaphoreCount = 0,
+    .pSignalSemaphores = nullptr,
+  };
+  VkFence fence = CreateVulkanFence(device_);
+  result = functions.vkQueueSubmit(queue, 1, &submit_info, fence);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkQueueSubmit() failed" << std::endl;
+    std::abort();
+  }
+
+  WaitForVulkanFence(device_, fence);
+
+  functions.vkDestroyFence(device, fence, /*pAllocator=*/nullptr);
+  functions.vkFreeCommandBuffers(device, command_pool_, 1, &command_buffer);
+}
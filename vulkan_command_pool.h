@@ -0,0 +1,46 @@
+#ifndef VULKAN_COMMAND_POOL_H_
+#define VULKAN_COMMAND_POOL_H_
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+
+// Allocates command buffers for one queue family.
+//
+// Like the underlying VkCommandPool, instances are not thread-safe.
+class VulkanCommandPool {
+ public:
+  // `device` must outlive this instance.
+  explicit VulkanCommandPool(const VulkanDevice& device, uint32_t queue_family_index,
+                             VkCommandPoolCreateFlags flags = 0);
+
+  VulkanCommandPool(const VulkanCommandPool&) = delete;
+  VulkanCommandPool& operator=(const VulkanCommandPool&) = delete;
+
+  // Frees all the command buffers allocated from this pool.
+  ~VulkanCommandPool();
+
+  [[nodiscard]] VkCommandPool VulkanHandle() const {
+    assert(command_pool_ != VK_NULL_HANDLE);
+    return command_pool_;
+  }
+
+  [[nodiscard]] std::vector<VkCommandBuffer> AllocateCommandBuffers(uint32_t count);
+
+  // Records commands via `record`, submits them to `queue` and waits for them to complete.
+  //
+  // This is meant for setup work and batch jobs, not for per-frame rendering.
+  // `queue` must belong to this pool's queue family.
+  void SubmitAndWait(VkQueue queue, const std::function<void(VkCommandBuffer)>& record);
+
+ private:
+  const VulkanDevice& device_;
+  const VkCommandPool command_pool_;
+};
+
+#endif  // VULKAN_COMMAND_POOL_H_
@@ -0,0 +1,274 @@
+#include "vulkan_compute_pipeline.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+#include "vulkan_shader_module.h"
+
+namespace {
+
+[[nodiscard]] VkDescriptorSetLayout CreateDescriptorSetLayout(
+    const VulkanDevice& device, const std::vector<VkDescriptorType>& bindings) {
+  std::vector<VkDescriptorSetLayoutBinding> layout_bindings;
+  layout_bindings.reserve(bindings.size());
+  for (size_t i = 0; i < bindings.size(); ++i) {
+    layout_bindings.push_back(VkDescriptorSetLayoutBinding{
+      .binding = static_cast<uint32_t>(i),
+      .descriptorType = bindings[i],
+      .descriptorCount = 1,
+      .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+      .pImmutableSamplers = nullptr,
+    });
+  }
+
+  VkDescriptorSetLayoutCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .bindingCount = static_cast<uint32_t>(layout_bindings.size()),
+    .pBindings = layout_bindings.data(),
+  };
+
+  VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateDescriptorSetLayout(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &descriptor_set_layout);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateDescriptorSetLayout() failed" << std::endl;
+    std::abort();
+  }
+  return descriptor_set_layout;
+}
+
+[[nodiscard]] VkPipelineLayout CreatePipelineLayout(
+    const VulkanDevice& device, VkDescriptorSetLayout descriptor_set_layout,
+    uint32_t push_constant_size) {
+  VkPushConstantRange push_constant_range = {
+    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+    .offset = 0,
+    .size = push_constant_size,
+  };
+
+  VkPipelineLayoutCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .setLayoutCount = 1,
+    .pSetLayouts = &descriptor_set_layout,
+    .pushConstantRangeCount = static_cast<uint32_t>(push_constant_size != 0 ? 1 : 0),
+    .pPushConstantRanges = push_constant_size != 0 ? &push_constant_range : nullptr,
+  };
+
+  VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreatePipelineLayout(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &pipeline_layout);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreatePipelineLayout() failed" << std::endl;
+    std::abort();
+  }
+  return pipeline_layout;
+}
+
+[[nodiscard]] VkPipeline CreatePipeline(
+    const VulkanDevice& device, const std::vector<uint32_t>& spirv,
+    VkPipelineLayout pipeline_layout, const VkSpecializationInfo* specialization_info) {
+  // The shader module is only needed while the pipeline is created.
+  VulkanShaderModule shader_module(device, spirv);
+
+  VkComputePipelineCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .stage = VkPipelineShaderStageCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+      .module = shader_module.VulkanHandle(),
+      .pName = "main",
+      .pSpecializationInfo = specialization_info,
+    },
+    .layout = pipeline_layout,
+    .basePipelineHandle = VK_NULL_HANDLE,
+    .basePipelineIndex = -1,
+  };
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateComputePipelines(
+      device.VulkanHandle(), /*pipelineCache=*/VK_NULL_HANDLE, 1, &create_info,
+      /*pAllocator=*/nullptr, &pipeline);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateComputePipelines() failed" << std::endl;
+    std::abort();
+  }
+  return pipeline;
+}
+
+[[nodiscard]] VkDescriptorPool CreateDescriptorPool(
+    const VulkanDevice& device, const std::vector<VkDescriptorType>& bindings,
+    uint32_t max_descriptor_sets) {
+  // Pipelines without resources don't need descriptor sets.
+  if (bindings.empty())
+    return VK_NULL_HANDLE;
+
+  std::map<VkDescriptorType, uint32_t> type_counts;
+  for (VkDescriptorType binding : bindings)
+    type_counts[binding] += max_descriptor_sets;
+
+  std::vector<VkDescriptorPoolSize> pool_sizes;
+  pool_sizes.reserve(type_counts.size());
+  for (const auto& [type, count] : type_counts)
+    pool_sizes.push_back(VkDescriptorPoolSize{.type = type, .descriptorCount = count});
+
+  VkDescriptorPoolCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .maxSets = max_descriptor_sets,
+    .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+    .pPoolSizes = pool_sizes.data(),
+  };
+
+  VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateDescriptorPool(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &descriptor_pool);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateDescriptorPool() failed" << std::endl;
+    std::abort();
+  }
+  return descriptor_pool;
+}
+
+}  // namespace
+
+VulkanComputePipeline::VulkanComputePipeline(
+    const VulkanDevice& device, const std::vector<uint32_t>& spirv,
+    const std::vector<VkDescriptorType>& bindings, uint32_t push_constant_size,
+    uint32_t max_descriptor_sets, const VkSpecializationInfo* specialization_info)
+    : device_(device),
+      bindings_(bindings),
+      push_constant_size_(push_constant_size),
+      descriptor_set_layout_(CreateDescriptorSetLayout(device, bindings)),
+      pipeline_layout_(CreatePipelineLayout(device, descriptor_set_layout_, push_constant_size)),
+      pipeline_(CreatePipeline(device, spirv, pipeline_layout_, specialization_info)),
+      descriptor_pool_(CreateDescriptorPool(device, bindings, max_descriptor_sets)) {
+  assert(max_descriptor_sets > 0);
+
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE, pipeline_, "Compute pipeline");
+}
+
+VulkanComputePipeline::~VulkanComputePipeline() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  if (descriptor_pool_ != VK_NULL_HANDLE)
+    functions.vkDestroyDescriptorPool(device, descriptor_pool_, /*pAllocator=*/nullptr);
+  functions.vkDestroyPipeline(device, pipeline_, /*pAllocator=*/nullptr);
+  functions.vkDestroyPipelineLayout(device, pipeline_layout_, /*pAllocator=*/nullptr);
+  functions.vkDestroyDescriptorSetLayout(device, descriptor_set_layout_, /*pAllocator=*/nullptr);
+}
+
+VkDescriptorSet VulkanComputePipeline::AllocateDescriptorSet() {
+  assert(descriptor_pool_ != VK_NULL_HANDLE);
+
+  VkDescriptorSetAllocateInfo allocate_info = {
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    .pNext = nullptr,
+    .descriptorPool = descriptor_pool_,
+    .descriptorSetCount = 1,
+    .pSetLayouts = &descriptor_set_layout_,
+  };
+
+  VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+  VkResult result = device_.Functions().vkAllocateDescriptorSets(
+      device_.VulkanHandle(), &allocate_info, &descriptor_set);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkAllocateDescriptorSets() failed" << std::endl;
+    std::abort();
+  }
+  return descriptor_set;
+}
+
+void VulkanComputePipeline::BindBuffer(VkDescriptorSet descriptor_set, uint32_t binding,
+                                       VkBuffer buffer, VkDeviceSize offset,
+                                       VkDeviceSize range) const {
+  assert(binding < bindings_.size());
+  assert(bindings_[binding] == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+         bindings_[binding] == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+  VkDescriptorBufferInfo buffer_info = {
+    .buffer = buffer,
+    .offset = offset,
+    .range = range,
+  };
+  VkWriteDescriptorSet write = {
+    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+    .pNext = nullptr,
+    .dstSet = descriptor_set,
+    .dstBinding = binding,
+    .dstArrayElement = 0,
+    .descriptorCount = 1,
+    .descriptorType = bindings_[binding],
+    .pImageInfo = nullptr,
+    .pBufferInfo = &buffer_info,
+    .pTexelBufferView = nullptr,
+  };
+  device_.Functions().vkUpdateDescriptorSets(
+      device_.VulkanHandle(), 1, &write, /*descriptorCopyCount=*/0, /*pDescriptorCopies=*/nullptr);
+}
+
+void VulkanComputePipeline::BindImage(VkDescriptorSet descriptor_set, uint32_t binding,
+                                      VkImageView image_view, VkImageLayout image_layout,
+                                      VkSampler sampler) const {
+  assert(binding < bindings_.size());
+  assert(bindings_[binding] == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+         bindings_[binding] == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+         bindings_[binding] == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+  VkDescriptorImageInfo image_info = {
+    .sampler = sampler,
+    .imageView = image_view,
+    .imageLayout = image_layout,
+  };
+  VkWriteDescriptorSet write = {
+    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+    .pNext = nullptr,
+    .dstSet = descriptor_set,
+    .dstBinding = binding,
+    .dstArrayElement = 0,
+    .descriptorCount = 1,
+    .descriptorType = bindings_[binding],
+    .pImageInfo = &image_info,
+    .pBufferInfo = nullptr,
+    .pTexelBufferView = nullptr,
+  };
+  device_.Functions().vkUpdateDescriptorSets(
+      device_.VulkanHandle(), 1, &write, /*descriptorCopyCount=*/0, /*pDescriptorCopies=*/nullptr);
+}
+
+void VulkanComputePipeline::Dispatch(VkCommandBuffer command_buffer, VkDescriptorSet descriptor_set,
+                                     const void* push_constants, uint32_t group_count_x,
+                                     uint32_t group_count_y, uint32_t group_count_z) const {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+
+  functions.vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+  if (descriptor_set != VK_NULL_HANDLE) {
+    functions.vkCmdBindDescriptorSets(
+        command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout_, /*firstSet=*/0,
+        /*descriptorSetCount=*/1, &descriptor_set, /*dynamicOffsetCount=*/0,
+        /*pDynamicOffsets=*/nullptr);
+  }
+  if (push_constant_size_ != 0) {
+    assert(push_constants != nullptr);
+    functions.vkCmdPushConstants(command_buffer, pipeline_layout_, VK_SHADER_STAGE_COMPUTE_BIT,
+                                 /*offset=*/0, push_constant_size_, push_constants);
+  }
+  functions.vkCmdDispatch(command_buffer, group_count_x, group_count_y, group_count_z);
+}
@@ -0,0 +1,70 @@
+#ifndef VULKAN_COMPUTE_PIPELINE_H_
+#define VULKAN_COMPUTE_PIPELINE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+
+// A compute shader, together with the layout of its resources.
+//
+// The shader's resources are all in descriptor set 0, at consecutive bindings
+// starting at 0. Small parameters are passed as push constants.
+class VulkanComputePipeline {
+ public:
+  // `device` must outlive this instance.
+  //
+  // `bindings` lists the descriptor type at each binding. Descriptor sets are
+  // allocated from a pool that holds up to `max_descriptor_sets` sets.
+  explicit VulkanComputePipeline(
+      const VulkanDevice& device, const std::vector<uint32_t>& spirv,
+      const std::vector<VkDescriptorType>& bindings, uint32_t push_constant_size,
+      uint32_t max_descriptor_sets = 1,
+      const VkSpecializationInfo* specialization_info = nullptr);
+
+  VulkanComputePipeline(const VulkanComputePipeline&) = delete;
+  VulkanComputePipeline& operator=(const VulkanComputePipeline&) = delete;
+
+  ~VulkanComputePipeline();
+
+  [[nodiscard]] VkPipeline VulkanHandle() const {
+    assert(pipeline_ != VK_NULL_HANDLE);
+    return pipeline_;
+  }
+  [[nodiscard]] VkPipelineLayout LayoutVulkanHandle() const {
+    assert(pipeline_layout_ != VK_NULL_HANDLE);
+    return pipeline_layout_;
+  }
+
+  // The returned set is released when this instance is destroyed.
+  [[nodiscard]] VkDescriptorSet AllocateDescriptorSet();
+
+  // Points a buffer binding in `descriptor_set` to a range of `buffer`.
+  void BindBuffer(VkDescriptorSet descriptor_set, uint32_t binding, VkBuffer buffer,
+                  VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) const;
+
+  // Points an image binding in `descriptor_set` to `image_view`.
+  void BindImage(VkDescriptorSet descriptor_set, uint32_t binding, VkImageView image_view,
+                 VkImageLayout image_layout, VkSampler sampler = VK_NULL_HANDLE) const;
+
+  // Records a dispatch of the given number of workgroups.
+  //
+  // `push_constants` must point to the number of bytes given at construction.
+  void Dispatch(VkCommandBuffer command_buffer, VkDescriptorSet descriptor_set,
+                const void* push_constants, uint32_t group_count_x, uint32_t group_count_y = 1,
+                uint32_t group_count_z = 1) const;
+
+ private:
+  const VulkanDevice& device_;
+  const std::vector<VkDescriptorType> bindings_;
+  const uint32_t push_constant_size_;
+  const VkDescriptorSetLayout descriptor_set_layout_;
+  const VkPipelineLayout pipeline_layout_;
+  const VkPipeline pipeline_;
+  const VkDescriptorPool descriptor_pool_;
+};
+
+#endif  // VULKAN_COMPUTE_PIPELINE_H_
@@ -3,6 +3,9 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 #include <vulkan/vulkan_core.h>
 
@@ -12,20 +15,33 @@
 
 namespace {
 
-bool WantVulkanValidation() {
+constexpr char kValidationLayerName[] = "VK_LAYER_KHRONOS_validation";
+constexpr char kValidationLevelVariable[] = "VULKAN_TUTORIAL_VALIDATION";
+
+[[nodiscard]] VulkanValidationLevel DefaultValidationLevel() {
+  const char* level_name = std::getenv(kValidationLevelVariable);
+  if (level_name != nullptr && level_name[0] != '\0') {
+    std::optional<VulkanValidationLevel> level = ParseVulkanValidationLevel(level_name);
+    if (!level.has_value()) {
+      std::cerr << "Unknown " << kValidationLevelVariable << " value: " << level_name
+                << std::endl;
+      std::abort();
+    }
+    return *level;
+  }
+
 #if defined(NDEBUG)
-    return false;
+  return VulkanValidationLevel::kOff;
 #else
-    return true;
+  return VulkanValidationLevel::kCore;
 #endif  // defined(NDEBUG)
 }
 
-[[nodiscard]] std::vector<const char*> RequiredVulkanLayers(bool want_validation) {
+[[nodiscard]] std::vector<const char*> RequiredVulkanLayers(
+    VulkanValidationLevel validation_level, const VulkanLayerList& layers) {
   std::vector<const char*> required_layers;
 
-  if (want_validation) {
-    static constexpr char kValidationLayerName[] = "VK_LAYER_KHRONOS_validation";
-    VulkanLayerList layers;
+  if (validation_level != VulkanValidationLevel::kOff) {
     if (!layers.Contains(kValidationLayerName)) {
       std::cerr << "Validation layer required but not available" << std::endl;
       std::abort();
@@ -38,18 +54,37 @@ bool WantVulkanValidation() {
 
 
 [[nodiscard]] std::vector<const char*> RequiredVulkanInstanceExtensions(
-    const VulkanPresentationContext& presentation_context, bool want_validation) {
-  std::vector<const char*> required_extensions = presentation_context.RequiredVulkanInstanceExtensions();
+    std::vector<const char*> required_extensions, VulkanValidationLevel validation_level,
+    const VulkanExtensionList& extension_list) {
 
-  if (want_validation) {
-    static constexpr char kDebugUtilsExtensionName[] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
-
-    VulkanExtensionList extension_list;
+  static constexpr char kDebugUtilsExtensionName[] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+  if (validation_level != VulkanValidationLevel::kOff) {
     if (!extension_list.Contains(kDebugUtilsExtensionName)) {
       std::cerr << "Validation layer required but debugging extension not available" << std::endl;
       std::abort();
     }
     required_extensions.push_back(kDebugUtilsExtensionName);
+  } else {
+#if defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+    // Object names and labels reach capture tools such as RenderDoc without
+    // validation, when the loader has the extension.
+    if (extension_list.Contains(kDebugUtilsExtensionName))
+      required_extensions.push_back(kDebugUtilsExtensionName);
+#endif  // defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+  }
+
+  // The validation layer provides the extension that selects its checks.
+  if (validation_level > VulkanValidationLevel::kCore) {
+    static constexpr char kValidationFeaturesExtensionName[] =
+        VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME;
+
+    VulkanExtensionList layer_extension_list(kValidationLayerName);
+    if (!layer_extension_list.Contains(kValidationFeaturesExtensionName)) {
+      std::cerr << "Validation layer does not support selecting validation features"
+                << std::endl;
+      std::abort();
+    }
+    required_extensions.push_back(kValidationFeaturesExtensionName);
   }
 
   // MoltenVK exposes devices with the VK_KHR_portability_subset extension.
@@ -60,6 +95,48 @@ bool WantVulkanValidation() {
   return required_extensions;
 }
 
+[[nodiscard]] std::vector<VkValidationFeatureEnableEXT> ValidationFeatureEnables(
+    VulkanValidationLevel validation_level) {
+  std::vector<VkValidationFeatureEnableEXT> enables;
+
+  if (validation_level >= VulkanValidationLevel::kSynchronization)
+    enables.push_back(VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT);
+
+  if (validation_level >= VulkanValidationLevel::kFull) {
+    enables.push_back(VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT);
+    enables.push_back(VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_RESERVE_BINDING_SLOT_EXT);
+    enables.push_back(VK_VALIDATION_FEATURE_ENABLE_BEST_PRACTICES_EXT);
+  }
+
+  return enables;
+}
+
+[[nodiscard]] VkValidationFeaturesEXT ValidationFeatures(
+    const std::vector<VkValidationFeatureEnableEXT>& enables) {
+  return {
+    .sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT,
+    .pNext = nullptr,
+    .enabledValidationFeatureCount = static_cast<uint32_t>(enables.size()),
+    .pEnabledValidationFeatures = enables.data(),
+    .disabledValidationFeatureCount = 0,
+    .pDisabledValidationFeatures = nullptr,
+  };
+}
+
+[[nodiscard]] std::vector<const char*> RequiredHeadlessDeviceExtensions(
+    bool want_external_memory) {
+  std::vector<const char*> required_extensions;
+
+  // The base VK_KHR_external_memory and VK_KHR_external_semaphore extensions
+  // are core in Vulkan 1.1.
+  if (want_external_memory) {
+    required_extensions.push_back(VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME);
+    required_extensions.push_back(VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME);
+  }
+
+  return required_extensions;
+}
+
 [[nodiscard]] VkPhysicalDeviceFeatures RequiredDeviceFeatures() {
   VkPhysicalDeviceFeatures required_features{};
   required_features.geometryShader = true;
@@ -69,12 +146,56 @@ bool WantVulkanValidation() {
 
 }  // namespace
 
-VulkanConfig::VulkanConfig(const VulkanPresentationContext& presentation_context)
-    : want_validation_(WantVulkanValidation()),
-      required_layers_(RequiredVulkanLayers(want_validation_)),
-      required_instance_extensions_(RequiredVulkanInstanceExtensions(presentation_context, want_validation_)),
+std::optional<VulkanValidationLevel> ParseVulkanValidationLevel(std::string_view name) {
+  for (VulkanValidationLevel level :
+       {VulkanValidationLevel::kOff, VulkanValidationLevel::kCore,
+        VulkanValidationLevel::kSynchronization, VulkanValidationLevel::kFull}) {
+    if (name == VulkanValidationLevelName(level))
+      return level;
+  }
+  return std::nullopt;
+}
+
+const char* VulkanValidationLevelName(VulkanValidationLevel level) {
+  switch (level) {
+    case VulkanValidationLevel::kOff:
+      return "off";
+    case VulkanValidationLevel::kCore:
+      return "core";
+    case VulkanValidationLevel::kSynchronization:
+      return "sync";
+    case VulkanValidationLevel::kFull:
+      return "full";
+  }
+  return "unknown";
+}
+
+VulkanConfig::VulkanConfig(const VulkanPresentationContext& presentation_context,
+                           const VulkanLayerList& layers,
+                           const VulkanExtensionList& extensions)
+    : validation_level_(DefaultValidationLevel()),
+      required_layers_(RequiredVulkanLayers(validation_level_, layers)),
+      required_instance_extensions_(RequiredVulkanInstanceExtensions(
+          presentation_context.RequiredVulkanInstanceExtensions(), validation_level_,
+          extensions)),
       required_device_extensions_(presentation_context.RequiredVulkanDeviceExtensions()),
-      required_features_(RequiredDeviceFeatures()) {
+      required_features_(RequiredDeviceFeatures()),
+      validation_feature_enables_(ValidationFeatureEnables(validation_level_)),
+      validation_features_(ValidationFeatures(validation_feature_enables_)) {
+}
+
+VulkanConfig::VulkanConfig(bool want_external_memory)
+    : VulkanConfig(DefaultValidationLevel(), want_external_memory) {}
+
+VulkanConfig::VulkanConfig(VulkanValidationLevel validation_level, bool want_external_memory)
+    : validation_level_(validation_level),
+      required_layers_(RequiredVulkanLayers(validation_level_, VulkanLayerList())),
+      required_instance_extensions_(
+          RequiredVulkanInstanceExtensions({}, validation_level_, VulkanExtensionList())),
+      required_device_extensions_(RequiredHeadlessDeviceExtensions(want_external_memory)),
+      required_features_(),
+      validation_feature_enables_(ValidationFeatureEnables(validation_level_)),
+      validation_features_(ValidationFeatures(validation_feature_enables_)) {
 }
 
 VulkanConfig::~VulkanConfig() = default;
@@ -1,22 +1,80 @@
 #ifndef VULKAN_CONFIG_H_
 #define VULKAN_CONFIG_H_
 
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #include <vulkan/vulkan_core.h>
 
+class VulkanExtensionList;
+class VulkanLayerList;
 class VulkanPresentationContext;
 
+// How thoroughly the Vulkan validation layer checks API usage.
+//
+// Each level adds checks to the previous one, and costs more CPU time per
+// frame. The VULKAN_TUTORIAL_VALIDATION environment variable selects the
+// level by name. Debug builds default to kCore, release builds to kOff.
+enum class VulkanValidationLevel {
+  // "off": the validation layer is not loaded.
+  kOff,
+
+  // "core": the layer's default checks, covering parameters, object
+  // lifetimes, thread safety and the specification's usage rules.
+  kCore,
+
+  // "sync": adds synchronization validation, which reports missing and
+  // incorrect barriers.
+  kSynchronization,
+
+  // "full": adds GPU-assisted validation, which instruments shaders to check
+  // their descriptor accesses, and the best practices checks.
+  kFull,
+};
+
+// Returns nullopt for unknown names.
+[[nodiscard]] std::optional<VulkanValidationLevel> ParseVulkanValidationLevel(
+    std::string_view name);
+
+[[nodiscard]] const char* VulkanValidationLevelName(VulkanValidationLevel level);
+
 // Centralized logic for app-level Vulkan configuration.
 class VulkanConfig {
  public:
-  explicit VulkanConfig(const VulkanPresentationContext& presentation_context);
+  // `layers` and `extensions` list the instance-level layers and extensions,
+  // so callers that also print them only enumerate them once.
+  explicit VulkanConfig(const VulkanPresentationContext& presentation_context,
+                        const VulkanLayerList& layers, const VulkanExtensionList& extensions);
+
+  // Configuration for compute-only use, without a windowing system.
+  //
+  // If `want_external_memory` is true, devices must be able to share images
+  // and semaphores with other processes via file descriptors.
+  explicit VulkanConfig(bool want_external_memory = false);
+
+  // Compute-only configuration with the given validation level, instead of
+  // the level picked by the environment.
+  explicit VulkanConfig(VulkanValidationLevel validation_level,
+                        bool want_external_memory = false);
+
   VulkanConfig(const VulkanConfig&) = delete;
   VulkanConfig& operator=(const VulkanConfig&) = delete;
   ~VulkanConfig();
 
   // True if the app configuration enables Vulkan validation.
-  [[nodiscard]] bool WantValidation() const { return want_validation_; }
+  [[nodiscard]] bool WantValidation() const {
+    return validation_level_ != VulkanValidationLevel::kOff;
+  }
+
+  [[nodiscard]] VulkanValidationLevel ValidationLevel() const { return validation_level_; }
+
+  // Chained into VkInstanceCreateInfo to select the validation checks.
+  //
+  // Null if the validation layer's defaults are used.
+  [[nodiscard]] const VkValidationFeaturesEXT* ValidationFeatures() const {
+    return validation_feature_enables_.empty() ? nullptr : &validation_features_;
+  }
 
   // vkCreateInstance()-friendly list of required Vulkan layers.
   [[nodiscard]] const std::vector<const char*>& RequiredLayers() const {
@@ -38,11 +96,14 @@ class VulkanConfig {
   }
 
  private:
-  const bool want_validation_;
+  const VulkanValidationLevel validation_level_;
   const std::vector<const char*> required_layers_;
   const std::vector<const char*> required_instance_extensions_;
   const std::vector<const char*> required_device_extensions_;
   const VkPhysicalDeviceFeatures required_features_;
+
+  const std::vector<VkValidationFeatureEnableEXT> validation_feature_enables_;
+  const VkValidationFeaturesEXT validation_features_;
 };
 
 #endif  // VULKAN_CONFIG_H_
@@ -0,0 +1,82 @@
+#include "vulkan_debug_utils.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+#if defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+
+namespace {
+
+// FNV-1a, so names map to the same colors in every run.
+[[nodiscard]] uint32_t HashName(const char* name) {
+  uint32_t hash = 2166136261u;
+  for (const char* c = name; *c != '\0'; ++c)
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  return hash;
+}
+
+}  // namespace
+
+void SetVulkanObjectName(const VulkanDevice& device, VkObjectType object_type,
+                         uint64_t object_handle, const char* name) {
+  assert(object_handle != 0);
+  assert(name != nullptr);
+
+  const VulkanDeviceFunctions& functions = device.Functions();
+  if (functions.vkSetDebugUtilsObjectNameEXT == nullptr)
+    return;
+
+  VkDebugUtilsObjectNameInfoEXT name_info = {
+    .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+    .pNext = nullptr,
+    .objectType = object_type,
+    .objectHandle = object_handle,
+    .pObjectName = name,
+  };
+  VkResult result = functions.vkSetDebugUtilsObjectNameEXT(device.VulkanHandle(), &name_info);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkSetDebugUtilsObjectNameEXT() failed" << std::endl;
+    std::abort();
+  }
+}
+
+VulkanDebugLabelScope::VulkanDebugLabelScope(const VulkanDevice& device,
+                                             VkCommandBuffer command_buffer, const char* name)
+    : device_(device), command_buffer_(command_buffer) {
+  assert(command_buffer != VK_NULL_HANDLE);
+  assert(name != nullptr);
+
+  const VulkanDeviceFunctions& functions = device.Functions();
+  if (functions.vkCmdBeginDebugUtilsLabelEXT == nullptr)
+    return;
+
+  uint32_t hash = HashName(name);
+  VkDebugUtilsLabelEXT label = {
+    .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+    .pNext = nullptr,
+    .pLabelName = name,
+    .color = {
+      0.25f + 0.75f * static_cast<float>(hash & 0xff) / 255.0f,
+      0.25f + 0.75f * static_cast<float>((hash >> 8) & 0xff) / 255.0f,
+      0.25f + 0.75f * static_cast<float>((hash >> 16) & 0xff) / 255.0f,
+      1.0f,
+    },
+  };
+  functions.vkCmdBeginDebugUtilsLabelEXT(command_buffer, &label);
+}
+
+VulkanDebugLabelScope::~VulkanDebugLabelScope() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  if (functions.vkCmdEndDebugUtilsLabelEXT == nullptr)
+    return;
+
+  functions.vkCmdEndDebugUtilsLabelEXT(command_buffer_);
+}
+
+#endif  // defined(VULKAN_TUTORIAL_DEBUG_NAMES)
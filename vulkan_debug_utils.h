@@ -0,0 +1,64 @@
+#ifndef VULKAN_DEBUG_UTILS_H_
+#define VULKAN_DEBUG_UTILS_H_
+
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+
+// Names for Vulkan objects and command buffer regions, shown by debugging
+// and profiling tools such as RenderDoc.
+//
+// The names are only compiled in when the VULKAN_TUTORIAL_DEBUG_NAMES CMake
+// option is on. Otherwise the macros below expand to nothing, and their
+// arguments are not evaluated. Tools only see the names if the instance has
+// VK_EXT_debug_utils, which VulkanConfig enables when it's available.
+
+#if defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+
+// Non-dispatchable handles are pointers on 64-bit platforms, and 64-bit
+// integers elsewhere. Dispatchable handles are always pointers.
+// reinterpret_cast converts all of them.
+#define VULKAN_DEBUG_NAME(device, object_type, handle, name) \
+  SetVulkanObjectName((device), (object_type), reinterpret_cast<uint64_t>(handle), (name))
+
+#define VULKAN_DEBUG_LABEL_CONCAT_INNER(a, b) a##b
+#define VULKAN_DEBUG_LABEL_CONCAT(a, b) VULKAN_DEBUG_LABEL_CONCAT_INNER(a, b)
+
+// Labels the commands recorded until the end of the enclosing scope.
+#define VULKAN_DEBUG_LABEL_SCOPE(device, command_buffer, name)                    \
+  VulkanDebugLabelScope VULKAN_DEBUG_LABEL_CONCAT(vulkan_debug_label_, __LINE__)( \
+      (device), (command_buffer), (name))
+
+// Names the object with the given handle. No-op if the device doesn't have
+// the debug utils entry points.
+void SetVulkanObjectName(const VulkanDevice& device, VkObjectType object_type,
+                         uint64_t object_handle, const char* name);
+
+// Wraps commands in a debug utils label region.
+class VulkanDebugLabelScope {
+ public:
+  // `device` must outlive this instance. Its color is derived from `name`,
+  // so a region keeps its color across captures.
+  explicit VulkanDebugLabelScope(const VulkanDevice& device, VkCommandBuffer command_buffer,
+                                 const char* name);
+
+  VulkanDebugLabelScope(const VulkanDebugLabelScope&) = delete;
+  VulkanDebugLabelScope& operator=(const VulkanDebugLabelScope&) = delete;
+
+  ~VulkanDebugLabelScope();
+
+ private:
+  const VulkanDevice& device_;
+  const VkCommandBuffer command_buffer_;
+};
+
+#else  // defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+
+#define VULKAN_DEBUG_NAME(device, object_type, handle, name) static_cast<void>(0)
+#define VULKAN_DEBUG_LABEL_SCOPE(device, command_buffer, name) static_cast<void>(0)
+
+#endif  // defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+
+#endif  // VULKAN_DEBUG_UTILS_H_
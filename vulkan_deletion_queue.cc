@@ -0,0 +1,158 @@
+#include "vulkan_deletion_queue.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_device.h"
+
+namespace {
+
+// Non-dispatchable handles are pointers on 64-bit platforms, and 64-bit
+// integers elsewhere. reinterpret_cast converts both.
+template <typename Handle>
+[[nodiscard]] uint64_t HandleBits(Handle handle) {
+  assert(handle != VK_NULL_HANDLE);
+  return reinterpret_cast<uint64_t>(handle);
+}
+
+template <typename Handle>
+[[nodiscard]] Handle HandleFromBits(uint64_t handle_bits) {
+  return reinterpret_cast<Handle>(handle_bits);
+}
+
+}  // namespace
+
+VulkanDeletionQueue::VulkanDeletionQueue(const VulkanDevice& device) : device_(device) {}
+
+VulkanDeletionQueue::~VulkanDeletionQueue() {
+  for (Deletion& deletion : deletions_)
+    Release(deletion);
+}
+
+void VulkanDeletionQueue::Destroy(VkBuffer buffer, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_BUFFER, HandleBits(buffer), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkImage image, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_IMAGE, HandleBits(image), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkImageView image_view, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_IMAGE_VIEW, HandleBits(image_view), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkSampler sampler, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_SAMPLER, HandleBits(sampler), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkFramebuffer framebuffer, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_FRAMEBUFFER, HandleBits(framebuffer), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkPipeline pipeline, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_PIPELINE, HandleBits(pipeline), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkDescriptorPool descriptor_pool, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_DESCRIPTOR_POOL, HandleBits(descriptor_pool), {},
+           std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VkSwapchainKHR swap_chain, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_SWAPCHAIN_KHR, HandleBits(swap_chain), {}, std::nullopt});
+}
+
+void VulkanDeletionQueue::Destroy(VulkanBuffer&& buffer, uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_UNKNOWN, 0, {}, std::move(buffer)});
+}
+
+void VulkanDeletionQueue::Free(const VulkanDevice::MemoryAllocation& allocation,
+                               uint64_t last_use) {
+  Enqueue({last_use, VK_OBJECT_TYPE_DEVICE_MEMORY, HandleBits(allocation.memory), allocation,
+           std::nullopt});
+}
+
+void VulkanDeletionQueue::Collect(uint64_t retired_value) {
+  std::vector<Deletion> retired;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!deletions_.empty() && deletions_.front().last_use <= retired_value) {
+      retired.push_back(std::move(deletions_.front()));
+      deletions_.pop_front();
+    }
+  }
+
+  // Destroying objects can take a while, so other threads can keep queueing.
+  for (Deletion& deletion : retired)
+    Release(deletion);
+}
+
+size_t VulkanDeletionQueue::PendingCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return deletions_.size();
+}
+
+void VulkanDeletionQueue::Enqueue(Deletion deletion) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!deletions_.empty() && deletion.last_use < deletions_.back().last_use)
+    deletion.last_use = deletions_.back().last_use;
+  deletions_.push_back(std::move(deletion));
+}
+
+void VulkanDeletionQueue::Release(Deletion& deletion) const {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+  uint64_t handle = deletion.object_handle;
+
+  switch (deletion.object_type) {
+    case VK_OBJECT_TYPE_UNKNOWN:
+      assert(deletion.buffer.has_value());
+      deletion.buffer.reset();
+      break;
+    case VK_OBJECT_TYPE_BUFFER:
+      functions.vkDestroyBuffer(device, HandleFromBits<VkBuffer>(handle), /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_IMAGE:
+      functions.vkDestroyImage(device, HandleFromBits<VkImage>(handle), /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_IMAGE_VIEW:
+      functions.vkDestroyImageView(device, HandleFromBits<VkImageView>(handle),
+                                   /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_SAMPLER:
+      functions.vkDestroySampler(device, HandleFromBits<VkSampler>(handle),
+                                 /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_FRAMEBUFFER:
+      functions.vkDestroyFramebuffer(device, HandleFromBits<VkFramebuffer>(handle),
+                                     /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_PIPELINE:
+      functions.vkDestroyPipeline(device, HandleFromBits<VkPipeline>(handle),
+                                  /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+      functions.vkDestroyDescriptorPool(device, HandleFromBits<VkDescriptorPool>(handle),
+                                        /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+      functions.vkDestroySwapchainKHR(device, HandleFromBits<VkSwapchainKHR>(handle),
+                                      /*pAllocator=*/nullptr);
+      break;
+    case VK_OBJECT_TYPE_DEVICE_MEMORY:
+      device_.FreeMemory(deletion.allocation);
+      break;
+    default:
+      std::cerr << "Unsupported object type in deletion queue" << std::endl;
+      std::abort();
+  }
+}
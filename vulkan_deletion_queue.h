@@ -0,0 +1,86 @@
+#ifndef VULKAN_DELETION_QUEUE_H_
+#define VULKAN_DELETION_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_device.h"
+
+// Destroys Vulkan objects once the GPU is done with them.
+//
+// Each object is queued with the value of the last frame (or other
+// monotonic GPU timeline) that uses it. Collect() destroys the objects whose
+// value has retired. Replacing resources while rendering, for streaming,
+// resizing or hot reloading, then doesn't need to wait for the device to go
+// idle.
+//
+// All methods can be called from any thread.
+class VulkanDeletionQueue {
+ public:
+  // `device` must outlive this instance.
+  explicit VulkanDeletionQueue(const VulkanDevice& device);
+
+  VulkanDeletionQueue(const VulkanDeletionQueue&) = delete;
+  VulkanDeletionQueue& operator=(const VulkanDeletionQueue&) = delete;
+
+  // Destroys all the queued objects. The GPU must be done using them.
+  ~VulkanDeletionQueue();
+
+  // Queues an object for destruction after `last_use` retires.
+  //
+  // Objects are destroyed in the order they are queued. Values lower than
+  // the last queued value are treated as the last queued value, which delays
+  // the destruction, but is always safe.
+  void Destroy(VkBuffer buffer, uint64_t last_use);
+  void Destroy(VkImage image, uint64_t last_use);
+  void Destroy(VkImageView image_view, uint64_t last_use);
+  void Destroy(VkSampler sampler, uint64_t last_use);
+  void Destroy(VkFramebuffer framebuffer, uint64_t last_use);
+  void Destroy(VkPipeline pipeline, uint64_t last_use);
+  void Destroy(VkDescriptorPool descriptor_pool, uint64_t last_use);
+  void Destroy(VkSwapchainKHR swap_chain, uint64_t last_use);
+  void Destroy(VulkanBuffer&& buffer, uint64_t last_use);
+
+  // Memory is freed via VulkanDevice::FreeMemory().
+  void Free(const VulkanDevice::MemoryAllocation& allocation, uint64_t last_use);
+
+  // Destroys the objects whose last use is at most `retired_value`.
+  void Collect(uint64_t retired_value);
+
+  // Number of objects waiting for their last use to retire.
+  [[nodiscard]] size_t PendingCount();
+
+ private:
+  struct Deletion {
+    uint64_t last_use;
+
+    // Handles are stored the way VkDebugUtilsObjectNameInfoEXT stores them.
+    VkObjectType object_type;
+    uint64_t object_handle;
+
+    // Set for VK_OBJECT_TYPE_DEVICE_MEMORY.
+    VulkanDevice::MemoryAllocation allocation;
+
+    // Set for VulkanBuffer instances, whose object type is
+    // VK_OBJECT_TYPE_UNKNOWN.
+    std::optional<VulkanBuffer> buffer;
+  };
+
+  void Enqueue(Deletion deletion);
+
+  // Destroys the object referenced by `deletion`.
+  void Release(Deletion& deletion) const;
+
+  const VulkanDevice& device_;
+
+  std::mutex mutex_;
+  std::deque<Deletion> deletions_;  // Guarded by `mutex_`. Sorted by last use.
+};
+
+#endif  // VULKAN_DELETION_QUEUE_H_
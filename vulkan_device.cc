@@ -1,36 +1,44 @@
 #include "vulkan_device.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include <vulkan/vulkan_core.h>
 
 #include "vulkan_config.h"
-#include "vulkan_presentation_context.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_dispatch.h"
 #include "vulkan_physical_device.h"
-#include "vulkan_surface_support.h"
 
 namespace {
 
-[[nodiscard]] VkDevice CreateDevice(
-    const VulkanConfig& vulkan_config,
-    const VulkanSurfaceSupport& surface_support,
-    VulkanPhysicalDevice& physical_device) {
-  assert(physical_device.VulkanHandle() == surface_support.PhysicalDeviceVulkanHandle());
-  assert(surface_support.IsAcceptable());
-
+[[nodiscard]] VkPhysicalDeviceFeatures PresentationDeviceFeatures() {
   VkPhysicalDeviceFeatures required_features{};
   required_features.tessellationShader = true;
 
-  VulkanSurfaceSupport::Queues queues = surface_support.QueueFamilyIndexes();
+  return required_features;
+}
 
-  std::set<uint32_t> family_indexes = {
-      queues.graphics_queue_family_index,
-      queues.presentation_queue_family_index,
-  };
+[[nodiscard]] uint32_t ComputeQueueFamilyIndex(const VulkanPhysicalDevice& physical_device) {
+  const std::vector<uint32_t>& family_indexes = physical_device.ComputeQueueFamilyIndices();
+  assert(!family_indexes.empty());
+
+  return family_indexes.front();
+}
+
+[[nodiscard]] VkDevice CreateDevice(
+    const VulkanConfig& vulkan_config, const std::set<uint32_t>& family_indexes,
+    const VkPhysicalDeviceFeatures& required_features, bool enable_graphics_pipeline_library,
+    VulkanPhysicalDevice& physical_device) {
+  assert(!family_indexes.empty());
 
   const float kQueuePriorities[] = {1.0};
 
@@ -57,10 +65,25 @@ namespace {
   static constexpr char kPortabilityExtensionName[] = "VK_KHR_portability_subset";
   if (physical_device.HasExtension({kPortabilityExtensionName}))
     required_extensions.push_back(kPortabilityExtensionName);
+  if (physical_device.HasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    required_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT library_features{};
+  library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+  library_features.graphicsPipelineLibrary = VK_TRUE;
+  if (enable_graphics_pipeline_library) {
+    assert(physical_device.HasGraphicsPipelineLibrary());
+    required_extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+    required_extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+  }
+
+  // Optional features are enabled whenever they're supported.
+  VkPhysicalDeviceFeatures enabled_features = required_features;
+  enabled_features.pipelineStatisticsQuery = physical_device.HasPipelineStatisticsQuery();
 
   VkDeviceCreateInfo device_create_info = {
     .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-    .pNext = nullptr,
+    .pNext = enable_graphics_pipeline_library ? &library_features : nullptr,
     .flags = 0,
     .queueCreateInfoCount = static_cast<uint32_t>(queue_create_info.size()),
     .pQueueCreateInfos = queue_create_info.data(),
@@ -68,7 +91,7 @@ namespace {
     .ppEnabledLayerNames = required_layers.data(),
     .enabledExtensionCount = static_cast<uint32_t>(required_extensions.size()),
     .ppEnabledExtensionNames = required_extensions.data(),
-    .pEnabledFeatures = &required_features,
+    .pEnabledFeatures = &enabled_features,
   };
 
   VkDevice device = VK_NULL_HANDLE;
@@ -81,199 +104,198 @@ namespace {
   return device;
 }
 
-[[nodiscard]] VkSwapchainKHR CreateSwapChain(
-    const VulkanSurfaceSupport& surface_support,
-    const VulkanPresentationSurface& surface,
-    VkDevice logical_device) {
-  assert(surface.VulkanHandle() == surface_support.SurfaceVulkanHandle());
-  assert(surface_support.IsAcceptable());
-
-
-  VulkanSurfaceSupport::Queues queues = surface_support.QueueFamilyIndexes();
-  bool is_unified_queue =
-      (queues.graphics_queue_family_index == queues.presentation_queue_family_index);
-  const uint32_t queue_family_indexes[] = {
-    queues.graphics_queue_family_index,
-    queues.presentation_queue_family_index,
-  };
-
-  VkSurfaceFormatKHR surface_format = surface_support.BestFormat();
-  VkExtent2D image_extent = surface_support.BestExtentFor(surface.Size());
-  VkSwapchainCreateInfoKHR create_info = {
-    .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-    .pNext = nullptr,
-    .flags = 0,
-    .surface = surface.VulkanHandle(),
-    .minImageCount = static_cast<uint32_t>(surface_support.BestImageCount()),
-    .imageFormat = surface_format.format,
-    .imageColorSpace = surface_format.colorSpace,
-    .imageExtent = image_extent,
-    .imageArrayLayers = 1,
-    .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-    .imageSharingMode = is_unified_queue ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT,
-    .queueFamilyIndexCount = static_cast<uint32_t>(is_unified_queue ? 0 : 2),
-    .pQueueFamilyIndices = is_unified_queue ? nullptr : queue_family_indexes,
-    .preTransform = surface_support.CurrentTransform(),
-    .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-    .presentMode = surface_support.BestMode(),
-    .clipped = VK_TRUE,
-    .oldSwapchain = VK_NULL_HANDLE,  // TODO(pwnall): Change when recreating.
-  };
-
-  VkSwapchainKHR swap_chain = VK_NULL_HANDLE;
-  VkResult result = vkCreateSwapchainKHR(logical_device, &create_info, /*pAllocator=*/nullptr, &swap_chain);
-  if (result != VK_SUCCESS) {
-    std::cerr << "vkCreateSwapchainKHR() failed" << std::endl;
-    std::abort();
-  }
-  return swap_chain;
-}
-
-VkQueue GetGraphicsQueue(const VulkanSurfaceSupport& surface_support, VkDevice logical_device) {
-  uint32_t family_index = surface_support.QueueFamilyIndexes().graphics_queue_family_index;
-
+[[nodiscard]] VkQueue GetQueue(
+    VkDevice logical_device, const VulkanDeviceFunctions& functions, uint32_t family_index) {
   VkQueue queue = VK_NULL_HANDLE;
-  vkGetDeviceQueue(logical_device, family_index, /*queueIndex=*/0, &queue);
+  functions.vkGetDeviceQueue(logical_device, family_index, /*queueIndex=*/0, &queue);
 
   assert(queue != VK_NULL_HANDLE);
   return queue;
 }
 
-VkQueue GetPresentationQueue(const VulkanSurfaceSupport& surface_support, VkDevice logical_device) {
-  uint32_t family_index = surface_support.QueueFamilyIndexes().graphics_queue_family_index;
-
-  VkQueue queue = VK_NULL_HANDLE;
-  vkGetDeviceQueue(logical_device, family_index, /*queueIndex=*/0, &queue);
-
-  assert(queue != VK_NULL_HANDLE);
-  return queue;
-}
-
-[[nodiscard]] std::vector<VkImage> GetSwapChainImages(
-    VkDevice logical_device, VkSwapchainKHR swap_chain) {
-  assert(swap_chain != VK_NULL_HANDLE);
-
-  uint32_t count = 0;
-  VkResult result = vkGetSwapchainImagesKHR(
-      logical_device, swap_chain, &count, /*pSwapchainImages=*/nullptr);
-  if (result != VK_SUCCESS) {
-    std::cerr << "vkGetSwapchainImagesKHR() failed to return count" << std::endl;
-    std::abort();
-  }
-
-  std::vector<VkImage> swap_chain_images(count);
-  result = vkGetSwapchainImagesKHR(logical_device, swap_chain, &count, swap_chain_images.data());
-  if (result != VK_SUCCESS) {
-    std::cerr << "vkGetSwapchainImagesKHR() failed to return list" << std::endl;
-    std::abort();
+[[nodiscard]] std::optional<uint32_t> FindMemoryTypeIndex(
+    const VkPhysicalDeviceMemoryProperties& memory_properties, uint32_t memory_type_bits,
+    VkMemoryPropertyFlags properties) {
+  for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+    if (!(memory_type_bits & (1u << i)))
+      continue;
+    if ((memory_properties.memoryTypes[i].propertyFlags & properties) != properties)
+      continue;
+    return i;
   }
-
-  return swap_chain_images;
+  return std::nullopt;
 }
 
-[[nodiscard]] VkImageView CreateImageView(
-    VkFormat image_format, VkDevice logical_device, VkImage image) {
-  VkImageViewCreateInfo create_info = {
-    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-    .pNext = nullptr,
-    .image = image,
-    .viewType = VK_IMAGE_VIEW_TYPE_2D,
-    .format = image_format,
-    .components = VkComponentMapping{
-      .r = VK_COMPONENT_SWIZZLE_IDENTITY,
-      .g = VK_COMPONENT_SWIZZLE_IDENTITY,
-      .b = VK_COMPONENT_SWIZZLE_IDENTITY,
-      .a = VK_COMPONENT_SWIZZLE_IDENTITY,
-    },
-    .subresourceRange = VkImageSubresourceRange{
-      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-      .baseMipLevel = 0,
-      .levelCount = 1,
-      .baseArrayLayer = 0,
-      .layerCount = 1,
-    },
-  };
+}  // namespace
 
-  VkImageView image_view = VK_NULL_HANDLE;
-  VkResult result = vkCreateImageView(
-      logical_device, &create_info, /*pAllocator=*/nullptr, &image_view);
-  if (result != VK_SUCCESS) {
-    std::cerr << "vkCreateImageView() failed" << std::endl;
-    std::abort();
-  }
-  return image_view;
-}
 
-[[nodiscard]] std::vector<VkImageView> CreateImageViews(
-    VkFormat image_format, VkDevice logical_device, const std::vector<VkImage>& images) {
-  std::vector<VkImageView> image_views;
-  image_views.reserve(images.size());
+VulkanDevice::VulkanDevice(
+    const VulkanConfig& vulkan_config, uint32_t graphics_queue_family_index,
+    uint32_t presentation_queue_family_index, VulkanPhysicalDevice& physical_device)
+    : device_(CreateDevice(vulkan_config,
+                           {graphics_queue_family_index, presentation_queue_family_index},
+                           PresentationDeviceFeatures(),
+                           physical_device.HasGraphicsPipelineLibrary(), physical_device)),
+      functions_(LoadVulkanDeviceFunctions(device_)),
+      physical_device_(physical_device.VulkanHandle()),
+      memory_properties_(physical_device.MemoryProperties()),
+      identity_(physical_device.Identity()),
+      subgroup_properties_(physical_device.SubgroupProperties()),
+      has_graphics_pipeline_library_(physical_device.HasGraphicsPipelineLibrary()),
+      has_memory_budget_(physical_device.HasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)),
+      has_pipeline_statistics_query_(physical_device.HasPipelineStatisticsQuery()),
+      timestamp_period_(physical_device.TimestampPeriod()),
+      timestamp_valid_bits_(physical_device.TimestampValidBits(graphics_queue_family_index)),
+      graphics_queue_family_index_(graphics_queue_family_index),
+      presentation_queue_family_index_(presentation_queue_family_index),
+      compute_queue_family_index_(0),
+      graphics_queue_(GetQueue(device_, functions_, graphics_queue_family_index_)),
+      presentation_queue_(GetQueue(device_, functions_, presentation_queue_family_index_)),
+      compute_queue_(VK_NULL_HANDLE),
+      heap_allocated_bytes_(std::make_unique<std::atomic<VkDeviceSize>[]>(VK_MAX_MEMORY_HEAPS)) {
+  const std::vector<uint32_t>& compute_family_indexes = physical_device.ComputeQueueFamilyIndices();
+  if (std::find(compute_family_indexes.begin(), compute_family_indexes.end(),
+                graphics_queue_family_index_) != compute_family_indexes.end()) {
+    compute_queue_family_index_ = graphics_queue_family_index_;
+    compute_queue_ = graphics_queue_;
+  }
 
-  for (VkImage image : images)
-    image_views.push_back(CreateImageView(image_format, logical_device, image));
-  return image_views;
+  VULKAN_DEBUG_NAME(*this, VK_OBJECT_TYPE_DEVICE, device_, "Presentation device");
+  // The presentation queue is named last, so a shared queue shows up as the
+  // presentation queue.
+  VULKAN_DEBUG_NAME(*this, VK_OBJECT_TYPE_QUEUE, graphics_queue_, "Graphics queue");
+  VULKAN_DEBUG_NAME(*this, VK_OBJECT_TYPE_QUEUE, presentation_queue_, "Presentation queue");
 }
 
-}  // namespace
-
-
-VulkanDevice::VulkanDevice(
-    const VulkanConfig& vulkan_config, const VulkanSurfaceSupport& surface_support,
-    const VulkanPresentationSurface& surface, VulkanPhysicalDevice& physical_device)
-    : device_(CreateDevice(vulkan_config, surface_support, physical_device)),
-      swap_chain_(CreateSwapChain(surface_support, surface, device_)),
-      swap_chain_format_(surface_support.BestFormat()),
-      graphics_queue_(GetGraphicsQueue(surface_support, device_)),
-      presentation_queue_(GetPresentationQueue(surface_support, device_)),
-      swap_chain_images_(GetSwapChainImages(device_, swap_chain_)),
-      swap_chain_image_views_(CreateImageViews(
-          swap_chain_format_.format, device_, swap_chain_images_)) {
+VulkanDevice::VulkanDevice(const VulkanConfig& vulkan_config, VulkanPhysicalDevice& physical_device)
+    : device_(CreateDevice(vulkan_config, {ComputeQueueFamilyIndex(physical_device)},
+                           VkPhysicalDeviceFeatures{},
+                           /*enable_graphics_pipeline_library=*/false, physical_device)),
+      functions_(LoadVulkanDeviceFunctions(device_)),
+      physical_device_(physical_device.VulkanHandle()),
+      memory_properties_(physical_device.MemoryProperties()),
+      identity_(physical_device.Identity()),
+      subgroup_properties_(physical_device.SubgroupProperties()),
+      has_graphics_pipeline_library_(false),
+      has_memory_budget_(physical_device.HasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)),
+      has_pipeline_statistics_query_(physical_device.HasPipelineStatisticsQuery()),
+      timestamp_period_(physical_device.TimestampPeriod()),
+      timestamp_valid_bits_(
+          physical_device.TimestampValidBits(ComputeQueueFamilyIndex(physical_device))),
+      graphics_queue_family_index_(0),
+      presentation_queue_family_index_(0),
+      compute_queue_family_index_(ComputeQueueFamilyIndex(physical_device)),
+      graphics_queue_(VK_NULL_HANDLE),
+      presentation_queue_(VK_NULL_HANDLE),
+      compute_queue_(GetQueue(device_, functions_, compute_queue_family_index_)),
+      heap_allocated_bytes_(std::make_unique<std::atomic<VkDeviceSize>[]>(VK_MAX_MEMORY_HEAPS)) {
+  VULKAN_DEBUG_NAME(*this, VK_OBJECT_TYPE_DEVICE, device_, "Compute device");
+  VULKAN_DEBUG_NAME(*this, VK_OBJECT_TYPE_QUEUE, compute_queue_, "Compute queue");
 }
 
 VulkanDevice::VulkanDevice(VulkanDevice&& rhs) noexcept
-  : device_(rhs.device_), swap_chain_(rhs.swap_chain_), swap_chain_format_(rhs.swap_chain_format_),
+  : device_(rhs.device_), functions_(rhs.functions_), physical_device_(rhs.physical_device_),
+    memory_properties_(rhs.memory_properties_), identity_(rhs.identity_),
+    subgroup_properties_(rhs.subgroup_properties_),
+    has_graphics_pipeline_library_(rhs.has_graphics_pipeline_library_),
+    has_memory_budget_(rhs.has_memory_budget_),
+    has_pipeline_statistics_query_(rhs.has_pipeline_statistics_query_),
+    timestamp_period_(rhs.timestamp_period_), timestamp_valid_bits_(rhs.timestamp_valid_bits_),
+    graphics_queue_family_index_(rhs.graphics_queue_family_index_),
+    presentation_queue_family_index_(rhs.presentation_queue_family_index_),
+    compute_queue_family_index_(rhs.compute_queue_family_index_),
     graphics_queue_(rhs.graphics_queue_), presentation_queue_(rhs.presentation_queue_),
-    swap_chain_images_(std::move(rhs.swap_chain_images_)),
-    swap_chain_image_views_(std::move(rhs.swap_chain_image_views_)) {
+    compute_queue_(rhs.compute_queue_),
+    heap_allocated_bytes_(std::move(rhs.heap_allocated_bytes_)) {
   rhs.device_ = VK_NULL_HANDLE;
-  rhs.swap_chain_ = VK_NULL_HANDLE;
   rhs.graphics_queue_ = VK_NULL_HANDLE;
   rhs.presentation_queue_ = VK_NULL_HANDLE;
+  rhs.compute_queue_ = VK_NULL_HANDLE;
 }
 
 VulkanDevice& VulkanDevice::operator=(VulkanDevice&& rhs) noexcept {
   // Vulkan handles need to be std::swap()ed because releasing can throw.
   std::swap(device_, rhs.device_);
-  std::swap(swap_chain_, rhs.swap_chain_);
+  std::swap(functions_, rhs.functions_);
 
   // std::swap() is unnecessary because `rhs` doesn't need to be valid for use.
   // `rhs` just needs to be in a good enough shape for its destructor to run.
-  swap_chain_format_ = rhs.swap_chain_format_;
+  physical_device_ = rhs.physical_device_;
+  memory_properties_ = rhs.memory_properties_;
+  identity_ = rhs.identity_;
+  subgroup_properties_ = rhs.subgroup_properties_;
+  has_graphics_pipeline_library_ = rhs.has_graphics_pipeline_library_;
+  has_memory_budget_ = rhs.has_memory_budget_;
+  has_pipeline_statistics_query_ = rhs.has_pipeline_statistics_query_;
+  timestamp_period_ = rhs.timestamp_period_;
+  timestamp_valid_bits_ = rhs.timestamp_valid_bits_;
+  graphics_queue_family_index_ = rhs.graphics_queue_family_index_;
+  presentation_queue_family_index_ = rhs.presentation_queue_family_index_;
+  compute_queue_family_index_ = rhs.compute_queue_family_index_;
 
   std::swap(graphics_queue_, rhs.graphics_queue_);
   std::swap(presentation_queue_, rhs.presentation_queue_);
-
-  swap_chain_images_ = std::move(rhs.swap_chain_images_);
-  swap_chain_image_views_ = std::move(rhs.swap_chain_image_views_);
+  std::swap(compute_queue_, rhs.compute_queue_);
+  std::swap(heap_allocated_bytes_, rhs.heap_allocated_bytes_);
   return *this;
 }
 
 VulkanDevice::~VulkanDevice() {
-  if (device_ == VK_NULL_HANDLE) {
-    assert(swap_chain_ == VK_NULL_HANDLE);
-    assert(swap_chain_image_views_.empty());
+  if (device_ == VK_NULL_HANDLE)
     return;
+
+  functions_.vkDeviceWaitIdle(device_);
+  functions_.vkDestroyDevice(device_, /*pAllocator=*/nullptr);
+}
+
+VulkanDevice::MemoryAllocation VulkanDevice::AllocateMemory(
+    const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required_properties,
+    VkMemoryPropertyFlags preferred_properties, const void* next) const {
+  assert(device_ != VK_NULL_HANDLE);
+
+  std::optional<uint32_t> memory_type_index = FindMemoryTypeIndex(
+      memory_properties_, requirements.memoryTypeBits, required_properties | preferred_properties);
+  if (!memory_type_index.has_value()) {
+    memory_type_index = FindMemoryTypeIndex(
+        memory_properties_, requirements.memoryTypeBits, required_properties);
+  }
+  if (!memory_type_index.has_value()) {
+    std::cerr << "No memory type satisfies the allocation requirements" << std::endl;
+    std::abort();
   }
 
+  VkMemoryAllocateInfo allocate_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .pNext = next,
+    .allocationSize = requirements.size,
+    .memoryTypeIndex = *memory_type_index,
+  };
 
-  if (swap_chain_ != VK_NULL_HANDLE) {
-    for (VkImageView image_view : swap_chain_image_views_)
-      vkDestroyImageView(device_, image_view, /*pAllocator=*/nullptr);
-    vkDestroySwapchainKHR(device_, swap_chain_, /*pAllocator=*/nullptr);
-  } else {
-    assert(swap_chain_image_views_.empty());
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkResult result = functions_.vkAllocateMemory(
+      device_, &allocate_info, /*pAllocator=*/nullptr, &memory);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkAllocateMemory() failed" << std::endl;
+    std::abort();
   }
 
-  vkDeviceWaitIdle(device_);
-  vkDestroyDevice(device_, /*pAllocator=*/nullptr);
+  uint32_t heap_index = memory_properties_.memoryTypes[*memory_type_index].heapIndex;
+  heap_allocated_bytes_[heap_index].fetch_add(requirements.size, std::memory_order_relaxed);
+
+  return {
+    .memory = memory,
+    .size = requirements.size,
+    .memory_type_index = *memory_type_index,
+    .property_flags = memory_properties_.memoryTypes[*memory_type_index].propertyFlags,
+  };
+}
+
+void VulkanDevice::FreeMemory(const MemoryAllocation& allocation) const {
+  assert(device_ != VK_NULL_HANDLE);
+  assert(allocation.memory != VK_NULL_HANDLE);
+
+  functions_.vkFreeMemory(device_, allocation.memory, /*pAllocator=*/nullptr);
+
+  uint32_t heap_index = memory_properties_.memoryTypes[allocation.memory_type_index].heapIndex;
+  heap_allocated_bytes_[heap_index].fetch_sub(allocation.size, std::memory_order_relaxed);
 }
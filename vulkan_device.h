@@ -1,22 +1,41 @@
 #ifndef VULKAN_DEVICE_H_
 #define VULKAN_DEVICE_H_
 
+#include <atomic>
 #include <cassert>
-#include <vector>
+#include <cstdint>
+#include <memory>
 
 #include <vulkan/vulkan_core.h>
 
+#include "vulkan_dispatch.h"
+#include "vulkan_physical_device.h"
+
 class VulkanConfig;
-class VulkanPhysicalDevice;
-class VulkanPresentationSurface;
-class VulkanSurfaceSupport;
 
 class VulkanDevice {
  public:
+  // A block of device memory returned by AllocateMemory().
+  struct MemoryAllocation {
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    uint32_t memory_type_index;
+    VkMemoryPropertyFlags property_flags;
+  };
+
   // Creates a new logical device connected to the given physical device.
+  //
+  // The device has one graphics queue and one presentation queue, which may be
+  // the same queue. Any number of VulkanSwapChain instances can present via
+  // the presentation queue.
   explicit VulkanDevice(
-      const VulkanConfig& vulkan_config, const VulkanSurfaceSupport& surface_support,
-      const VulkanPresentationSurface& surface, VulkanPhysicalDevice& physical_device);
+      const VulkanConfig& vulkan_config, uint32_t graphics_queue_family_index,
+      uint32_t presentation_queue_family_index, VulkanPhysicalDevice& physical_device);
+
+  // Creates a compute-only logical device connected to the given physical device.
+  //
+  // The device has a single compute queue, and no presentation queue.
+  explicit VulkanDevice(const VulkanConfig& vulkan_config, VulkanPhysicalDevice& physical_device);
 
   // Moving supported so instances can be returned.
   VulkanDevice(const VulkanDevice&) = delete;
@@ -32,26 +51,136 @@ class VulkanDevice {
     return device_;
   }
 
+  // Entry points that dispatch directly to this device's driver.
+  //
+  // Device-level commands should be issued through this table rather than
+  // through the loader's exported functions.
+  const VulkanDeviceFunctions& Functions() const {
+    assert(device_ != VK_NULL_HANDLE);
+    return functions_;
+  }
+
+  VkPhysicalDevice PhysicalDeviceVulkanHandle() const {
+    assert(device_ != VK_NULL_HANDLE);
+    return physical_device_;
+  }
+
+  // Identifies the physical device to other processes sharing memory with it.
+  const VulkanDeviceIdentity& Identity() const {
+    assert(device_ != VK_NULL_HANDLE);
+    return identity_;
+  }
+
+  // See VulkanPhysicalDevice::SubgroupProperties().
+  const VkPhysicalDeviceSubgroupProperties& SubgroupProperties() const {
+    assert(device_ != VK_NULL_HANDLE);
+    return subgroup_properties_;
+  }
+
+  // True if VK_EXT_graphics_pipeline_library is enabled, which happens on
+  // graphics devices whose VulkanPhysicalDevice::HasGraphicsPipelineLibrary().
+  bool HasGraphicsPipelineLibrary() const { return has_graphics_pipeline_library_; }
+
+  // True if the pipelineStatisticsQuery feature is enabled, which happens on
+  // all devices that support it.
+  bool HasPipelineStatisticsQuery() const { return has_pipeline_statistics_query_; }
+
+  // Nanoseconds per timestamp query tick.
+  float TimestampPeriod() const { return timestamp_period_; }
+
+  // Meaningful bits in timestamps written on the graphics queue, or on the
+  // compute queue of compute-only devices. 0 if timestamps aren't supported.
+  uint32_t TimestampValidBits() const { return timestamp_valid_bits_; }
+
+  // True if VK_EXT_memory_budget is enabled, which happens on all devices
+  // that support it.
+  bool HasMemoryBudget() const { return has_memory_budget_; }
+
+  const VkPhysicalDeviceMemoryProperties& MemoryProperties() const {
+    assert(device_ != VK_NULL_HANDLE);
+    return memory_properties_;
+  }
+
+  // True for devices created without a presentation queue.
+  bool IsComputeOnly() const { return presentation_queue_ == VK_NULL_HANDLE; }
+
   VkQueue GraphicsQueue() const {
     assert(device_ != VK_NULL_HANDLE);
     assert(graphics_queue_ != VK_NULL_HANDLE);
     return graphics_queue_;
   }
+  uint32_t GraphicsQueueFamilyIndex() const {
+    assert(device_ != VK_NULL_HANDLE);
+    assert(graphics_queue_ != VK_NULL_HANDLE);
+    return graphics_queue_family_index_;
+  }
   VkQueue PresentationQueue() const {
     assert(device_ != VK_NULL_HANDLE);
     assert(presentation_queue_ != VK_NULL_HANDLE);
     return presentation_queue_;
   }
+  uint32_t PresentationQueueFamilyIndex() const {
+    assert(device_ != VK_NULL_HANDLE);
+    assert(presentation_queue_ != VK_NULL_HANDLE);
+    return presentation_queue_family_index_;
+  }
+
+  // On graphics devices, this is the graphics queue, if it supports compute
+  // commands. Compute-only devices always have a compute queue.
+  VkQueue ComputeQueue() const {
+    assert(device_ != VK_NULL_HANDLE);
+    assert(compute_queue_ != VK_NULL_HANDLE);
+    return compute_queue_;
+  }
+  uint32_t ComputeQueueFamilyIndex() const {
+    assert(device_ != VK_NULL_HANDLE);
+    assert(compute_queue_ != VK_NULL_HANDLE);
+    return compute_queue_family_index_;
+  }
+
+  // Allocates memory that satisfies `requirements`.
+  //
+  // The allocation is made from a memory type that has all the
+  // `required_properties`. Memory types that also have all the
+  // `preferred_properties` are used if available. `next` is chained into the
+  // VkMemoryAllocateInfo.
+  [[nodiscard]] MemoryAllocation AllocateMemory(
+      const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required_properties,
+      VkMemoryPropertyFlags preferred_properties = 0, const void* next = nullptr) const;
+
+  // Releases memory returned by AllocateMemory().
+  void FreeMemory(const MemoryAllocation& allocation) const;
+
+  // Bytes currently allocated by AllocateMemory() from a memory heap.
+  //
+  // Can be called from any thread.
+  [[nodiscard]] VkDeviceSize AllocatedBytes(uint32_t heap_index) const {
+    assert(device_ != VK_NULL_HANDLE);
+    assert(heap_index < memory_properties_.memoryHeapCount);
+    return heap_allocated_bytes_[heap_index].load(std::memory_order_relaxed);
+  }
 
  private:
   VkDevice device_;
-  VkSwapchainKHR swap_chain_;
-  VkSurfaceFormatKHR swap_chain_format_;
-  // TODO(costan): Add VkExtent2D swap_chain_extent_;
+  VulkanDeviceFunctions functions_;
+  VkPhysicalDevice physical_device_;
+  VkPhysicalDeviceMemoryProperties memory_properties_;
+  VulkanDeviceIdentity identity_;
+  VkPhysicalDeviceSubgroupProperties subgroup_properties_;
+  bool has_graphics_pipeline_library_;
+  bool has_memory_budget_;
+  bool has_pipeline_statistics_query_;
+  float timestamp_period_;
+  uint32_t timestamp_valid_bits_;
+  uint32_t graphics_queue_family_index_;
+  uint32_t presentation_queue_family_index_;
+  uint32_t compute_queue_family_index_;
   VkQueue graphics_queue_;
   VkQueue presentation_queue_;
-  std::vector<VkImage> swap_chain_images_;
-  std::vector<VkImageView> swap_chain_image_views_;
+  VkQueue compute_queue_;
+
+  // Indexed by heap. Heap-allocated so the device can be moved.
+  std::unique_ptr<std::atomic<VkDeviceSize>[]> heap_allocated_bytes_;
 };
 
 #endif  // VULKAN_DEVICE_H_
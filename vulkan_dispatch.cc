@@ -0,0 +1,27 @@
+#include "vulkan_dispatch.h"
+
+#include <cassert>
+
+#include <vulkan/vulkan_core.h>
+
+VulkanInstanceFunctions LoadVulkanInstanceFunctions(VkInstance instance) {
+  assert(instance != VK_NULL_HANDLE);
+
+  VulkanInstanceFunctions functions;
+#define VULKAN_LOAD_FUNCTION(name) \
+  functions.name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(instance, #name));
+  VULKAN_INSTANCE_FUNCTIONS(VULKAN_LOAD_FUNCTION)
+#undef VULKAN_LOAD_FUNCTION
+  return functions;
+}
+
+VulkanDeviceFunctions LoadVulkanDeviceFunctions(VkDevice device) {
+  assert(device != VK_NULL_HANDLE);
+
+  VulkanDeviceFunctions functions;
+#define VULKAN_LOAD_FUNCTION(name) \
+  functions.name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name));
+  VULKAN_DEVICE_FUNCTIONS(VULKAN_LOAD_FUNCTION)
+#undef VULKAN_LOAD_FUNCTION
+  return functions;
+}
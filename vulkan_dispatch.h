@@ -0,0 +1,141 @@
+#ifndef VULKAN_DISPATCH_H_
+#define VULKAN_DISPATCH_H_
+
+#include <vulkan/vulkan_core.h>
+
+// Instance-level entry points that the loader does not export.
+//
+// Extension functions can't be linked statically, so they must be looked up
+// via vkGetInstanceProcAddr().
+#define VULKAN_INSTANCE_FUNCTIONS(X)  \
+  X(vkCreateDebugUtilsMessengerEXT) \
+  X(vkDestroyDebugUtilsMessengerEXT)
+
+// Device-level entry points used by the library.
+//
+// Entry points from device extensions that were not enabled are null.
+//
+// Calls made through the loader's exported symbols go through a trampoline
+// that finds the device's dispatch table before jumping to the driver. Calls
+// made through a VulkanDeviceFunctions table jump to the driver directly.
+#define VULKAN_DEVICE_FUNCTIONS(X)  \
+  X(vkDestroyDevice)                \
+  X(vkDeviceWaitIdle)               \
+  X(vkGetDeviceQueue)               \
+  X(vkQueueSubmit)                  \
+  X(vkQueueWaitIdle)                \
+  X(vkAllocateMemory)               \
+  X(vkFreeMemory)                   \
+  X(vkMapMemory)                    \
+  X(vkUnmapMemory)                  \
+  X(vkFlushMappedMemoryRanges)      \
+  X(vkInvalidateMappedMemoryRanges) \
+  X(vkGetMemoryFdKHR)               \
+  X(vkCreateBuffer)                 \
+  X(vkDestroyBuffer)                \
+  X(vkGetBufferMemoryRequirements)  \
+  X(vkBindBufferMemory)             \
+  X(vkCreateImage)                  \
+  X(vkDestroyImage)                 \
+  X(vkGetImageMemoryRequirements)   \
+  X(vkBindImageMemory)              \
+  X(vkCreateImageView)              \
+  X(vkDestroyImageView)             \
+  X(vkCreateSampler)                \
+  X(vkDestroySampler)               \
+  X(vkCreateFramebuffer)            \
+  X(vkDestroyFramebuffer)           \
+  X(vkCreateRenderPass)             \
+  X(vkDestroyRenderPass)            \
+  X(vkCreateSwapchainKHR)           \
+  X(vkDestroySwapchainKHR)          \
+  X(vkGetSwapchainImagesKHR)        \
+  X(vkAcquireNextImageKHR)          \
+  X(vkQueuePresentKHR)              \
+  X(vkCreateCommandPool)            \
+  X(vkDestroyCommandPool)           \
+  X(vkResetCommandPool)             \
+  X(vkAllocateCommandBuffers)       \
+  X(vkFreeCommandBuffers)           \
+  X(vkBeginCommandBuffer)           \
+  X(vkEndCommandBuffer)             \
+  X(vkResetCommandBuffer)           \
+  X(vkCreateFence)                  \
+  X(vkDestroyFence)                 \
+  X(vkResetFences)                  \
+  X(vkGetFenceStatus)               \
+  X(vkWaitForFences)                \
+  X(vkCreateSemaphore)              \
+  X(vkDestroySemaphore)             \
+  X(vkGetSemaphoreFdKHR)            \
+  X(vkImportSemaphoreFdKHR)         \
+  X(vkCreateShaderModule)           \
+  X(vkDestroyShaderModule)          \
+  X(vkCreateDescriptorSetLayout)    \
+  X(vkDestroyDescriptorSetLayout)   \
+  X(vkCreatePipelineLayout)         \
+  X(vkDestroyPipelineLayout)        \
+  X(vkCreateComputePipelines)       \
+  X(vkCreateGraphicsPipelines)      \
+  X(vkDestroyPipeline)              \
+  X(vkCreateDescriptorPool)         \
+  X(vkDestroyDescriptorPool)        \
+  X(vkResetDescriptorPool)          \
+  X(vkAllocateDescriptorSets)       \
+  X(vkUpdateDescriptorSets)         \
+  X(vkCreateQueryPool)              \
+  X(vkDestroyQueryPool)             \
+  X(vkGetQueryPoolResults)          \
+  X(vkCmdPipelineBarrier)           \
+  X(vkCmdBeginRenderPass)           \
+  X(vkCmdEndRenderPass)             \
+  X(vkCmdBindPipeline)              \
+  X(vkCmdBindDescriptorSets)        \
+  X(vkCmdBindVertexBuffers)         \
+  X(vkCmdBindIndexBuffer)           \
+  X(vkCmdPushConstants)             \
+  X(vkCmdSetViewport)               \
+  X(vkCmdSetScissor)                \
+  X(vkCmdDraw)                      \
+  X(vkCmdDrawIndexed)               \
+  X(vkCmdDispatch)                  \
+  X(vkCmdClearColorImage)           \
+  X(vkCmdFillBuffer)                \
+  X(vkCmdCopyBuffer)                \
+  X(vkCmdCopyBufferToImage)         \
+  X(vkCmdCopyImageToBuffer)         \
+  X(vkCmdResetQueryPool)            \
+  X(vkCmdBeginQuery)                \
+  X(vkCmdEndQuery)                  \
+  X(vkCmdWriteTimestamp)            \
+  X(vkSetDebugUtilsObjectNameEXT)   \
+  X(vkCmdBeginDebugUtilsLabelEXT)   \
+  X(vkCmdEndDebugUtilsLabelEXT)
+
+// Function pointer table for the instance-level entry points above.
+//
+// Entries are null if the extension that provides them is not enabled.
+struct VulkanInstanceFunctions {
+#define VULKAN_DECLARE_FUNCTION(name) PFN_##name name = nullptr;
+  VULKAN_INSTANCE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+#undef VULKAN_DECLARE_FUNCTION
+};
+
+// Function pointer table for the device-level entry points above.
+//
+// Entries are null if the extension that provides them is not enabled on the
+// device. The debug utils entries come from an instance extension, but take
+// device-level objects, so they are resolved here.
+struct VulkanDeviceFunctions {
+#define VULKAN_DECLARE_FUNCTION(name) PFN_##name name = nullptr;
+  VULKAN_DEVICE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+#undef VULKAN_DECLARE_FUNCTION
+};
+
+// Resolves the instance-level entry points for `instance`.
+[[nodiscard]] VulkanInstanceFunctions LoadVulkanInstanceFunctions(VkInstance instance);
+
+// Resolves the device-level entry points for `device`.
+[[nodiscard]] VulkanDeviceFunctions LoadVulkanDeviceFunctions(VkDevice device);
+
+#endif  // VULKAN_DISPATCH_H_
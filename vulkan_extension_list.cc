@@ -10,18 +10,18 @@
 
 namespace {
 
-[[nodiscard]] std::vector<VkExtensionProperties> ListVulkanInstanceExtensions() {
+[[nodiscard]] std::vector<VkExtensionProperties> ListVulkanInstanceExtensions(
+    const char* layer_name) {
   uint32_t count = 0;
   VkResult result = vkEnumerateInstanceExtensionProperties(
-      /*pLayerName=*/nullptr, &count, /*pProperties=*/nullptr);
+      layer_name, &count, /*pProperties=*/nullptr);
   if (result != VK_SUCCESS) {
     std::cerr << "vkEnumerateInstanceExtensionProperties() failed to return count" << std::endl;
     std::abort();
   }
 
   std::vector<VkExtensionProperties> extensions(count);
-  result = vkEnumerateInstanceExtensionProperties(
-      /*pLayerName=*/nullptr, &count, extensions.data());
+  result = vkEnumerateInstanceExtensionProperties(layer_name, &count, extensions.data());
   if (result != VK_SUCCESS) {
     std::cerr << "vkEnumerateInstanceExtensionProperties() failed to return list" << std::endl;
     std::abort();
@@ -55,7 +55,13 @@ namespace {
 
 }  // namespace
 
-VulkanExtensionList::VulkanExtensionList() : extensions_(ListVulkanInstanceExtensions()) {}
+VulkanExtensionList::VulkanExtensionList()
+    : extensions_(ListVulkanInstanceExtensions(/*layer_name=*/nullptr)) {}
+
+VulkanExtensionList::VulkanExtensionList(const char* layer_name)
+    : extensions_(ListVulkanInstanceExtensions(layer_name)) {
+  assert(layer_name != nullptr);
+}
 
 VulkanExtensionList::VulkanExtensionList(VkPhysicalDevice physical_device)
     : extensions_(ListVulkanDeviceExtensions(physical_device)) {}
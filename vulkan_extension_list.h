@@ -11,6 +11,9 @@ class VulkanExtensionList {
   // Creates a list of all supported instance-level layers.
   VulkanExtensionList();
 
+  // Creates a list of the instance-level extensions provided by a layer.
+  explicit VulkanExtensionList(const char* layer_name);
+
   // Creates a list of all device-level extensions supported by a physical device.
   explicit VulkanExtensionList(VkPhysicalDevice physical_device);
 
@@ -0,0 +1,343 @@
+#include "vulkan_frame_capture.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "frame_writer.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_pool.h"
+#include "vulkan_device.h"
+#include "vulkan_sync.h"
+#include "vulkan_yuv_converter.h"
+
+namespace {
+
+constexpr VkImageSubresourceRange kColorSubresourceRange = {
+  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+  .baseMipLevel = 0,
+  .levelCount = 1,
+  .baseArrayLayer = 0,
+  .layerCount = 1,
+};
+
+}  // namespace
+
+VulkanFrameCapture::VulkanFrameCapture(const VulkanDevice& device, VkQueue queue,
+                                       uint32_t queue_family_index, VkExtent2D extent,
+                                       FrameWriter& writer, int ring_size,
+                                       VulkanYuvConverter* yuv_converter)
+    : device_(device), queue_(queue), extent_(extent), writer_(writer),
+      yuv_converter_(yuv_converter),
+      command_pool_(device, queue_family_index, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT) {
+  assert(queue != VK_NULL_HANDLE);
+  assert(ring_size > 0);
+
+  VkBufferUsageFlags buffer_usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  if (yuv_converter != nullptr) {
+    assert(writer.FrameSize() == VulkanYuvConverter::PlanesSize(extent));
+    buffer_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  } else {
+    assert(writer.FrameSize() == size_t{extent.width} * extent.height * 4);
+  }
+
+  std::vector<VkCommandBuffer> command_buffers =
+      command_pool_.AllocateCommandBuffers(static_cast<uint32_t>(ring_size));
+
+  slots_.reserve(ring_size);
+  for (int i = 0; i < ring_size; ++i) {
+    // Reading from uncached memory on the host is very slow.
+    slots_.push_back(Slot{
+      .buffer = VulkanBuffer(device, writer.FrameSize(), buffer_usage,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                             VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
+      .command_buffer = command_buffers[i],
+      .fence = CreateVulkanFence(device),
+      .state = SlotState::kIdle,
+    });
+  }
+}
+
+VulkanFrameCapture::~VulkanFrameCapture() {
+  Flush();
+
+  for (const Slot& slot : slots_)
+    device_.Functions().vkDestroyFence(device_.VulkanHandle(), slot.fence, /*pAllocator=*/nullptr);
+}
+
+void VulkanFrameCapture::Capture(VkImage image, VkImageLayout image_layout) {
+  assert(yuv_converter_ == nullptr);
+  Submit(image, VK_NULL_HANDLE, image_layout);
+}
+
+void VulkanFrameCapture::Capture(VkImage image, VkImageView image_view,
+                                 VkImageLayout image_layout) {
+  assert(yuv_converter_ != nullptr);
+  assert(image_view != VK_NULL_HANDLE);
+  Submit(image, image_view, image_layout);
+}
+
+void VulkanFrameCapture::Submit(VkImage image, VkImageView image_view,
+                                VkImageLayout image_layout) {
+  assert(image != VK_NULL_HANDLE);
+  assert(image_layout != VK_IMAGE_LAYOUT_UNDEFINED);
+
+  Slot& slot = slots_[next_slot_];
+
+  // Slots are used round-robin, so the slot being reused holds the oldest
+  // capture. Its copy is usually done by now.
+  bool slot_copying;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slot_copying = (slot.state == SlotState::kCopying);
+  }
+  RetireCopies(/*wait=*/slot_copying);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    slot_written_.wait(lock, [&slot]() { return slot.state == SlotState::kIdle; });
+  }
+
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .pNext = nullptr,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    .pInheritanceInfo = nullptr,
+  };
+  VkResult result = functions.vkBeginCommandBuffer(slot.command_buffer, &begin_info);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkBeginCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  if (yuv_converter_ != nullptr)
+    RecordConversion(next_slot_, image, image_view, image_layout);
+  else
+    RecordCopy(slot, image, image_layout);
+
+  result = functions.vkEndCommandBuffer(slot.command_buffer);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkEndCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  result = functions.vkResetFences(device_.VulkanHandle(), 1, &slot.fence);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkResetFences() failed" << std::endl;
+    std::abort();
+  }
+
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .pNext = nullptr,
+    .waitSemaphoreCount = 0,
+    .pWaitSemaphores = nullptr,
+    .pWaitDstStageMask = nullptr,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &slot.command_buffer,
+    .signalSemaphoreCount = 0,
+    .pSignalSemaphores = nullptr,
+  };
+  result = functions.vkQueueSubmit(queue_, 1, &submit_info, slot.fence);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkQueueSubmit() failed" << std::endl;
+    std::abort();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slot.state = SlotState::kCopying;
+  }
+  copying_slots_.push_back(next_slot_);
+  next_slot_ = (next_slot_ + 1) % slots_.size();
+}
+
+void VulkanFrameCapture::Flush() {
+  while (!copying_slots_.empty())
+    RetireCopies(/*wait=*/true);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  slot_written_.wait(lock, [this]() {
+    for (const Slot& slot : slots_) {
+      if (slot.state != SlotState::kIdle)
+        return false;
+    }
+    return true;
+  });
+}
+
+void VulkanFrameCapture::RetireCopies(bool wait) {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  while (!copying_slots_.empty()) {
+    size_t slot_index = copying_slots_.front();
+    Slot& slot = slots_[slot_index];
+
+    if (wait) {
+      WaitForVulkanFence(device_, slot.fence);
+      wait = false;
+    } else {
+      VkResult result = functions.vkGetFenceStatus(device, slot.fence);
+      if (result == VK_NOT_READY)
+        return;
+      if (result != VK_SUCCESS) {
+        std::cerr << "vkGetFenceStatus() failed" << std::endl;
+        std::abort();
+      }
+    }
+    copying_slots_.pop_front();
+
+    slot.buffer.InvalidateMappedData();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slot.state = SlotState::kWriting;
+    }
+    writer_.Write(static_cast<const uint8_t*>(slot.buffer.MappedData()), [this, &slot]() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.state = SlotState::kIdle;
+      }
+      slot_written_.notify_all();
+    });
+  }
+}
+
+void VulkanFrameCapture::RecordCopy(const Slot& slot, VkImage image, VkImageLayout image_layout) {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkCommandBuffer command_buffer = slot.command_buffer;
+
+  // Waits for the rendering work submitted earlier on the same queue.
+  VkImageMemoryBarrier to_transfer_barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    .oldLayout = image_layout,
+    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = kColorSubresourceRange,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &to_transfer_barrier);
+
+  VkBufferImageCopy region = {
+    .bufferOffset = 0,
+    .bufferRowLength = 0,  // Tightly packed.
+    .bufferImageHeight = 0,
+    .imageSubresource = VkImageSubresourceLayers{
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .mipLevel = 0,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+    },
+    .imageOffset = VkOffset3D{.x = 0, .y = 0, .z = 0},
+    .imageExtent = VkExtent3D{.width = extent_.width, .height = extent_.height, .depth = 1},
+  };
+  functions.vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   slot.buffer.VulkanHandle(), 1, &region);
+
+  // Work submitted after the capture must wait for the copy to finish reading.
+  VkImageMemoryBarrier restore_barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+    .newLayout = image_layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = kColorSubresourceRange,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &restore_barrier);
+
+  VkBufferMemoryBarrier host_barrier = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .buffer = slot.buffer.VulkanHandle(),
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 1, &host_barrier, 0, nullptr);
+}
+
+void VulkanFrameCapture::RecordConversion(size_t slot_index, VkImage image,
+                                          VkImageView image_view, VkImageLayout image_layout) {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  const Slot& slot = slots_[slot_index];
+  VkCommandBuffer command_buffer = slot.command_buffer;
+
+  // Waits for the rendering work submitted earlier on the same queue.
+  VkImageMemoryBarrier to_general_barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+    .oldLayout = image_layout,
+    .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = kColorSubresourceRange,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &to_general_barrier);
+
+  // Each slot has its own descriptor set in the converter. The slot is idle,
+  // so its previous conversion has completed.
+  yuv_converter_->Record(command_buffer, static_cast<uint32_t>(slot_index), image_view,
+                         slot.buffer.VulkanHandle());
+
+  // Work submitted after the capture must wait for the conversion to finish
+  // reading.
+  VkImageMemoryBarrier restore_barrier = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = 0,
+    .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+    .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
+    .newLayout = image_layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = kColorSubresourceRange,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 0, nullptr, 1, &restore_barrier);
+
+  VkBufferMemoryBarrier host_barrier = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .buffer = slot.buffer.VulkanHandle(),
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 1, &host_barrier, 0, nullptr);
+}
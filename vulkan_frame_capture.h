@@ -0,0 +1,116 @@
+#ifndef VULKAN_FRAME_CAPTURE_H_
+#define VULKAN_FRAME_CAPTURE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_command_pool.h"
+
+class FrameWriter;
+class VulkanDevice;
+class VulkanYuvConverter;
+
+// Reads rendered images back to the host without stalling the render loop.
+//
+// Each captured image is copied into one of a ring of host-visible buffers.
+// A buffer is handed to a FrameWriter after its copy completes, which is
+// normally checked when the ring wraps around, several frames later. The
+// buffer is reused after the FrameWriter is done with it.
+//
+// With a VulkanYuvConverter, images are converted to YUV 4:2:0 on the GPU
+// before the readback, which reads back 1.5 bytes per pixel instead of 4.
+class VulkanFrameCapture {
+ public:
+  // `device` and `writer` must outlive this instance.
+  //
+  // Copies are submitted to `queue`, which must belong to the queue family at
+  // `queue_family_index`. `writer` must accept frames of size `extent`.
+  //
+  // If `yuv_converter` is not null, it must outlive this instance, accept
+  // `ring_size` pending conversions, and `queue` must support compute.
+  // `writer` must then accept YUV 4:2:0 frames.
+  explicit VulkanFrameCapture(const VulkanDevice& device, VkQueue queue,
+                              uint32_t queue_family_index, VkExtent2D extent, FrameWriter& writer,
+                              int ring_size = 3, VulkanYuvConverter* yuv_converter = nullptr);
+
+  VulkanFrameCapture(const VulkanFrameCapture&) = delete;
+  VulkanFrameCapture& operator=(const VulkanFrameCapture&) = delete;
+
+  // Waits for all the captured frames to be written.
+  ~VulkanFrameCapture();
+
+  // Submits a copy of `image` to the capture queue.
+  //
+  // The work that renders `image` must have been submitted to the capture
+  // queue before this call. The image must be in `image_layout`, and is
+  // returned to that layout after the copy.
+  //
+  // Only blocks if the ring is full of frames that have not been written yet.
+  //
+  // Only valid without a YUV converter.
+  void Capture(VkImage image, VkImageLayout image_layout);
+
+  // Submits a conversion of `image` to YUV to the capture queue.
+  //
+  // Same as above, but `image_view` must be a view of `image` that meets the
+  // requirements of VulkanYuvConverter::Record(). Only valid with a YUV
+  // converter.
+  void Capture(VkImage image, VkImageView image_view, VkImageLayout image_layout);
+
+  // Blocks until all the captured frames are written.
+  void Flush();
+
+ private:
+  enum class SlotState {
+    // Available for a new capture.
+    kIdle,
+    // Waiting for a copy submitted to the GPU.
+    kCopying,
+    // Waiting for the FrameWriter.
+    kWriting,
+  };
+
+  struct Slot {
+    VulkanBuffer buffer;
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    // Guarded by `mutex_`.
+    SlotState state;
+  };
+
+  // Hands completed copies to the writer, in capture order.
+  //
+  // If `wait` is true, blocks until the oldest copy completes.
+  void RetireCopies(bool wait);
+
+  void Submit(VkImage image, VkImageView image_view, VkImageLayout image_layout);
+
+  void RecordCopy(const Slot& slot, VkImage image, VkImageLayout image_layout);
+  void RecordConversion(size_t slot_index, VkImage image, VkImageView image_view,
+                        VkImageLayout image_layout);
+
+  const VulkanDevice& device_;
+  const VkQueue queue_;
+  const VkExtent2D extent_;
+  FrameWriter& writer_;
+  VulkanYuvConverter* const yuv_converter_;
+
+  VulkanCommandPool command_pool_;
+  std::vector<Slot> slots_;
+  size_t next_slot_ = 0;
+
+  // Indexes of the slots in the kCopying state, in capture order.
+  std::deque<size_t> copying_slots_;
+
+  std::mutex mutex_;
+  std::condition_variable slot_written_;
+};
+
+#endif  // VULKAN_FRAME_CAPTURE_H_
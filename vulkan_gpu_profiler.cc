@@ -0,0 +1,324 @@
+#include "vulkan_gpu_profiler.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+
+namespace {
+
+// Results are written in the order of the flag bits, which matches the
+// order of VulkanPipelineStatistics' fields.
+constexpr VkQueryPipelineStatisticFlags kGraphicsStatistics =
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+constexpr VkQueryPipelineStatisticFlags kComputeStatistics =
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+[[nodiscard]] VkQueryPipelineStatisticFlags StatisticsFlags(const VulkanDevice& device) {
+  if (!device.HasPipelineStatisticsQuery())
+    return 0;
+  return device.IsComputeOnly() ? kComputeStatistics : kGraphicsStatistics;
+}
+
+[[nodiscard]] uint32_t CountBits(uint32_t value) {
+  uint32_t count = 0;
+  for (; value != 0; value &= value - 1)
+    ++count;
+  return count;
+}
+
+[[nodiscard]] VkQueryPool CreateQueryPool(const VulkanDevice& device, VkQueryType query_type,
+                                          uint32_t query_count,
+                                          VkQueryPipelineStatisticFlags statistics_flags,
+                                          [[maybe_unused]] const char* debug_name) {
+  VkQueryPoolCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .queryType = query_type,
+    .queryCount = query_count,
+    .pipelineStatistics = statistics_flags,
+  };
+
+  VkQueryPool query_pool = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateQueryPool(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &query_pool);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateQueryPool() failed" << std::endl;
+    std::abort();
+  }
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_QUERY_POOL, query_pool, debug_name);
+  return query_pool;
+}
+
+// Each query's `values_per_query` results are followed by its availability.
+[[nodiscard]] std::vector<uint64_t> GetQueryResults(const VulkanDevice& device,
+                                                    VkQueryPool query_pool, uint32_t query_count,
+                                                    uint32_t values_per_query) {
+  uint32_t stride = (values_per_query + 1) * static_cast<uint32_t>(sizeof(uint64_t));
+  std::vector<uint64_t> results(static_cast<size_t>(query_count) * (values_per_query + 1), 0);
+
+  // Without VK_QUERY_RESULT_WAIT_BIT, unavailable queries report
+  // VK_NOT_READY instead of blocking.
+  VkResult result = device.Functions().vkGetQueryPoolResults(
+      device.VulkanHandle(), query_pool, /*firstQuery=*/0, query_count,
+      results.size() * sizeof(uint64_t), results.data(), stride,
+      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  if (result != VK_SUCCESS && result != VK_NOT_READY) {
+    std::cerr << "vkGetQueryPoolResults() failed" << std::endl;
+    std::abort();
+  }
+  return results;
+}
+
+}  // namespace
+
+VulkanGpuProfiler::Scope::Scope(VulkanGpuProfiler& profiler, VkCommandBuffer command_buffer,
+                                std::string_view name, bool count_samples)
+    : profiler_(profiler),
+      command_buffer_(command_buffer),
+      query_index_(static_cast<uint32_t>(profiler.current_frame_->passes.size())),
+      count_samples_(count_samples),
+      start_time_(std::chrono::steady_clock::now())
+#if defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+      , label_(profiler.device_, command_buffer, std::string(name).c_str())
+#endif  // defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+{
+  FrameQueries& frame = *profiler_.current_frame_;
+  frame.passes.push_back(Pass{
+    .name = std::string(name),
+    .count_samples = count_samples,
+    .cpu_milliseconds = 0,
+  });
+  profiler_.is_measuring_ = true;
+
+  const VulkanDeviceFunctions& functions = profiler_.device_.Functions();
+  if (frame.timestamp_pool != VK_NULL_HANDLE) {
+    functions.vkCmdWriteTimestamp(command_buffer_, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                  frame.timestamp_pool, query_index_ * 2);
+  }
+  if (frame.statistics_pool != VK_NULL_HANDLE) {
+    functions.vkCmdBeginQuery(command_buffer_, frame.statistics_pool, query_index_,
+                              /*flags=*/0);
+  }
+  // Approximate counts are enough to spot overdraw, and don't need the
+  // occlusionQueryPrecise feature.
+  if (count_samples_)
+    functions.vkCmdBeginQuery(command_buffer_, frame.occlusion_pool, query_index_, /*flags=*/0);
+}
+
+VulkanGpuProfiler::Scope::~Scope() {
+  FrameQueries& frame = *profiler_.current_frame_;
+  const VulkanDeviceFunctions& functions = profiler_.device_.Functions();
+  if (count_samples_)
+    functions.vkCmdEndQuery(command_buffer_, frame.occlusion_pool, query_index_);
+  if (frame.statistics_pool != VK_NULL_HANDLE)
+    functions.vkCmdEndQuery(command_buffer_, frame.statistics_pool, query_index_);
+  if (frame.timestamp_pool != VK_NULL_HANDLE) {
+    functions.vkCmdWriteTimestamp(command_buffer_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                  frame.timestamp_pool, query_index_ * 2 + 1);
+  }
+  profiler_.is_measuring_ = false;
+
+  frame.passes[query_index_].cpu_milliseconds = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start_time_).count();
+}
+
+VulkanGpuProfiler::VulkanGpuProfiler(const VulkanDevice& device, uint32_t frames_in_flight,
+                                     uint32_t max_passes_per_frame)
+    : device_(device),
+      max_passes_per_frame_(max_passes_per_frame),
+      statistics_flags_(StatisticsFlags(device)) {
+  assert(frames_in_flight > 0);
+  assert(max_passes_per_frame > 0);
+
+  frames_.reserve(frames_in_flight);
+  for (uint32_t i = 0; i < frames_in_flight; ++i) {
+    FrameQueries frame{};
+    if (device.TimestampValidBits() != 0) {
+      frame.timestamp_pool = CreateQueryPool(device, VK_QUERY_TYPE_TIMESTAMP,
+                                             max_passes_per_frame * 2,
+                                             /*statistics_flags=*/0, "Profiler timestamps");
+    }
+    if (statistics_flags_ != 0) {
+      frame.statistics_pool = CreateQueryPool(device, VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                                              max_passes_per_frame, statistics_flags_,
+                                              "Profiler pipeline statistics");
+    }
+    if (!device.IsComputeOnly()) {
+      frame.occlusion_pool = CreateQueryPool(device, VK_QUERY_TYPE_OCCLUSION,
+                                             max_passes_per_frame, /*statistics_flags=*/0,
+                                             "Profiler occlusion");
+    }
+    frames_.push_back(std::move(frame));
+  }
+}
+
+VulkanGpuProfiler::~VulkanGpuProfiler() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  for (FrameQueries& frame : frames_) {
+    for (VkQueryPool query_pool :
+         {frame.timestamp_pool, frame.statistics_pool, frame.occlusion_pool}) {
+      if (query_pool != VK_NULL_HANDLE)
+        functions.vkDestroyQueryPool(device, query_pool, /*pAllocator=*/nullptr);
+    }
+  }
+}
+
+void VulkanGpuProfiler::Collect(uint64_t retired_frame_number) {
+  for (FrameQueries& frame : frames_) {
+    if (frame.frame_number == 0 || frame.frame_number > retired_frame_number)
+      continue;
+
+    if (frame.frame_number > latest_frame_number_) {
+      latest_frame_ = ReadResults(frame);
+      latest_frame_number_ = frame.frame_number;
+    }
+    frame.frame_number = 0;
+  }
+}
+
+void VulkanGpuProfiler::BeginFrame(VkCommandBuffer command_buffer, uint64_t frame_number) {
+  assert(command_buffer != VK_NULL_HANDLE);
+  assert(frame_number > 0);
+  assert(!is_measuring_);
+
+  // The results of a frame that wasn't collected are dropped.
+  FrameQueries& frame = frames_[frame_number % frames_.size()];
+  frame.frame_number = frame_number;
+  frame.passes.clear();
+
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  if (frame.timestamp_pool != VK_NULL_HANDLE) {
+    functions.vkCmdResetQueryPool(command_buffer, frame.timestamp_pool, /*firstQuery=*/0,
+                                  max_passes_per_frame_ * 2);
+  }
+  if (frame.statistics_pool != VK_NULL_HANDLE) {
+    functions.vkCmdResetQueryPool(command_buffer, frame.statistics_pool, /*firstQuery=*/0,
+                                  max_passes_per_frame_);
+  }
+  if (frame.occlusion_pool != VK_NULL_HANDLE) {
+    functions.vkCmdResetQueryPool(command_buffer, frame.occlusion_pool, /*firstQuery=*/0,
+                                  max_passes_per_frame_);
+  }
+  current_frame_ = &frame;
+}
+
+VulkanGpuProfiler::Scope VulkanGpuProfiler::Measure(VkCommandBuffer command_buffer,
+                                                    std::string_view name, bool count_samples) {
+  assert(command_buffer != VK_NULL_HANDLE);
+  assert(current_frame_ != nullptr);
+  assert(!is_measuring_);
+  assert(!count_samples || current_frame_->occlusion_pool != VK_NULL_HANDLE);
+
+  if (current_frame_->passes.size() >= max_passes_per_frame_) {
+    std::cerr << "Too many GPU profiler passes in a frame" << std::endl;
+    std::abort();
+  }
+  return Scope(*this, command_buffer, name, count_samples);
+}
+
+std::vector<VulkanGpuPassStats> VulkanGpuProfiler::ReadResults(const FrameQueries& frame) const {
+  uint32_t pass_count = static_cast<uint32_t>(frame.passes.size());
+  std::vector<VulkanGpuPassStats> passes(pass_count);
+  if (pass_count == 0)
+    return passes;
+
+  for (uint32_t i = 0; i < pass_count; ++i) {
+    passes[i].name = frame.passes[i].name;
+    passes[i].cpu_milliseconds = frame.passes[i].cpu_milliseconds;
+  }
+
+  if (frame.timestamp_pool != VK_NULL_HANDLE) {
+    // Timestamps wrap around at TimestampValidBits().
+    uint32_t valid_bits = device_.TimestampValidBits();
+    uint64_t tick_mask = valid_bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << valid_bits) - 1;
+    std::vector<uint64_t> results = GetQueryResults(device_, frame.timestamp_pool,
+                                                    pass_count * 2, /*values_per_query=*/1);
+    for (uint32_t i = 0; i < pass_count; ++i) {
+      const uint64_t* begin = &results[i * 4];
+      const uint64_t* end = &results[i * 4 + 2];
+      if (begin[1] == 0 || end[1] == 0)
+        continue;
+      uint64_t ticks = (end[0] - begin[0]) & tick_mask;
+      passes[i].milliseconds =
+          static_cast<double>(ticks) * static_cast<double>(device_.TimestampPeriod()) * 1e-6;
+    }
+  }
+
+  if (frame.statistics_pool != VK_NULL_HANDLE) {
+    uint32_t value_count = CountBits(statistics_flags_);
+    std::vector<uint64_t> results = GetQueryResults(device_, frame.statistics_pool, pass_count,
+                                                    value_count);
+    for (uint32_t i = 0; i < pass_count; ++i) {
+      const uint64_t* values = &results[i * (value_count + 1)];
+      if (values[value_count] == 0)
+        continue;
+
+      VulkanPipelineStatistics statistics{};
+      if (statistics_flags_ == kGraphicsStatistics) {
+        statistics.vertex_shader_invocations = values[0];
+        statistics.clipping_invocations = values[1];
+        statistics.clipping_primitives = values[2];
+        statistics.fragment_shader_invocations = values[3];
+        statistics.compute_shader_invocations = values[4];
+      } else {
+        statistics.compute_shader_invocations = values[0];
+      }
+      passes[i].pipeline_statistics = statistics;
+    }
+  }
+
+  bool counts_samples = false;
+  for (const Pass& pass : frame.passes)
+    counts_samples = counts_samples || pass.count_samples;
+  if (counts_samples) {
+    std::vector<uint64_t> results = GetQueryResults(device_, frame.occlusion_pool, pass_count,
+                                                    /*values_per_query=*/1);
+    for (uint32_t i = 0; i < pass_count; ++i) {
+      if (frame.passes[i].count_samples && results[i * 2 + 1] != 0)
+        passes[i].samples_passed = results[i * 2];
+    }
+  }
+  return passes;
+}
+
+void VulkanGpuProfiler::PrintLatestFrame(std::ostream& stream) const {
+  for (const VulkanGpuPassStats& pass : latest_frame_) {
+    stream << "  " << pass.name << ": CPU " << pass.cpu_milliseconds << " ms";
+    if (pass.milliseconds.has_value())
+      stream << " GPU " << *pass.milliseconds << " ms";
+    if (pass.pipeline_statistics.has_value()) {
+      const VulkanPipelineStatistics& statistics = *pass.pipeline_statistics;
+      if (statistics_flags_ == kGraphicsStatistics) {
+        stream << " VS: " << statistics.vertex_shader_invocations
+               << " clipped: " << statistics.clipping_invocations << " -> "
+               << statistics.clipping_primitives
+               << " FS: " << statistics.fragment_shader_invocations;
+      }
+      stream << " CS: " << statistics.compute_shader_invocations;
+    }
+    if (pass.samples_passed.has_value())
+      stream << " samples: " << *pass.samples_passed;
+    stream << "\n";
+  }
+}
@@ -0,0 +1,160 @@
+#ifndef VULKAN_GPU_PROFILER_H_
+#define VULKAN_GPU_PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_debug_utils.h"
+
+class VulkanDevice;
+
+// Work counted by a VK_QUERY_TYPE_PIPELINE_STATISTICS query.
+//
+// Compute-only devices only count compute shader invocations.
+struct VulkanPipelineStatistics {
+  uint64_t vertex_shader_invocations;
+  // Primitives that reached the clipping stage, and primitives it output.
+  uint64_t clipping_invocations;
+  uint64_t clipping_primitives;
+  uint64_t fragment_shader_invocations;
+  uint64_t compute_shader_invocations;
+};
+
+// GPU-side measurements of one pass in a frame.
+//
+// Fragment shader invocations well above the vertex shader invocations point
+// to a fragment-bound pass. Fragment shader invocations well above the
+// samples that passed point to overdraw.
+struct VulkanGpuPassStats {
+  std::string name;
+  // Time the CPU spent recording the pass's commands.
+  double cpu_milliseconds;
+  // Null if the queue doesn't support timestamps.
+  std::optional<double> milliseconds;
+  // Null if the device doesn't support pipeline statistics queries.
+  std::optional<VulkanPipelineStatistics> pipeline_statistics;
+  // Null unless the pass was measured with `count_samples`.
+  std::optional<uint64_t> samples_passed;
+};
+
+// Measures the GPU time and work of passes recorded in frame command
+// buffers, along with the CPU time spent recording them.
+//
+// Each frame's queries are read back after the frame is retired, without
+// waiting for the GPU, so measurements are reported a few frames late.
+class VulkanGpuProfiler {
+ public:
+  // Measures the commands recorded while an instance is alive.
+  class Scope {
+   public:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope();
+
+   private:
+    friend class VulkanGpuProfiler;
+
+    explicit Scope(VulkanGpuProfiler& profiler, VkCommandBuffer command_buffer,
+                   std::string_view name, bool count_samples);
+
+    VulkanGpuProfiler& profiler_;
+    const VkCommandBuffer command_buffer_;
+    const uint32_t query_index_;
+    const bool count_samples_;
+    const std::chrono::steady_clock::time_point start_time_;
+#if defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+    // Constructed before the queries begin, and destroyed after they end.
+    VulkanDebugLabelScope label_;
+#endif  // defined(VULKAN_TUTORIAL_DEBUG_NAMES)
+  };
+
+  // `device` must outlive this instance.
+  //
+  // `frames_in_flight` must match the number of frames the GPU may render
+  // concurrently. Each frame can measure up to `max_passes_per_frame` passes.
+  explicit VulkanGpuProfiler(const VulkanDevice& device, uint32_t frames_in_flight,
+                             uint32_t max_passes_per_frame = 32);
+
+  VulkanGpuProfiler(const VulkanGpuProfiler&) = delete;
+  VulkanGpuProfiler& operator=(const VulkanGpuProfiler&) = delete;
+
+  // The GPU must not be using the queries, which is the case after
+  // VulkanPresenter's destructor runs.
+  ~VulkanGpuProfiler();
+
+  // Reads the queries of the frames that the GPU finished.
+  //
+  // Never blocks. Results that aren't available yet are left out.
+  void Collect(uint64_t retired_frame_number);
+
+  // Starts measuring a frame. Must be called before any Measure() call.
+  //
+  // `command_buffer` must be outside a render pass. The frame recorded
+  // `frames_in_flight` frames ago must be retired and collected.
+  void BeginFrame(VkCommandBuffer command_buffer, uint64_t frame_number);
+
+  // Measures the commands recorded until the returned scope is destroyed.
+  //
+  // Scopes can't be nested, because only one query of each type can be
+  // active at a time. A scope must begin and end in the same subpass, or
+  // outside render passes. `count_samples` adds an occlusion query, and is
+  // only supported on graphics devices.
+  [[nodiscard]] Scope Measure(VkCommandBuffer command_buffer, std::string_view name,
+                              bool count_samples = false);
+
+  // The passes of the most recently collected frame, in recording order.
+  [[nodiscard]] const std::vector<VulkanGpuPassStats>& LatestFrame() const {
+    return latest_frame_;
+  }
+
+  // The frame whose passes LatestFrame() returns, or 0 before any frame is
+  // collected.
+  [[nodiscard]] uint64_t LatestFrameNumber() const { return latest_frame_number_; }
+
+  // Writes the passes of the most recently collected frame, one per line.
+  void PrintLatestFrame(std::ostream& stream) const;
+
+ private:
+  struct Pass {
+    std::string name;
+    bool count_samples;
+    double cpu_milliseconds;
+  };
+
+  // The queries used by one frame in flight.
+  struct FrameQueries {
+    // The frame whose results are pending, or 0.
+    uint64_t frame_number;
+    // Null if the queue doesn't support timestamps. Each pass writes two.
+    VkQueryPool timestamp_pool;
+    // Null if the device doesn't support pipeline statistics queries.
+    VkQueryPool statistics_pool;
+    // Null on compute-only devices.
+    VkQueryPool occlusion_pool;
+    std::vector<Pass> passes;
+  };
+
+  [[nodiscard]] std::vector<VulkanGpuPassStats> ReadResults(const FrameQueries& frame) const;
+
+  const VulkanDevice& device_;
+  const uint32_t max_passes_per_frame_;
+  const VkQueryPipelineStatisticFlags statistics_flags_;
+  std::vector<FrameQueries> frames_;
+
+  // Set by BeginFrame().
+  FrameQueries* current_frame_ = nullptr;
+  bool is_measuring_ = false;
+
+  uint64_t latest_frame_number_ = 0;
+  std::vector<VulkanGpuPassStats> latest_frame_;
+};
+
+#endif  // VULKAN_GPU_PROFILER_H_
@@ -0,0 +1,535 @@
+#include "vulkan_hud.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+#include "vulkan_shader_module.h"
+
+namespace {
+
+// Must match shaders/hud.frag.
+constexpr uint32_t kSolidGlyph = 0xffffffff;
+constexpr uint32_t kGlyphWidth = 3;
+constexpr uint32_t kGlyphHeight = 5;
+constexpr char kFirstGlyph = ' ';
+constexpr char kLastGlyph = '_';
+
+// Layout, in pixels. Each font pixel covers kFontScale x kFontScale pixels.
+constexpr float kFontScale = 2;
+constexpr float kGlyphAdvance = (kGlyphWidth + 1) * kFontScale;
+constexpr float kLineAdvance = (kGlyphHeight + 2) * kFontScale;
+constexpr float kMargin = 8;
+constexpr float kPadding = 6;
+constexpr float kFrameTimeBarWidth = 2;
+constexpr float kGraphHeight = 64;
+
+// The graph's top is two 60 Hz frames. Its middle line is one frame.
+constexpr float kGraphMaxMilliseconds = 1000.0f / 30;
+constexpr float kFrameBudgetMilliseconds = 1000.0f / 60;
+
+constexpr uint32_t kPanelColor = VulkanHud::Color(0, 0, 0, 160);
+constexpr uint32_t kBudgetLineColor = VulkanHud::Color(255, 255, 255, 96);
+constexpr uint32_t kOnBudgetColor = VulkanHud::Color(64, 224, 64);
+constexpr uint32_t kOverBudgetColor = VulkanHud::Color(240, 200, 48);
+constexpr uint32_t kOverGraphColor = VulkanHud::Color(240, 64, 48);
+
+constexpr uint32_t kVerticesPerQuad = 6;
+
+struct PushConstants {
+  float inverse_target_size[2];
+};
+
+[[nodiscard]] VkRenderPass CreateRenderPass(const VulkanDevice& device, VkFormat format) {
+  // The HUD is drawn over the target's contents.
+  VkAttachmentDescription attachment = {
+    .flags = 0,
+    .format = format,
+    .samples = VK_SAMPLE_COUNT_1_BIT,
+    .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
+    .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+    .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+    .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+    .initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+    .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+  };
+  VkAttachmentReference color_reference = {
+    .attachment = 0,
+    .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+  };
+  VkSubpassDescription subpass = {
+    .flags = 0,
+    .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+    .inputAttachmentCount = 0,
+    .pInputAttachments = nullptr,
+    .colorAttachmentCount = 1,
+    .pColorAttachments = &color_reference,
+    .pResolveAttachments = nullptr,
+    .pDepthStencilAttachment = nullptr,
+    .preserveAttachmentCount = 0,
+    .pPreserveAttachments = nullptr,
+  };
+
+  // Draw() callers synchronize with barriers, so the render pass doesn't
+  // need external dependencies.
+  VkRenderPassCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .attachmentCount = 1,
+    .pAttachments = &attachment,
+    .subpassCount = 1,
+    .pSubpasses = &subpass,
+    .dependencyCount = 0,
+    .pDependencies = nullptr,
+  };
+
+  VkRenderPass render_pass = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateRenderPass(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &render_pass);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateRenderPass() failed" << std::endl;
+    std::abort();
+  }
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_RENDER_PASS, render_pass, "HUD render pass");
+  return render_pass;
+}
+
+[[nodiscard]] VkPipelineLayout CreatePipelineLayout(const VulkanDevice& device) {
+  VkPushConstantRange push_constant_range = {
+    .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+    .offset = 0,
+    .size = sizeof(PushConstants),
+  };
+
+  VkPipelineLayoutCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .setLayoutCount = 0,
+    .pSetLayouts = nullptr,
+    .pushConstantRangeCount = 1,
+    .pPushConstantRanges = &push_constant_range,
+  };
+
+  VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreatePipelineLayout(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &pipeline_layout);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreatePipelineLayout() failed" << std::endl;
+    std::abort();
+  }
+  return pipeline_layout;
+}
+
+[[nodiscard]] VkPipeline CreatePipeline(const VulkanDevice& device, VkRenderPass render_pass,
+                                        VkPipelineLayout pipeline_layout,
+                                        uint32_t vertex_stride, uint32_t position_offset,
+                                        uint32_t glyph_coords_offset, uint32_t glyph_offset,
+                                        uint32_t color_offset) {
+  // The shader modules are only needed while the pipeline is created.
+  VulkanShaderModule vertex_shader(device, ReadSpirvFile("hud_vert.spv"));
+  VulkanShaderModule fragment_shader(device, ReadSpirvFile("hud_frag.spv"));
+
+  VkPipelineShaderStageCreateInfo stages[] = {
+    {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage = VK_SHADER_STAGE_VERTEX_BIT,
+      .module = vertex_shader.VulkanHandle(),
+      .pName = "main",
+      .pSpecializationInfo = nullptr,
+    },
+    {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+      .module = fragment_shader.VulkanHandle(),
+      .pName = "main",
+      .pSpecializationInfo = nullptr,
+    },
+  };
+
+  VkVertexInputBindingDescription binding = {
+    .binding = 0,
+    .stride = vertex_stride,
+    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+  };
+  VkVertexInputAttributeDescription attributes[] = {
+    {
+      .location = 0,
+      .binding = 0,
+      .format = VK_FORMAT_R32G32_SFLOAT,
+      .offset = position_offset,
+    },
+    {
+      .location = 1,
+      .binding = 0,
+      .format = VK_FORMAT_R32G32_SFLOAT,
+      .offset = glyph_coords_offset,
+    },
+    {
+      .location = 2,
+      .binding = 0,
+      .format = VK_FORMAT_R32_UINT,
+      .offset = glyph_offset,
+    },
+    {
+      .location = 3,
+      .binding = 0,
+      .format = VK_FORMAT_R8G8B8A8_UNORM,
+      .offset = color_offset,
+    },
+  };
+  VkPipelineVertexInputStateCreateInfo vertex_input = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .vertexBindingDescriptionCount = 1,
+    .pVertexBindingDescriptions = &binding,
+    .vertexAttributeDescriptionCount = static_cast<uint32_t>(std::size(attributes)),
+    .pVertexAttributeDescriptions = attributes,
+  };
+  VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+    .primitiveRestartEnable = VK_FALSE,
+  };
+  VkPipelineViewportStateCreateInfo viewport = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .viewportCount = 1,
+    .pViewports = nullptr,
+    .scissorCount = 1,
+    .pScissors = nullptr,
+  };
+  VkPipelineRasterizationStateCreateInfo rasterization = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .depthClampEnable = VK_FALSE,
+    .rasterizerDiscardEnable = VK_FALSE,
+    .polygonMode = VK_POLYGON_MODE_FILL,
+    .cullMode = VK_CULL_MODE_NONE,
+    .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+    .depthBiasEnable = VK_FALSE,
+    .depthBiasConstantFactor = 0.0f,
+    .depthBiasClamp = 0.0f,
+    .depthBiasSlopeFactor = 0.0f,
+    .lineWidth = 1.0f,
+  };
+  VkPipelineMultisampleStateCreateInfo multisample = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+    .sampleShadingEnable = VK_FALSE,
+    .minSampleShading = 1.0f,
+    .pSampleMask = nullptr,
+    .alphaToCoverageEnable = VK_FALSE,
+    .alphaToOneEnable = VK_FALSE,
+  };
+  VkPipelineColorBlendAttachmentState color_blend_attachment = {
+    .blendEnable = VK_TRUE,
+    .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+    .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+    .colorBlendOp = VK_BLEND_OP_ADD,
+    .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+    .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+    .alphaBlendOp = VK_BLEND_OP_ADD,
+    .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                      VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+  };
+  VkPipelineColorBlendStateCreateInfo color_blend = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .logicOpEnable = VK_FALSE,
+    .logicOp = VK_LOGIC_OP_COPY,
+    .attachmentCount = 1,
+    .pAttachments = &color_blend_attachment,
+    .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f},
+  };
+  const VkDynamicState dynamic_states[] = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+  };
+  VkPipelineDynamicStateCreateInfo dynamic = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .dynamicStateCount = static_cast<uint32_t>(std::size(dynamic_states)),
+    .pDynamicStates = dynamic_states,
+  };
+
+  VkGraphicsPipelineCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .stageCount = static_cast<uint32_t>(std::size(stages)),
+    .pStages = stages,
+    .pVertexInputState = &vertex_input,
+    .pInputAssemblyState = &input_assembly,
+    .pTessellationState = nullptr,
+    .pViewportState = &viewport,
+    .pRasterizationState = &rasterization,
+    .pMultisampleState = &multisample,
+    .pDepthStencilState = nullptr,
+    .pColorBlendState = &color_blend,
+    .pDynamicState = &dynamic,
+    .layout = pipeline_layout,
+    .renderPass = render_pass,
+    .subpass = 0,
+    .basePipelineHandle = VK_NULL_HANDLE,
+    .basePipelineIndex = -1,
+  };
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateGraphicsPipelines(
+      device.VulkanHandle(), /*pipelineCache=*/VK_NULL_HANDLE, 1, &create_info,
+      /*pAllocator=*/nullptr, &pipeline);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateGraphicsPipelines() failed" << std::endl;
+    std::abort();
+  }
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE, pipeline, "HUD pipeline");
+  return pipeline;
+}
+
+// Maps a character to its glyph. Characters outside the font become '?'.
+[[nodiscard]] uint32_t GlyphFor(char c) {
+  if (c >= 'a' && c <= 'z')
+    c = static_cast<char>(c - 'a' + 'A');
+  if (c < kFirstGlyph || c > kLastGlyph)
+    c = '?';
+  return static_cast<uint32_t>(c - kFirstGlyph);
+}
+
+}  // namespace
+
+VulkanHud::VulkanHud(const VulkanDevice& device, VkFormat target_format,
+                     uint32_t frames_in_flight, uint32_t max_quads)
+    : device_(device),
+      frames_in_flight_(frames_in_flight),
+      max_vertices_per_frame_(max_quads * kVerticesPerQuad),
+      render_pass_(CreateRenderPass(device, target_format)),
+      pipeline_layout_(CreatePipelineLayout(device)),
+      pipeline_(CreatePipeline(device, render_pass_, pipeline_layout_, sizeof(Vertex),
+                               offsetof(Vertex, position), offsetof(Vertex, glyph_coords),
+                               offsetof(Vertex, glyph), offsetof(Vertex, color))),
+      vertex_buffer_(device, VkDeviceSize{sizeof(Vertex)} * max_vertices_per_frame_ *
+                                 frames_in_flight,
+                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+  assert(frames_in_flight > 0);
+  // The background panel, the frame time bars and the budget line always fit.
+  assert(max_quads > kFrameTimeCount + 2);
+
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, vertex_buffer_.VulkanHandle(),
+                    "HUD vertices");
+}
+
+VulkanHud::~VulkanHud() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  for (const auto& view_and_framebuffer : framebuffers_)
+    functions.vkDestroyFramebuffer(device, view_and_framebuffer.second, /*pAllocator=*/nullptr);
+  functions.vkDestroyPipeline(device, pipeline_, /*pAllocator=*/nullptr);
+  functions.vkDestroyPipelineLayout(device, pipeline_layout_, /*pAllocator=*/nullptr);
+  functions.vkDestroyRenderPass(device, render_pass_, /*pAllocator=*/nullptr);
+}
+
+void VulkanHud::RecordFrameTime(double milliseconds) {
+  frame_times_[next_frame_time_] = static_cast<float>(milliseconds);
+  next_frame_time_ = (next_frame_time_ + 1) % kFrameTimeCount;
+}
+
+void VulkanHud::BeginFrame(uint64_t frame_number) {
+  uint32_t slot = static_cast<uint32_t>(frame_number % frames_in_flight_);
+  frame_first_vertex_ = slot * max_vertices_per_frame_;
+  frame_vertices_ = static_cast<Vertex*>(vertex_buffer_.MappedData()) + frame_first_vertex_;
+
+  // The background panel's quad is written by FinishFrame(), once its size
+  // is known. It comes first, so it's drawn under everything else.
+  frame_vertex_count_ = kVerticesPerQuad;
+  line_count_ = 0;
+  longest_line_ = 0;
+  frame_finished_ = false;
+}
+
+void VulkanHud::AddLine(std::string_view text, uint32_t color) {
+  assert(frame_vertices_ != nullptr);
+  assert(!frame_finished_);
+
+  float left = kMargin + kPadding;
+  float top = kMargin + kPadding + kGraphHeight + kPadding + line_count_ * kLineAdvance;
+  ++line_count_;
+  longest_line_ = std::max(longest_line_, text.size());
+
+  // Quads are reserved for the frame time graph.
+  uint32_t max_text_vertices = max_vertices_per_frame_ - (kFrameTimeCount + 1) * kVerticesPerQuad;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == ' ')
+      continue;
+    if (frame_vertex_count_ + kVerticesPerQuad > max_text_vertices)
+      return;
+    AddQuad(left + i * kGlyphAdvance, top, kGlyphWidth * kFontScale, kGlyphHeight * kFontScale,
+            GlyphFor(text[i]), color);
+  }
+}
+
+void VulkanHud::Draw(VkCommandBuffer command_buffer, VkImageView target_view,
+                     VkExtent2D target_extent) {
+  assert(command_buffer != VK_NULL_HANDLE);
+  assert(frame_vertices_ != nullptr);
+
+  if (!frame_finished_)
+    FinishFrame();
+
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VULKAN_DEBUG_LABEL_SCOPE(device_, command_buffer, "HUD");
+
+  VkRenderPassBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+    .pNext = nullptr,
+    .renderPass = render_pass_,
+    .framebuffer = FramebufferFor(target_view, target_extent),
+    .renderArea = {.offset = {0, 0}, .extent = target_extent},
+    .clearValueCount = 0,
+    .pClearValues = nullptr,
+  };
+  functions.vkCmdBeginRenderPass(command_buffer, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+  VkViewport viewport = {
+    .x = 0.0f,
+    .y = 0.0f,
+    .width = static_cast<float>(target_extent.width),
+    .height = static_cast<float>(target_extent.height),
+    .minDepth = 0.0f,
+    .maxDepth = 1.0f,
+  };
+  VkRect2D scissor = {.offset = {0, 0}, .extent = target_extent};
+  PushConstants push_constants = {
+    .inverse_target_size = {1.0f / viewport.width, 1.0f / viewport.height},
+  };
+  VkBuffer vertex_buffer = vertex_buffer_.VulkanHandle();
+  VkDeviceSize vertex_buffer_offset = 0;
+
+  functions.vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+  functions.vkCmdSetViewport(command_buffer, /*firstViewport=*/0, 1, &viewport);
+  functions.vkCmdSetScissor(command_buffer, /*firstScissor=*/0, 1, &scissor);
+  functions.vkCmdPushConstants(command_buffer, pipeline_layout_, VK_SHADER_STAGE_VERTEX_BIT,
+                               /*offset=*/0, sizeof(push_constants), &push_constants);
+  functions.vkCmdBindVertexBuffers(command_buffer, /*firstBinding=*/0, 1, &vertex_buffer,
+                                   &vertex_buffer_offset);
+  functions.vkCmdDraw(command_buffer, frame_vertex_count_, /*instanceCount=*/1,
+                      frame_first_vertex_, /*firstInstance=*/0);
+
+  functions.vkCmdEndRenderPass(command_buffer);
+}
+
+void VulkanHud::AddQuad(float left, float top, float width, float height, uint32_t glyph,
+                        uint32_t color) {
+  assert(frame_vertex_count_ + kVerticesPerQuad <= max_vertices_per_frame_);
+
+  // Glyph coordinates span the glyph's font pixels.
+  float glyph_right = glyph == kSolidGlyph ? 0.0f : kGlyphWidth;
+  float glyph_bottom = glyph == kSolidGlyph ? 0.0f : kGlyphHeight;
+  const Vertex corners[4] = {
+    {{left, top}, {0.0f, 0.0f}, glyph, color},
+    {{left + width, top}, {glyph_right, 0.0f}, glyph, color},
+    {{left, top + height}, {0.0f, glyph_bottom}, glyph, color},
+    {{left + width, top + height}, {glyph_right, glyph_bottom}, glyph, color},
+  };
+
+  // The mapped memory may be write-combined, so it's written sequentially.
+  Vertex* vertices = frame_vertices_ + frame_vertex_count_;
+  vertices[0] = corners[0];
+  vertices[1] = corners[2];
+  vertices[2] = corners[1];
+  vertices[3] = corners[1];
+  vertices[4] = corners[2];
+  vertices[5] = corners[3];
+  frame_vertex_count_ += kVerticesPerQuad;
+}
+
+void VulkanHud::FinishFrame() {
+  float graph_left = kMargin + kPadding;
+  float graph_bottom = kMargin + kPadding + kGraphHeight;
+  float graph_width = kFrameTimeCount * kFrameTimeBarWidth;
+
+  // Bars go from the oldest sample on the left to the latest on the right.
+  for (size_t i = 0; i < kFrameTimeCount; ++i) {
+    float milliseconds = frame_times_[(next_frame_time_ + i) % kFrameTimeCount];
+    if (milliseconds <= 0)
+      continue;
+
+    uint32_t color = milliseconds <= kFrameBudgetMilliseconds ? kOnBudgetColor
+                     : milliseconds <= kGraphMaxMilliseconds  ? kOverBudgetColor
+                                                              : kOverGraphColor;
+    float height = std::min(milliseconds / kGraphMaxMilliseconds, 1.0f) * kGraphHeight;
+    AddQuad(graph_left + i * kFrameTimeBarWidth, graph_bottom - height, kFrameTimeBarWidth,
+            height, kSolidGlyph, color);
+  }
+  float budget_top =
+      graph_bottom - kFrameBudgetMilliseconds / kGraphMaxMilliseconds * kGraphHeight;
+  AddQuad(graph_left, budget_top, graph_width, 1, kSolidGlyph, kBudgetLineColor);
+
+  // Overwrites the quad reserved by BeginFrame().
+  float content_width = std::max(graph_width, longest_line_ * kGlyphAdvance);
+  float content_height = kGraphHeight + kPadding + line_count_ * kLineAdvance;
+  uint32_t vertex_count = frame_vertex_count_;
+  frame_vertex_count_ = 0;
+  AddQuad(kMargin, kMargin, content_width + 2 * kPadding, content_height + 2 * kPadding,
+          kSolidGlyph, kPanelColor);
+  frame_vertex_count_ = vertex_count;
+
+  frame_finished_ = true;
+}
+
+VkFramebuffer VulkanHud::FramebufferFor(VkImageView target_view, VkExtent2D target_extent) {
+  auto it = framebuffers_.find(target_view);
+  if (it != framebuffers_.end())
+    return it->second;
+
+  VkFramebufferCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .renderPass = render_pass_,
+    .attachmentCount = 1,
+    .pAttachments = &target_view,
+    .width = target_extent.width,
+    .height = target_extent.height,
+    .layers = 1,
+  };
+
+  VkFramebuffer framebuffer = VK_NULL_HANDLE;
+  VkResult result = device_.Functions().vkCreateFramebuffer(
+      device_.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &framebuffer);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateFramebuffer() failed" << std::endl;
+    std::abort();
+  }
+  VULKAN_DEBUG_NAME(device_, VK_OBJECT_TYPE_FRAMEBUFFER, framebuffer, "HUD framebuffer");
+  framebuffers_.emplace(target_view, framebuffer);
+  return framebuffer;
+}
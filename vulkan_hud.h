@@ -0,0 +1,116 @@
+#ifndef VULKAN_HUD_H_
+#define VULKAN_HUD_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+
+class VulkanDevice;
+
+// A heads-up display drawn over rendered images: a frame time graph, above
+// lines of text.
+//
+// Each frame's geometry is written into a region of one host-visible vertex
+// buffer, and drawn with a single draw call. Text uses a built-in 3x5 pixel
+// font that covers printable ASCII. Lowercase letters are drawn in uppercase,
+// so the font only needs 64 glyphs.
+class VulkanHud {
+ public:
+  // Colors are packed as VK_FORMAT_R8G8B8A8_UNORM.
+  [[nodiscard]] static constexpr uint32_t Color(uint8_t red, uint8_t green, uint8_t blue,
+                                                uint8_t alpha = 255) {
+    return uint32_t{red} | (uint32_t{green} << 8) | (uint32_t{blue} << 16) |
+           (uint32_t{alpha} << 24);
+  }
+  // Opaque white. Color() can't be called here, because the class isn't
+  // complete yet.
+  static constexpr uint32_t kTextColor = 0xffffffff;
+
+  // `device` must outlive this instance. Draws target images with
+  // `target_format`.
+  //
+  // `frames_in_flight` must match the number of frames the GPU may render
+  // concurrently. Each frame can have up to `max_quads` glyphs and bars.
+  explicit VulkanHud(const VulkanDevice& device, VkFormat target_format,
+                     uint32_t frames_in_flight, uint32_t max_quads = 4096);
+
+  VulkanHud(const VulkanHud&) = delete;
+  VulkanHud& operator=(const VulkanHud&) = delete;
+
+  // The GPU must be done drawing the HUD.
+  ~VulkanHud();
+
+  // Adds a sample to the frame time graph, which shows the latest samples.
+  void RecordFrameTime(double milliseconds);
+
+  // Starts building the HUD shown in a frame.
+  //
+  // The frame recorded `frames_in_flight` frames ago must be retired.
+  void BeginFrame(uint64_t frame_number);
+
+  // Adds a line of text under the previous line. Must be called between
+  // BeginFrame() and the first Draw() of the frame.
+  void AddLine(std::string_view text, uint32_t color = kTextColor);
+
+  // Draws the HUD built since the last BeginFrame() over `target_view`.
+  //
+  // Can be called for multiple targets in a frame. Records a render pass, so
+  // it must be called outside of render passes. The target must be in the
+  // VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL layout, and its writes must be
+  // available to the VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT stage. It
+  // stays in the same layout. `target_view` must outlive this instance.
+  void Draw(VkCommandBuffer command_buffer, VkImageView target_view, VkExtent2D target_extent);
+
+ private:
+  // Matches shaders/hud.vert.
+  struct Vertex {
+    float position[2];
+    float glyph_coords[2];
+    uint32_t glyph;
+    uint32_t color;
+  };
+
+  // Adds a quad that covers a rectangle of pixels. The frame must have room
+  // for it.
+  void AddQuad(float left, float top, float width, float height, uint32_t glyph,
+               uint32_t color);
+
+  // Writes the frame time graph, and the background panel sized to fit it
+  // and the text.
+  void FinishFrame();
+
+  [[nodiscard]] VkFramebuffer FramebufferFor(VkImageView target_view, VkExtent2D target_extent);
+
+  static constexpr size_t kFrameTimeCount = 128;
+
+  const VulkanDevice& device_;
+  const uint32_t frames_in_flight_;
+  const uint32_t max_vertices_per_frame_;
+  const VkRenderPass render_pass_;
+  const VkPipelineLayout pipeline_layout_;
+  const VkPipeline pipeline_;
+  const VulkanBuffer vertex_buffer_;
+
+  // Created the first time a target is drawn.
+  std::map<VkImageView, VkFramebuffer> framebuffers_;
+
+  // Ring buffer. `next_frame_time_` is the oldest sample.
+  std::array<float, kFrameTimeCount> frame_times_ = {};
+  size_t next_frame_time_ = 0;
+
+  // The frame being built. Points into `vertex_buffer_`.
+  Vertex* frame_vertices_ = nullptr;
+  uint32_t frame_first_vertex_ = 0;
+  uint32_t frame_vertex_count_ = 0;
+  uint32_t line_count_ = 0;
+  size_t longest_line_ = 0;
+  bool frame_finished_ = false;
+};
+
+#endif  // VULKAN_HUD_H_
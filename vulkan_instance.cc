@@ -0,0 +1,71 @@
+#include "vulkan_instance.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_config.h"
+#include "vulkan_dispatch.h"
+
+namespace {
+
+[[nodiscard]] VkInstance CreateInstance(
+    const VulkanConfig& vulkan_config, const char* application_name,
+    const VkDebugUtilsMessengerCreateInfoEXT* debug_messenger_info) {
+  VkApplicationInfo application_info = {
+    .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+    .pNext = nullptr,
+    .pApplicationName = application_name,
+    .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+    .pEngineName = "No engine",
+    .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+    .apiVersion = VK_API_VERSION_1_1,
+  };
+
+  const std::vector<const char*>& required_layers = vulkan_config.RequiredLayers();
+  const std::vector<const char*>& required_extensions =
+      vulkan_config.RequiredInstanceExtensions();
+
+  // The configuration's structure can't be modified to extend the chain.
+  const void* next = debug_messenger_info;
+  VkValidationFeaturesEXT validation_features;
+  if (vulkan_config.ValidationFeatures() != nullptr) {
+    validation_features = *vulkan_config.ValidationFeatures();
+    validation_features.pNext = next;
+    next = &validation_features;
+  }
+
+  VkInstanceCreateInfo instance_create_info = {
+    .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+    .pNext = next,
+    .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,  // For MoltenVK.
+    .pApplicationInfo = &application_info,
+    .enabledLayerCount = static_cast<uint32_t>(required_layers.size()),
+    .ppEnabledLayerNames = required_layers.data(),
+    .enabledExtensionCount = static_cast<uint32_t>(required_extensions.size()),
+    .ppEnabledExtensionNames = required_extensions.data(),
+  };
+
+  VkInstance instance = VK_NULL_HANDLE;
+  VkResult result = vkCreateInstance(&instance_create_info, /*pAllocator=*/nullptr, &instance);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateInstance() failed" << std::endl;
+    std::abort();
+  }
+  return instance;
+}
+
+}  // namespace
+
+VulkanInstance::VulkanInstance(const VulkanConfig& vulkan_config, const char* application_name,
+                               const VkDebugUtilsMessengerCreateInfoEXT* debug_messenger_info)
+    : instance_(CreateInstance(vulkan_config, application_name, debug_messenger_info)),
+      functions_(LoadVulkanInstanceFunctions(instance_)) {
+}
+
+VulkanInstance::~VulkanInstance() {
+  vkDestroyInstance(instance_, /*pAllocator=*/nullptr);
+}
@@ -0,0 +1,43 @@
+#ifndef VULKAN_INSTANCE_H_
+#define VULKAN_INSTANCE_H_
+
+#include <cassert>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_dispatch.h"
+
+class VulkanConfig;
+
+// Owns the application's VkInstance.
+class VulkanInstance {
+ public:
+  // Creates an instance with the layers and extensions required by `vulkan_config`,
+  // and the validation features it selects.
+  //
+  // If `debug_messenger_info` is not null, it is chained into the instance's
+  // creation info, so messages issued by vkCreateInstance() and
+  // vkDestroyInstance() are reported.
+  explicit VulkanInstance(const VulkanConfig& vulkan_config, const char* application_name,
+                          const VkDebugUtilsMessengerCreateInfoEXT* debug_messenger_info = nullptr);
+
+  VulkanInstance(const VulkanInstance&) = delete;
+  VulkanInstance& operator=(const VulkanInstance&) = delete;
+
+  // All objects created from this instance must be destroyed before it.
+  ~VulkanInstance();
+
+  [[nodiscard]] VkInstance VulkanHandle() const {
+    assert(instance_ != VK_NULL_HANDLE);
+    return instance_;
+  }
+
+  // Instance-level entry points that the loader does not export.
+  [[nodiscard]] const VulkanInstanceFunctions& Functions() const { return functions_; }
+
+ private:
+  const VkInstance instance_;
+  const VulkanInstanceFunctions functions_;
+};
+
+#endif  // VULKAN_INSTANCE_H_
@@ -0,0 +1,88 @@
+#include "vulkan_memory_budget.h"
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+namespace {
+
+// Without VK_EXT_memory_budget, this share of each heap is assumed to be
+// available to the process. The rest is left to other processes and to the
+// driver's internal allocations, which aren't tracked.
+constexpr double kUnreportedBudgetFraction = 0.8;
+
+[[nodiscard]] VulkanMemoryPressure PressureFor(VkDeviceSize usage, VkDeviceSize budget,
+                                               float high_pressure_fraction) {
+  if (usage > budget)
+    return VulkanMemoryPressure::kOverBudget;
+  if (static_cast<double>(usage) > static_cast<double>(budget) * high_pressure_fraction)
+    return VulkanMemoryPressure::kHigh;
+  return VulkanMemoryPressure::kNormal;
+}
+
+}  // namespace
+
+VulkanMemoryBudget::VulkanMemoryBudget(const VulkanDevice& device, float high_pressure_fraction)
+    : device_(device), high_pressure_fraction_(high_pressure_fraction),
+      reported_by_driver_(device.HasMemoryBudget()) {
+  assert(high_pressure_fraction > 0 && high_pressure_fraction <= 1);
+
+  const VkPhysicalDeviceMemoryProperties& memory_properties = device.MemoryProperties();
+  heaps_.resize(memory_properties.memoryHeapCount);
+  for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+    const VkMemoryHeap& heap = memory_properties.memoryHeaps[i];
+    heaps_[i] = {
+      .size = heap.size,
+      .budget = static_cast<VkDeviceSize>(static_cast<double>(heap.size) *
+                                          kUnreportedBudgetFraction),
+      .usage = 0,
+      .allocated = 0,
+      .pressure = VulkanMemoryPressure::kNormal,
+      .device_local = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0,
+    };
+  }
+  Update();
+}
+
+VulkanMemoryBudget::~VulkanMemoryBudget() = default;
+
+void VulkanMemoryBudget::AddPressureCallback(PressureCallback callback) {
+  assert(callback);
+  callbacks_.push_back(std::move(callback));
+}
+
+void VulkanMemoryBudget::Update() {
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+  budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+  if (reported_by_driver_) {
+    VkPhysicalDeviceMemoryProperties2 memory_properties{};
+    memory_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memory_properties.pNext = &budget_properties;
+    vkGetPhysicalDeviceMemoryProperties2(device_.PhysicalDeviceVulkanHandle(),
+                                         &memory_properties);
+  }
+
+  for (uint32_t i = 0; i < static_cast<uint32_t>(heaps_.size()); ++i) {
+    VulkanHeapBudget& heap = heaps_[i];
+    heap.allocated = device_.AllocatedBytes(i);
+    if (reported_by_driver_) {
+      heap.budget = budget_properties.heapBudget[i];
+      heap.usage = budget_properties.heapUsage[i];
+    } else {
+      heap.usage = heap.allocated;
+    }
+
+    VulkanMemoryPressure previous_pressure = heap.pressure;
+    heap.pressure = PressureFor(heap.usage, heap.budget, high_pressure_fraction_);
+    if (heap.pressure == VulkanMemoryPressure::kNormal &&
+        previous_pressure == VulkanMemoryPressure::kNormal) {
+      continue;
+    }
+    for (const PressureCallback& callback : callbacks_)
+      callback(i, heap);
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef VULKAN_MEMORY_BUDGET_H_
+#define VULKAN_MEMORY_BUDGET_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+
+// How close a memory heap is to its budget.
+enum class VulkanMemoryPressure {
+  kNormal,
+
+  // Usage is above the warning threshold. New allocations should be limited.
+  kHigh,
+
+  // Usage exceeds the budget. The driver may start paging memory out of the
+  // heap, which drastically slows down rendering.
+  kOverBudget,
+};
+
+// Usage of one memory heap, as of the last VulkanMemoryBudget::Update().
+struct VulkanHeapBudget {
+  // The heap's size, from VkMemoryHeap.
+  VkDeviceSize size;
+
+  // How much of the heap the process can use without degrading performance.
+  // This changes as other processes allocate and free memory.
+  VkDeviceSize budget;
+
+  // Memory used by the process, including the driver's internal allocations.
+  VkDeviceSize usage;
+
+  // Memory allocated by VulkanDevice::AllocateMemory().
+  VkDeviceSize allocated;
+
+  VulkanMemoryPressure pressure;
+
+  // True for heaps with VK_MEMORY_HEAP_DEVICE_LOCAL_BIT.
+  bool device_local;
+};
+
+// Tracks the device's memory usage against the heaps' budgets.
+//
+// On devices with VK_EXT_memory_budget, the driver reports the budget and the
+// usage of each heap. The budget accounts for other processes, so it shrinks
+// on machines shared with other GPU applications. Other devices use a fixed
+// fraction of each heap's size as its budget, and the memory allocated by
+// VulkanDevice as its usage.
+//
+// Callbacks give systems that can release memory, such as texture streaming,
+// a chance to evict before the driver starts paging.
+class VulkanMemoryBudget {
+ public:
+  // Called by Update() for each heap whose pressure is not kNormal, and once
+  // for each heap whose pressure returns to kNormal.
+  using PressureCallback =
+      std::function<void(uint32_t heap_index, const VulkanHeapBudget& heap_budget)>;
+
+  // `device` must outlive this instance. Heaps are under high pressure when
+  // their usage exceeds `high_pressure_fraction` of their budget.
+  explicit VulkanMemoryBudget(const VulkanDevice& device, float high_pressure_fraction = 0.9f);
+
+  VulkanMemoryBudget(const VulkanMemoryBudget&) = delete;
+  VulkanMemoryBudget& operator=(const VulkanMemoryBudget&) = delete;
+
+  ~VulkanMemoryBudget();
+
+  // Callbacks run on the thread that calls Update().
+  void AddPressureCallback(PressureCallback callback);
+
+  // Queries the heaps' usage and budgets, and calls the pressure callbacks.
+  //
+  // Querying is cheap enough to do once per frame.
+  void Update();
+
+  // True if the budgets come from VK_EXT_memory_budget.
+  [[nodiscard]] bool IsReportedByDriver() const { return reported_by_driver_; }
+
+  [[nodiscard]] size_t HeapCount() const { return heaps_.size(); }
+  [[nodiscard]] const VulkanHeapBudget& Heap(uint32_t heap_index) const {
+    assert(heap_index < heaps_.size());
+    return heaps_[heap_index];
+  }
+
+ private:
+  const VulkanDevice& device_;
+  const float high_pressure_fraction_;
+  const bool reported_by_driver_;
+
+  std::vector<VulkanHeapBudget> heaps_;
+  std::vector<PressureCallback> callbacks_;
+};
+
+#endif  // VULKAN_MEMORY_BUDGET_H_
@@ -0,0 +1,235 @@
+#include "vulkan_mesh.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <vulkan/vulkan_core.h>
+
+#include "mesh_data.h"
+#include "mesh_quantization.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_pool.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+
+namespace {
+
+// Describes where one of the vertex formats stores mesh.vert's inputs.
+struct VertexFormatLayout {
+  uint32_t stride;
+
+  // Indexed by shader input location: position, normal, texture coordinates.
+  std::array<VkFormat, 3> attribute_formats;
+  std::array<uint32_t, 3> attribute_offsets;
+
+  // Selects how mesh.vert decodes the normal attribute.
+  VkBool32 octahedral_normals;
+};
+
+[[nodiscard]] VertexFormatLayout GetVertexFormatLayout(VulkanMesh::VertexFormat vertex_format) {
+  switch (vertex_format) {
+    case VulkanMesh::VertexFormat::kFloat:
+      return {
+        .stride = sizeof(MeshVertex),
+        .attribute_formats = {VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+                              VK_FORMAT_R32G32_SFLOAT},
+        .attribute_offsets = {offsetof(MeshVertex, position), offsetof(MeshVertex, normal),
+                              offsetof(MeshVertex, uv)},
+        .octahedral_normals = VK_FALSE,
+      };
+    case VulkanMesh::VertexFormat::kQuantized:
+      // Three-component 16-bit formats are not required to support vertex
+      // fetches, so positions use a four-component format.
+      return {
+        .stride = sizeof(QuantizedMeshVertex),
+        .attribute_formats = {VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16_SNORM,
+                              VK_FORMAT_R16G16_SFLOAT},
+        .attribute_offsets = {offsetof(QuantizedMeshVertex, position),
+                              offsetof(QuantizedMeshVertex, normal),
+                              offsetof(QuantizedMeshVertex, uv)},
+        .octahedral_normals = VK_TRUE,
+      };
+  }
+  std::cerr << "Invalid vertex format" << std::endl;
+  std::abort();
+}
+
+[[nodiscard]] VkDeviceSize VertexDataSize(const MeshData& mesh,
+                                          VulkanMesh::VertexFormat vertex_format) {
+  return VkDeviceSize{GetVertexFormatLayout(vertex_format).stride} * mesh.vertices.size();
+}
+
+[[nodiscard]] VkDeviceSize IndexDataSize(const MeshData& mesh) {
+  return sizeof(uint32_t) * mesh.indices.size();
+}
+
+[[nodiscard]] MeshBounds GetPositionBounds(const MeshData& mesh,
+                                           VulkanMesh::VertexFormat vertex_format) {
+  if (vertex_format == VulkanMesh::VertexFormat::kQuantized)
+    return ComputeMeshBounds(mesh);
+  return {.min = {0.0f, 0.0f, 0.0f}, .extent = {1.0f, 1.0f, 1.0f}};
+}
+
+}  // namespace
+
+VulkanMesh::PipelineInput::PipelineInput(VertexFormat vertex_format) {
+  VertexFormatLayout layout = GetVertexFormatLayout(vertex_format);
+
+  binding_ = {
+    .binding = 0,
+    .stride = layout.stride,
+    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+  };
+  for (uint32_t location = 0; location < attributes_.size(); ++location) {
+    attributes_[location] = {
+      .location = location,
+      .binding = 0,
+      .format = layout.attribute_formats[location],
+      .offset = layout.attribute_offsets[location],
+    };
+  }
+  vertex_input_state_ = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .vertexBindingDescriptionCount = 1,
+    .pVertexBindingDescriptions = &binding_,
+    .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes_.size()),
+    .pVertexAttributeDescriptions = attributes_.data(),
+  };
+
+  specialization_data_.octahedral_normals = layout.octahedral_normals;
+  specialization_entries_[0] = {
+    .constantID = 0,
+    .offset = offsetof(SpecializationData, octahedral_normals),
+    .size = sizeof(VkBool32),
+  };
+  specialization_info_ = {
+    .mapEntryCount = static_cast<uint32_t>(specialization_entries_.size()),
+    .pMapEntries = specialization_entries_.data(),
+    .dataSize = sizeof(specialization_data_),
+    .pData = &specialization_data_,
+  };
+}
+
+// static
+bool VulkanMesh::SupportsVertexFormat(VkPhysicalDevice physical_device,
+                                      VertexFormat vertex_format) {
+  assert(physical_device != VK_NULL_HANDLE);
+
+  for (VkFormat format : GetVertexFormatLayout(vertex_format).attribute_formats) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+    if (!(properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT))
+      return false;
+  }
+  return true;
+}
+
+// static
+VulkanMesh::VertexFormat VulkanMesh::PreferredVertexFormat(VkPhysicalDevice physical_device) {
+  if (SupportsVertexFormat(physical_device, VertexFormat::kQuantized))
+    return VertexFormat::kQuantized;
+  return VertexFormat::kFloat;
+}
+
+VulkanMesh::VulkanMesh(const VulkanDevice& device, VulkanCommandPool& command_pool,
+                       VkQueue queue, const MeshData& mesh, VertexFormat vertex_format)
+    : device_(device),
+      vertex_format_(vertex_format),
+      index_count_(static_cast<uint32_t>(mesh.indices.size())),
+      position_bounds_(GetPositionBounds(mesh, vertex_format)),
+      vertex_buffer_(device, VertexDataSize(mesh, vertex_format),
+                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+      index_buffer_(device, IndexDataSize(mesh),
+                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+  assert(!mesh.vertices.empty());
+  assert(!mesh.indices.empty());
+  assert(mesh.indices.size() % 3 == 0);
+
+  if (!SupportsVertexFormat(device.PhysicalDeviceVulkanHandle(), vertex_format)) {
+    std::cerr << "Device can't fetch the mesh vertex format from vertex buffers" << std::endl;
+    std::abort();
+  }
+
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, vertex_buffer_.VulkanHandle(),
+                    "Mesh vertices");
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, index_buffer_.VulkanHandle(), "Mesh indices");
+
+  // Vertices and indices share one staging buffer, and one submission.
+  VkDeviceSize vertex_data_size = VertexDataSize(mesh, vertex_format);
+  VkDeviceSize index_data_size = IndexDataSize(mesh);
+  VulkanBuffer staging_buffer(device, vertex_data_size + index_data_size,
+                              VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  auto* staging_data = static_cast<uint8_t*>(staging_buffer.MappedData());
+  if (vertex_format == VertexFormat::kQuantized) {
+    QuantizedMeshData quantized_mesh = QuantizeMesh(mesh);
+    std::memcpy(staging_data, quantized_mesh.vertices.data(), vertex_data_size);
+  } else {
+    std::memcpy(staging_data, mesh.vertices.data(), vertex_data_size);
+  }
+  std::memcpy(staging_data + vertex_data_size, mesh.indices.data(), index_data_size);
+  staging_buffer.FlushMappedData();
+
+  const VulkanDeviceFunctions& functions = device.Functions();
+  command_pool.SubmitAndWait(queue, [&](VkCommandBuffer command_buffer) {
+    VkBufferCopy vertex_copy = {
+      .srcOffset = 0,
+      .dstOffset = 0,
+      .size = vertex_data_size,
+    };
+    functions.vkCmdCopyBuffer(command_buffer, staging_buffer.VulkanHandle(),
+                              vertex_buffer_.VulkanHandle(), 1, &vertex_copy);
+
+    VkBufferCopy index_copy = {
+      .srcOffset = vertex_data_size,
+      .dstOffset = 0,
+      .size = index_data_size,
+    };
+    functions.vkCmdCopyBuffer(command_buffer, staging_buffer.VulkanHandle(),
+                              index_buffer_.VulkanHandle(), 1, &index_copy);
+
+    // Waiting on the submission's fence only makes the copies visible to the
+    // host. Later submissions that read the buffers need this barrier.
+    VkMemoryBarrier barrier = {
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+    };
+    functions.vkCmdPipelineBarrier(
+        command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        /*dependencyFlags=*/0, 1, &barrier, 0, nullptr, 0, nullptr);
+  });
+}
+
+VulkanMesh::~VulkanMesh() = default;
+
+void VulkanMesh::SetPositionTransform(PushConstants& push_constants) const {
+  for (int axis = 0; axis < 3; ++axis) {
+    push_constants.position_offset[axis] = position_bounds_.min[axis];
+    push_constants.position_scale[axis] = position_bounds_.extent[axis];
+  }
+  push_constants.position_offset[3] = 0.0f;
+  push_constants.position_scale[3] = 1.0f;
+}
+
+void VulkanMesh::Bind(VkCommandBuffer command_buffer) const {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+
+  VkBuffer vertex_buffer = vertex_buffer_.VulkanHandle();
+  VkDeviceSize offset = 0;
+  functions.vkCmdBindVertexBuffers(command_buffer, /*firstBinding=*/0, 1, &vertex_buffer,
+                                   &offset);
+  functions.vkCmdBindIndexBuffer(command_buffer, index_buffer_.VulkanHandle(), /*offset=*/0,
+                                 VK_INDEX_TYPE_UINT32);
+}
@@ -0,0 +1,109 @@
+#ifndef VULKAN_MESH_H_
+#define VULKAN_MESH_H_
+
+#include <array>
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+#include "mesh_data.h"
+#include "vulkan_buffer.h"
+
+class VulkanCommandPool;
+class VulkanDevice;
+
+// Vertex and index buffers for a mesh, in device-local memory.
+class VulkanMesh {
+ public:
+  // Layouts for the vertices in the vertex buffer.
+  enum class VertexFormat {
+    kFloat,      // MeshVertex, 32 bytes per vertex.
+    kQuantized,  // QuantizedMeshVertex, 16 bytes per vertex.
+  };
+
+  // Push constants consumed by shaders/mesh.vert.
+  struct PushConstants {
+    float model_view_projection[16];  // Column-major.
+
+    // Model-space positions are position_offset + position_scale * position,
+    // where position is the vertex buffer value. The fourth components are
+    // unused.
+    float position_offset[4];
+    float position_scale[4];
+  };
+
+  // Vertex input state and specialization constants for pipelines that draw
+  // meshes with shaders/mesh.vert.
+  //
+  // The Vulkan structures point into this instance, so it can't be moved.
+  class PipelineInput {
+   public:
+    explicit PipelineInput(VertexFormat vertex_format);
+
+    PipelineInput(const PipelineInput&) = delete;
+    PipelineInput& operator=(const PipelineInput&) = delete;
+
+    [[nodiscard]] const VkPipelineVertexInputStateCreateInfo& VertexInputState() const {
+      return vertex_input_state_;
+    }
+    [[nodiscard]] const VkSpecializationInfo& VertexShaderSpecialization() const {
+      return specialization_info_;
+    }
+
+   private:
+    VkVertexInputBindingDescription binding_;
+    std::array<VkVertexInputAttributeDescription, 3> attributes_;
+    VkPipelineVertexInputStateCreateInfo vertex_input_state_;
+
+    // Values for mesh.vert's specialization constants, in constant_id order.
+    struct SpecializationData {
+      VkBool32 octahedral_normals;
+    } specialization_data_;
+    std::array<VkSpecializationMapEntry, 1> specialization_entries_;
+    VkSpecializationInfo specialization_info_;
+  };
+
+  // True if the device can fetch all the attributes in `vertex_format` from
+  // vertex buffers.
+  [[nodiscard]] static bool SupportsVertexFormat(VkPhysicalDevice physical_device,
+                                                 VertexFormat vertex_format);
+
+  // The most compact format supported by the device.
+  [[nodiscard]] static VertexFormat PreferredVertexFormat(VkPhysicalDevice physical_device);
+
+  // Uploads `mesh` via a staging buffer, and blocks until the upload completes.
+  //
+  // `device` must outlive this instance. `queue` must belong to
+  // `command_pool`'s queue family. The mesh should have been processed by
+  // OptimizeMesh(). The vertices are converted to `vertex_format`, which must
+  // be supported by the device.
+  explicit VulkanMesh(const VulkanDevice& device, VulkanCommandPool& command_pool, VkQueue queue,
+                      const MeshData& mesh, VertexFormat vertex_format = VertexFormat::kFloat);
+
+  VulkanMesh(const VulkanMesh&) = delete;
+  VulkanMesh& operator=(const VulkanMesh&) = delete;
+
+  ~VulkanMesh();
+
+  [[nodiscard]] uint32_t IndexCount() const { return index_count_; }
+  [[nodiscard]] VertexFormat Format() const { return vertex_format_; }
+
+  // Sets the members of `push_constants` that depend on the vertex format.
+  void SetPositionTransform(PushConstants& push_constants) const;
+
+  // Binds the mesh's buffers to vertex input binding 0 and the index input.
+  void Bind(VkCommandBuffer command_buffer) const;
+
+ private:
+  const VulkanDevice& device_;
+  const VertexFormat vertex_format_;
+  const uint32_t index_count_;
+
+  // Maps vertex buffer positions to model space. The identity for kFloat.
+  const MeshBounds position_bounds_;
+
+  const VulkanBuffer vertex_buffer_;
+  const VulkanBuffer index_buffer_;
+};
+
+#endif  // VULKAN_MESH_H_
@@ -0,0 +1,232 @@
+#include "vulkan_mip_generator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+#include "vulkan_shader_module.h"
+
+namespace {
+
+// Must match shaders/downsample_mips.comp.
+constexpr uint32_t kTileSize = 64;
+constexpr uint32_t kLevelsPerPass = 6;
+constexpr uint32_t kCounterBinding = VulkanMipGenerator::kMaxMipLevelCount;
+
+// The workgroups' pass and the last workgroup's pass each write 6 levels.
+static_assert(kLevelsPerPass * 2 + 1 == VulkanMipGenerator::kMaxMipLevelCount);
+
+constexpr VkSubgroupFeatureFlags kRequiredSubgroupOperations =
+    VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_SHUFFLE_BIT;
+
+// Indexed by VulkanMipGenerator::Reduction.
+constexpr int32_t kReductionValues[] = {0, 1, 2};
+constexpr VkSpecializationMapEntry kReductionEntry = {
+  .constantID = 0,
+  .offset = 0,
+  .size = sizeof(int32_t),
+};
+constexpr VkSpecializationInfo kReductionSpecializations[] = {
+  {
+    .mapEntryCount = 1,
+    .pMapEntries = &kReductionEntry,
+    .dataSize = sizeof(int32_t),
+    .pData = &kReductionValues[0],
+  },
+  {
+    .mapEntryCount = 1,
+    .pMapEntries = &kReductionEntry,
+    .dataSize = sizeof(int32_t),
+    .pData = &kReductionValues[1],
+  },
+  {
+    .mapEntryCount = 1,
+    .pMapEntries = &kReductionEntry,
+    .dataSize = sizeof(int32_t),
+    .pData = &kReductionValues[2],
+  },
+};
+
+struct PushConstants {
+  uint32_t mip_count;
+  uint32_t tile_count;
+};
+
+[[nodiscard]] constexpr uint32_t DivideRoundingUp(uint32_t dividend, uint32_t divisor) {
+  return (dividend + divisor - 1) / divisor;
+}
+
+[[nodiscard]] bool SupportsSubgroupShaders(const VulkanDevice& device) {
+  const VkPhysicalDeviceSubgroupProperties& properties = device.SubgroupProperties();
+  return (properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+         (properties.supportedOperations & kRequiredSubgroupOperations) ==
+             kRequiredSubgroupOperations;
+}
+
+// The shader is built once per image format qualifier.
+[[nodiscard]] std::vector<uint32_t> ReadShader(VkFormat format, bool use_subgroups) {
+  std::string path = "downsample_mips_";
+  switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+      path += "rgba8";
+      break;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+      path += "rgba16f";
+      break;
+    case VK_FORMAT_R32_SFLOAT:
+      path += "r32f";
+      break;
+    default:
+      std::cerr << "Unsupported mip generation format: " << format << std::endl;
+      std::abort();
+  }
+  path += use_subgroups ? "_subgroup.spv" : ".spv";
+  return ReadSpirvFile(path);
+}
+
+// One image per level, followed by the counter.
+[[nodiscard]] std::vector<VkDescriptorType> DescriptorTypes() {
+  std::vector<VkDescriptorType> bindings(VulkanMipGenerator::kMaxMipLevelCount,
+                                         VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+  bindings.push_back(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+  return bindings;
+}
+
+[[nodiscard]] std::vector<VkImageView> CreateLevelViews(const VulkanDevice& device,
+                                                        VkImage image, VkFormat format,
+                                                        uint32_t mip_level_count) {
+  std::vector<VkImageView> level_views;
+  level_views.reserve(mip_level_count);
+  for (uint32_t level = 0; level < mip_level_count; ++level) {
+    VkImageViewCreateInfo create_info = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .image = image,
+      .viewType = VK_IMAGE_VIEW_TYPE_2D,
+      .format = format,
+      .components = {
+        .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+        .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+        .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+        .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+      },
+      .subresourceRange = {
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = level,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+      },
+    };
+
+    VkImageView image_view = VK_NULL_HANDLE;
+    VkResult result = device.Functions().vkCreateImageView(
+        device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &image_view);
+    if (result != VK_SUCCESS) {
+      std::cerr << "vkCreateImageView() failed" << std::endl;
+      std::abort();
+    }
+    level_views.push_back(image_view);
+  }
+  return level_views;
+}
+
+}  // namespace
+
+uint32_t VulkanMipGenerator::FullMipLevelCount(VkExtent2D extent) {
+  uint32_t level_count = 1;
+  for (uint32_t size = std::max(extent.width, extent.height); size > 1; size /= 2)
+    ++level_count;
+  return level_count;
+}
+
+VulkanMipGenerator::VulkanMipGenerator(const VulkanDevice& device, VkImage image,
+                                       VkFormat format, VkExtent2D extent,
+                                       uint32_t mip_level_count, Reduction reduction)
+    : device_(device),
+      extent_(extent),
+      mip_level_count_(mip_level_count),
+      uses_subgroups_(SupportsSubgroupShaders(device)),
+      level_views_(CreateLevelViews(device, image, format, mip_level_count)),
+      counter_buffer_(device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+      pipeline_(device, ReadShader(format, uses_subgroups_), DescriptorTypes(),
+                sizeof(PushConstants), /*max_descriptor_sets=*/1,
+                &kReductionSpecializations[static_cast<int>(reduction)]),
+      descriptor_set_(pipeline_.AllocateDescriptorSet()) {
+  assert(image != VK_NULL_HANDLE);
+  assert(mip_level_count > 0 && mip_level_count <= kMaxMipLevelCount);
+  assert(mip_level_count <= FullMipLevelCount(extent));
+  // The last workgroup reduces up to a 64x64 tile of results.
+  assert(extent.width <= kTileSize * kTileSize && extent.height <= kTileSize * kTileSize);
+  // Each texel reduces a 2x2 footprint, so odd levels drop their last row or
+  // column. Averages tolerate that, but depth pyramids must stay conservative.
+  assert(reduction == Reduction::kAverage ||
+         ((extent.width & (extent.width - 1)) == 0 && (extent.height & (extent.height - 1)) == 0));
+
+  // The shader resets the counter after each dispatch.
+  std::memset(counter_buffer_.MappedData(), 0, sizeof(uint32_t));
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, counter_buffer_.VulkanHandle(),
+                    "Mip generation counter");
+
+  // Every binding must be valid, so levels past the image's mip count point
+  // to its last level. The shader doesn't write them.
+  for (uint32_t level = 0; level < kMaxMipLevelCount; ++level) {
+    VkImageView level_view = level_views_[std::min(level, mip_level_count - 1)];
+    pipeline_.BindImage(descriptor_set_, /*binding=*/level, level_view, VK_IMAGE_LAYOUT_GENERAL);
+  }
+  pipeline_.BindBuffer(descriptor_set_, kCounterBinding, counter_buffer_.VulkanHandle());
+}
+
+VulkanMipGenerator::~VulkanMipGenerator() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  for (VkImageView level_view : level_views_)
+    functions.vkDestroyImageView(device, level_view, /*pAllocator=*/nullptr);
+}
+
+void VulkanMipGenerator::Record(VkCommandBuffer command_buffer) {
+  if (mip_level_count_ == 1)
+    return;
+
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VULKAN_DEBUG_LABEL_SCOPE(device_, command_buffer, "Mip generation");
+
+  // The previous dispatch's last workgroup must have reset the counter.
+  VkBufferMemoryBarrier counter_barrier = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .buffer = counter_buffer_.VulkanHandle(),
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 1, &counter_barrier, 0, nullptr);
+
+  uint32_t tile_columns = DivideRoundingUp(extent_.width, kTileSize);
+  uint32_t tile_rows = DivideRoundingUp(extent_.height, kTileSize);
+  PushConstants push_constants = {
+    .mip_count = mip_level_count_,
+    .tile_count = tile_columns * tile_rows,
+  };
+  pipeline_.Dispatch(command_buffer, descriptor_set_, &push_constants, tile_columns, tile_rows);
+}
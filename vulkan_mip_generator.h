@@ -0,0 +1,85 @@
+#ifndef VULKAN_MIP_GENERATOR_H_
+#define VULKAN_MIP_GENERATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_compute_pipeline.h"
+
+class VulkanDevice;
+
+// Builds an image's mip chain on the GPU, in a single compute dispatch.
+//
+// Blitting each level from the previous one takes a vkCmdBlitImage() and a
+// barrier per level. Here, workgroups reduce 64x64 texel tiles to 6 levels in
+// registers and shared memory, and the last workgroup to finish reduces the
+// tiles' results into the remaining levels. Texels are exchanged with
+// subgroup shuffles when the device supports them in compute shaders.
+//
+// Besides averaging, for render targets and textures, levels can keep their
+// texels' minimum or maximum, for Hi-Z depth pyramids.
+//
+// Each texel reduces the 2x2 texels under it, so a level with an odd width
+// or height doesn't pass its last column or row on. Min and max reductions
+// therefore require power-of-two extents, where no level up to 1x1 is odd.
+// Depth pyramids for other sizes must use a power-of-two base level that
+// covers the depth buffer.
+class VulkanMipGenerator {
+ public:
+  enum class Reduction {
+    kAverage = 0,
+    kMin = 1,
+    kMax = 2,
+  };
+
+  // Includes the base level.
+  static constexpr uint32_t kMaxMipLevelCount = 13;
+
+  // The number of levels in a full mip chain for the given base level size.
+  [[nodiscard]] static uint32_t FullMipLevelCount(VkExtent2D extent);
+
+  // `device` and `image` must outlive this instance.
+  //
+  // `image` must be a 2D image created with storage usage, with the given
+  // `extent` and `mip_level_count`. `extent` must be at most 4096 texels on
+  // each side, and a power of two on each side unless `reduction` is
+  // kAverage. `format` must be R8G8B8A8_UNORM, R16G16B16A16_SFLOAT or
+  // R32_SFLOAT. sRGB formats can't be used for storage images. Depth
+  // pyramids must copy the depth buffer to an R32_SFLOAT base level.
+  explicit VulkanMipGenerator(const VulkanDevice& device, VkImage image, VkFormat format,
+                              VkExtent2D extent, uint32_t mip_level_count,
+                              Reduction reduction = Reduction::kAverage);
+
+  VulkanMipGenerator(const VulkanMipGenerator&) = delete;
+  VulkanMipGenerator& operator=(const VulkanMipGenerator&) = delete;
+
+  ~VulkanMipGenerator();
+
+  // True if the shader exchanges texels with subgroup operations.
+  [[nodiscard]] bool UsesSubgroups() const { return uses_subgroups_; }
+
+  // Records the generation of levels 1 and up from the base level.
+  //
+  // All the image's levels must be in the GENERAL layout, and writes to the
+  // base level must be visible to compute shaders. The levels are written by
+  // compute shaders.
+  void Record(VkCommandBuffer command_buffer);
+
+ private:
+  const VulkanDevice& device_;
+  const VkExtent2D extent_;
+  const uint32_t mip_level_count_;
+  const bool uses_subgroups_;
+
+  // One view per level.
+  const std::vector<VkImageView> level_views_;
+  // Counts the workgroups that finished their tile.
+  VulkanBuffer counter_buffer_;
+  VulkanComputePipeline pipeline_;
+  const VkDescriptorSet descriptor_set_;
+};
+
+#endif  // VULKAN_MIP_GENERATOR_H_
@@ -2,10 +2,12 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
 
 #include "vulkan_config.h"
 #include "vulkan_extension_list.h"
@@ -37,6 +39,68 @@ namespace {
   return properties;
 }
 
+[[nodiscard]] VulkanDeviceIdentity GetDeviceIdentity(VkPhysicalDevice device) {
+  assert(device != VK_NULL_HANDLE);
+
+  VkPhysicalDeviceIDProperties id_properties{};
+  id_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+  VkPhysicalDeviceProperties2 properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties.pNext = &id_properties;
+  vkGetPhysicalDeviceProperties2(device, &properties);
+
+  VulkanDeviceIdentity identity;
+  std::copy(std::begin(id_properties.deviceUUID), std::end(id_properties.deviceUUID),
+            identity.device_uuid.begin());
+  std::copy(std::begin(id_properties.driverUUID), std::end(id_properties.driverUUID),
+            identity.driver_uuid.begin());
+  return identity;
+}
+
+[[nodiscard]] VkPhysicalDeviceSubgroupProperties GetSubgroupProperties(VkPhysicalDevice device) {
+  assert(device != VK_NULL_HANDLE);
+
+  VkPhysicalDeviceSubgroupProperties subgroup_properties{};
+  subgroup_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+  VkPhysicalDeviceProperties2 properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties.pNext = &subgroup_properties;
+  vkGetPhysicalDeviceProperties2(device, &properties);
+
+  // The copy must not point into this stack frame.
+  subgroup_properties.pNext = nullptr;
+  return subgroup_properties;
+}
+
+[[nodiscard]] bool GetGraphicsPipelineLibrarySupport(VkPhysicalDevice device) {
+  assert(device != VK_NULL_HANDLE);
+
+  VulkanExtensionList device_extensions(device);
+  if (!device_extensions.Contains(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+      !device_extensions.Contains(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+    return false;
+  }
+
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT library_features{};
+  library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+  VkPhysicalDeviceFeatures2 features{};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &library_features;
+  vkGetPhysicalDeviceFeatures2(device, &features);
+
+  VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT library_properties{};
+  library_properties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+  VkPhysicalDeviceProperties2 properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties.pNext = &library_properties;
+  vkGetPhysicalDeviceProperties2(device, &properties);
+
+  // Without fast linking, linking libraries can take as long as compiling.
+  return library_features.graphicsPipelineLibrary == VK_TRUE &&
+         library_properties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+}
+
 [[nodiscard]] std::vector<VkQueueFamilyProperties> GetDeviceQueueFamilies(VkPhysicalDevice device) {
   assert(device != VK_NULL_HANDLE);
 
@@ -59,6 +123,26 @@ namespace {
   return graphics_queue_family_indexes;
 }
 
+[[nodiscard]] std::vector<uint32_t> GetComputeQueueFamilyIndexes(
+    const std::vector<VkQueueFamilyProperties>& queue_families) {
+  std::vector<uint32_t> dedicated_indexes, shared_indexes;
+  for (size_t queue_family_index = 0; queue_family_index < queue_families.size();
+       ++queue_family_index) {
+    VkQueueFlags flags = queue_families[queue_family_index].queueFlags;
+    if (!(flags & VK_QUEUE_COMPUTE_BIT))
+      continue;
+
+    if (flags & VK_QUEUE_GRAPHICS_BIT)
+      shared_indexes.push_back(static_cast<uint32_t>(queue_family_index));
+    else
+      dedicated_indexes.push_back(static_cast<uint32_t>(queue_family_index));
+  }
+
+  // Dedicated compute queue families don't compete with graphics work.
+  dedicated_indexes.insert(dedicated_indexes.end(), shared_indexes.begin(), shared_indexes.end());
+  return dedicated_indexes;
+}
+
 }  // namespace
 
 VulkanPhysicalDevice::VulkanPhysicalDevice(VkPhysicalDevice physical_device_handle)
@@ -66,8 +150,12 @@ VulkanPhysicalDevice::VulkanPhysicalDevice(VkPhysicalDevice physical_device_hand
       properties_(GetDeviceProperties(physical_device_handle)),
       features_(GetDeviceFeatures(physical_device_handle)),
       memory_properties_(GetDeviceMemoryProperties(physical_device_handle)),
+      identity_(GetDeviceIdentity(physical_device_handle)),
+      subgroup_properties_(GetSubgroupProperties(physical_device_handle)),
       queue_families_(GetDeviceQueueFamilies(physical_device_handle)),
-      graphics_queue_family_indices_(GetGraphicsQueueFamilyIndexes(queue_families_)) {
+      has_graphics_pipeline_library_(GetGraphicsPipelineLibrarySupport(physical_device_handle)),
+      graphics_queue_family_indices_(GetGraphicsQueueFamilyIndexes(queue_families_)),
+      compute_queue_family_indices_(GetComputeQueueFamilyIndexes(queue_families_)) {
   assert(physical_device_handle != VK_NULL_HANDLE);
 }
 
@@ -79,6 +167,8 @@ VulkanPhysicalDevice::~VulkanPhysicalDevice() = default;
 void VulkanPhysicalDevice::Print() const {
   std::cout << "  " << properties_.deviceName  << " id: " << properties_.deviceID
             << " type: " << properties_.deviceType << " API: " << properties_.apiVersion << "\n";
+  if (!HasPipelineStatisticsQuery())
+    std::cout << "    pipeline statistics queries not supported\n";
 }
 
 bool VulkanPhysicalDevice::HasRequiredFeatures() const {
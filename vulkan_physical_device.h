@@ -1,8 +1,10 @@
 #ifndef VULKAN_PHYSICAL_DEVICE_H_
 #define VULKAN_PHYSICAL_DEVICE_H_
 
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <set>
 #include <string_view>
 #include <vector>
@@ -11,6 +13,22 @@
 
 #include "vulkan_extension_list.h"
 
+// Identifies a physical device and its driver across processes.
+//
+// Memory and semaphores exported as opaque file descriptors can only be
+// imported by a device with the same identity.
+struct VulkanDeviceIdentity {
+  std::array<uint8_t, VK_UUID_SIZE> device_uuid;
+  std::array<uint8_t, VK_UUID_SIZE> driver_uuid;
+
+  [[nodiscard]] bool operator==(const VulkanDeviceIdentity& other) const {
+    return device_uuid == other.device_uuid && driver_uuid == other.driver_uuid;
+  }
+  [[nodiscard]] bool operator!=(const VulkanDeviceIdentity& other) const {
+    return !(*this == other);
+  }
+};
+
 // Information about a physical device's capabilities.
 //
 // This instance can be discarded after a VulkanDevice is created.
@@ -42,6 +60,58 @@ class VulkanPhysicalDevice {
     return graphics_queue_family_indices_;
   }
 
+  // The list is empty on devices that don't have any compute command queues.
+  //
+  // Queue families that don't support graphics commands are listed first.
+  [[nodiscard]] const std::vector<uint32_t>& ComputeQueueFamilyIndices() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return compute_queue_family_indices_;
+  }
+
+  [[nodiscard]] const VkPhysicalDeviceMemoryProperties& MemoryProperties() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return memory_properties_;
+  }
+
+  [[nodiscard]] const VulkanDeviceIdentity& Identity() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return identity_;
+  }
+
+  // The subgroup size, and the subgroup operations available in each stage.
+  [[nodiscard]] const VkPhysicalDeviceSubgroupProperties& SubgroupProperties() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return subgroup_properties_;
+  }
+
+  // True if the device supports VK_EXT_graphics_pipeline_library, and links
+  // pipeline libraries fast enough to do it while recording draws.
+  [[nodiscard]] bool HasGraphicsPipelineLibrary() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return has_graphics_pipeline_library_;
+  }
+
+  // False if the device can't count shader invocations and primitives with
+  // VK_QUERY_TYPE_PIPELINE_STATISTICS queries. Print() mentions it.
+  [[nodiscard]] bool HasPipelineStatisticsQuery() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return features_.pipelineStatisticsQuery == VK_TRUE;
+  }
+
+  // Nanoseconds per timestamp query tick.
+  [[nodiscard]] float TimestampPeriod() const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    return properties_.limits.timestampPeriod;
+  }
+
+  // The number of meaningful bits in timestamps written by a queue family's
+  // queues. 0 if the queues don't support timestamp queries.
+  [[nodiscard]] uint32_t TimestampValidBits(uint32_t queue_family_index) const {
+    assert(physical_device_ != VK_NULL_HANDLE);
+    assert(queue_family_index < queue_families_.size());
+    return queue_families_[queue_family_index].timestampValidBits;
+  }
+
   [[nodiscard]] VkPhysicalDevice VulkanHandle() const {
     assert(physical_device_ != VK_NULL_HANDLE);
     return physical_device_;
@@ -52,9 +122,13 @@ class VulkanPhysicalDevice {
   VkPhysicalDeviceProperties properties_;
   VkPhysicalDeviceFeatures features_;
   VkPhysicalDeviceMemoryProperties memory_properties_;
+  VulkanDeviceIdentity identity_;
+  VkPhysicalDeviceSubgroupProperties subgroup_properties_;
   std::vector<VkQueueFamilyProperties> queue_families_;
+  bool has_graphics_pipeline_library_;
 
   std::set<uint32_t> graphics_queue_family_indices_;
+  std::vector<uint32_t> compute_queue_family_indices_;
 };
 
 #endif  // VULKAN_PHYSICAL_DEVICE_H_
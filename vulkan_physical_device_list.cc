@@ -2,8 +2,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <vulkan/vulkan_core.h>
@@ -40,11 +46,25 @@ namespace {
 
   std::vector<VkPhysicalDevice> device_handles = ListVulkanPhysicalDevices(instance);
 
+  // Each device is probed on its own thread, because querying a device's
+  // properties, extensions and queues can take milliseconds. Physical device
+  // queries don't need external synchronization.
+  std::vector<std::optional<VulkanPhysicalDevice>> probed_devices(device_handles.size());
+  std::vector<std::thread> probe_threads;
+  for (size_t i = 1; i < device_handles.size(); ++i) {
+    probe_threads.emplace_back([&probed_devices, &device_handles, i]() {
+      probed_devices[i].emplace(device_handles[i]);
+    });
+  }
+  if (!device_handles.empty())
+    probed_devices[0].emplace(device_handles[0]);
+  for (std::thread& probe_thread : probe_threads)
+    probe_thread.join();
+
   std::vector<VulkanPhysicalDevice> devices;
   devices.reserve(device_handles.size());
-
-  for (VkPhysicalDevice device_handle : device_handles)
-    devices.emplace_back(device_handle);
+  for (std::optional<VulkanPhysicalDevice>& probed_device : probed_devices)
+    devices.push_back(std::move(*probed_device));
   return devices;
 }
 
@@ -64,7 +84,10 @@ void VulkanPhysicalDeviceList::Print() const {
 
 
 VulkanDevice VulkanPhysicalDeviceList::CreateLogicalDevice(
-    const VulkanConfig& vulkan_config, const VulkanPresentationSurface& surface) {
+    const VulkanConfig& vulkan_config,
+    const std::vector<const VulkanPresentationSurface*>& surfaces) {
+  assert(!surfaces.empty());
+
   const std::vector<const char*>& required_layers = vulkan_config.RequiredLayers();
   const std::vector<const char*>& required_extensions = vulkan_config.RequiredDeviceExtensions();
 
@@ -78,13 +101,49 @@ VulkanDevice VulkanPhysicalDeviceList::CreateLogicalDevice(
     if (physical_device.GraphicsQueueFamilyIndices().empty())
       continue;
 
-    VulkanSurfaceSupport surface_support(physical_device, surface.VulkanHandle());
-    if (!surface_support.IsAcceptable())
+    std::vector<std::unique_ptr<VulkanSurfaceSupport>> surface_supports;
+    std::vector<const VulkanSurfaceSupport*> acceptable_surface_supports;
+    for (const VulkanPresentationSurface* surface : surfaces) {
+      surface_supports.push_back(
+          std::make_unique<VulkanSurfaceSupport>(physical_device, surface->VulkanHandle()));
+      if (!surface_supports.back()->IsAcceptable())
+        break;
+      acceptable_surface_supports.push_back(surface_supports.back().get());
+    }
+    if (acceptable_surface_supports.size() != surfaces.size())
+      continue;
+
+    std::optional<VulkanSurfaceSupport::Queues> queues =
+        VulkanSurfaceSupport::CommonQueueFamilyIndexes(acceptable_surface_supports);
+    if (!queues.has_value())
       continue;
 
-    return VulkanDevice(vulkan_config, surface_support, surface, physical_device);
+    return VulkanDevice(vulkan_config, queues->graphics_queue_family_index,
+                        queues->presentation_queue_family_index, physical_device);
   }
 
   std::cerr << "No suitable Vulkan device attached" << std::endl;
   std::abort();
 }
+
+VulkanDevice VulkanPhysicalDeviceList::CreateComputeDevice(
+    const VulkanConfig& vulkan_config, const VulkanDeviceIdentity* required_identity) {
+  const std::vector<const char*>& required_layers = vulkan_config.RequiredLayers();
+  const std::vector<const char*>& required_extensions = vulkan_config.RequiredDeviceExtensions();
+
+  for (VulkanPhysicalDevice& physical_device : devices_) {
+    if (required_identity != nullptr && physical_device.Identity() != *required_identity)
+      continue;
+    if (!physical_device.HasLayers(required_layers))
+      continue;
+    if (!physical_device.HasExtensions(required_extensions))
+      continue;
+    if (physical_device.ComputeQueueFamilyIndices().empty())
+      continue;
+
+    return VulkanDevice(vulkan_config, physical_device);
+  }
+
+  std::cerr << "No Vulkan device with compute support attached" << std::endl;
+  std::abort();
+}
@@ -22,8 +22,17 @@ class VulkanPhysicalDeviceList {
   void Print() const;
 
   // Finds a suitable physical device and creates a logical device on it.
+  //
+  // The device can render to and present on all the given surfaces, using a
+  // single presentation queue.
   VulkanDevice CreateLogicalDevice(const VulkanConfig& vulkan_config,
-                                   const VulkanPresentationSurface& surface);
+                                   const std::vector<const VulkanPresentationSurface*>& surfaces);
+
+  // Finds a device with a compute queue and creates a compute-only logical device on it.
+  //
+  // If `required_identity` is not null, only the matching device is considered.
+  VulkanDevice CreateComputeDevice(const VulkanConfig& vulkan_config,
+                                   const VulkanDeviceIdentity* required_identity = nullptr);
 
  private:
   std::vector<VulkanPhysicalDevice> devices_;
@@ -0,0 +1,520 @@
+#include "vulkan_pipeline_manager.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "job_system.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+
+struct VulkanPipelineManager::Part {
+  // One of the VK_GRAPHICS_PIPELINE_LIBRARY_*_BIT_EXT values.
+  VkGraphicsPipelineLibraryFlagsEXT kind;
+
+  // Vertex input parts.
+  std::vector<VkVertexInputBindingDescription> bindings;
+  std::vector<VkVertexInputAttributeDescription> attributes;
+  VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+  // Shader parts.
+  VkShaderModule shader_module = VK_NULL_HANDLE;
+  bool has_specialization = false;
+  std::vector<VkSpecializationMapEntry> specialization_entries;
+  std::vector<uint8_t> specialization_data;
+
+  // Vertex shader parts.
+  VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
+  VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+  // Fragment shader parts.
+  bool depth_test = false;
+
+  // Fragment output parts.
+  bool alpha_blend = false;
+
+  // Tracks the compile of `library`, on devices with pipeline libraries.
+  JobCounter library_compile;
+  VkPipeline library = VK_NULL_HANDLE;
+};
+
+namespace {
+
+constexpr VkGraphicsPipelineLibraryFlagsEXT kAllParts =
+    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+// The state structures for some parts of a pipeline.
+//
+// The structures point into this instance, so it can't be moved.
+class GraphicsPipelineState {
+ public:
+  GraphicsPipelineState() = default;
+
+  GraphicsPipelineState(const GraphicsPipelineState&) = delete;
+  GraphicsPipelineState& operator=(const GraphicsPipelineState&) = delete;
+
+  // Fills in the state that belongs to `part`.
+  template <typename PartType>
+  void Add(const PartType& part) {
+    switch (part.kind) {
+      case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+        vertex_input_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .vertexBindingDescriptionCount = static_cast<uint32_t>(part.bindings.size()),
+          .pVertexBindingDescriptions = part.bindings.data(),
+          .vertexAttributeDescriptionCount = static_cast<uint32_t>(part.attributes.size()),
+          .pVertexAttributeDescriptions = part.attributes.data(),
+        };
+        input_assembly_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .topology = part.topology,
+          .primitiveRestartEnable = VK_FALSE,
+        };
+        create_info_.pVertexInputState = &vertex_input_;
+        create_info_.pInputAssemblyState = &input_assembly_;
+        break;
+
+      case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+        AddShaderStage(part, VK_SHADER_STAGE_VERTEX_BIT);
+        viewport_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .viewportCount = 1,
+          .pViewports = nullptr,
+          .scissorCount = 1,
+          .pScissors = nullptr,
+        };
+        rasterization_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .depthClampEnable = VK_FALSE,
+          .rasterizerDiscardEnable = VK_FALSE,
+          .polygonMode = VK_POLYGON_MODE_FILL,
+          .cullMode = part.cull_mode,
+          .frontFace = part.front_face,
+          .depthBiasEnable = VK_FALSE,
+          .depthBiasConstantFactor = 0.0f,
+          .depthBiasClamp = 0.0f,
+          .depthBiasSlopeFactor = 0.0f,
+          .lineWidth = 1.0f,
+        };
+        dynamic_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .dynamicStateCount = static_cast<uint32_t>(kDynamicStates.size()),
+          .pDynamicStates = kDynamicStates.data(),
+        };
+        create_info_.pViewportState = &viewport_;
+        create_info_.pRasterizationState = &rasterization_;
+        create_info_.pDynamicState = &dynamic_;
+        break;
+
+      case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+        AddShaderStage(part, VK_SHADER_STAGE_FRAGMENT_BIT);
+        depth_stencil_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .depthTestEnable = part.depth_test ? VK_TRUE : VK_FALSE,
+          .depthWriteEnable = part.depth_test ? VK_TRUE : VK_FALSE,
+          .depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
+          .depthBoundsTestEnable = VK_FALSE,
+          .stencilTestEnable = VK_FALSE,
+          .front = {},
+          .back = {},
+          .minDepthBounds = 0.0f,
+          .maxDepthBounds = 1.0f,
+        };
+        create_info_.pDepthStencilState = &depth_stencil_;
+        AddMultisampleState();
+        break;
+
+      case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+        color_blend_attachment_ = {
+          .blendEnable = part.alpha_blend ? VK_TRUE : VK_FALSE,
+          .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+          .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+          .colorBlendOp = VK_BLEND_OP_ADD,
+          .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+          .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+          .alphaBlendOp = VK_BLEND_OP_ADD,
+          .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                            VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+        };
+        color_blend_ = {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .logicOpEnable = VK_FALSE,
+          .logicOp = VK_LOGIC_OP_COPY,
+          .attachmentCount = 1,
+          .pAttachments = &color_blend_attachment_,
+          .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f},
+        };
+        create_info_.pColorBlendState = &color_blend_;
+        AddMultisampleState();
+        break;
+
+      default:
+        std::cerr << "Invalid pipeline part" << std::endl;
+        std::abort();
+    }
+  }
+
+  // The returned structure points into this instance.
+  [[nodiscard]] VkGraphicsPipelineCreateInfo& CreateInfo() {
+    create_info_.stageCount = stage_count_;
+    create_info_.pStages = stage_count_ != 0 ? stages_.data() : nullptr;
+    return create_info_;
+  }
+
+ private:
+  static constexpr std::array<VkDynamicState, 2> kDynamicStates = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+  };
+
+  template <typename PartType>
+  void AddShaderStage(const PartType& part, VkShaderStageFlagBits stage) {
+    VkSpecializationInfo& specialization = specializations_[stage_count_];
+    specialization = {
+      .mapEntryCount = static_cast<uint32_t>(part.specialization_entries.size()),
+      .pMapEntries = part.specialization_entries.data(),
+      .dataSize = part.specialization_data.size(),
+      .pData = part.specialization_data.data(),
+    };
+    stages_[stage_count_] = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage = stage,
+      .module = part.shader_module,
+      .pName = "main",
+      .pSpecializationInfo = part.has_specialization ? &specialization : nullptr,
+    };
+    ++stage_count_;
+  }
+
+  // Both fragment parts need the multisample state, and it must match.
+  void AddMultisampleState() {
+    multisample_ = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+      .sampleShadingEnable = VK_FALSE,
+      .minSampleShading = 1.0f,
+      .pSampleMask = nullptr,
+      .alphaToCoverageEnable = VK_FALSE,
+      .alphaToOneEnable = VK_FALSE,
+    };
+    create_info_.pMultisampleState = &multisample_;
+  }
+
+  VkGraphicsPipelineCreateInfo create_info_ = {
+    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .stageCount = 0,
+    .pStages = nullptr,
+    .pVertexInputState = nullptr,
+    .pInputAssemblyState = nullptr,
+    .pTessellationState = nullptr,
+    .pViewportState = nullptr,
+    .pRasterizationState = nullptr,
+    .pMultisampleState = nullptr,
+    .pDepthStencilState = nullptr,
+    .pColorBlendState = nullptr,
+    .pDynamicState = nullptr,
+    .layout = VK_NULL_HANDLE,
+    .renderPass = VK_NULL_HANDLE,
+    .subpass = 0,
+    .basePipelineHandle = VK_NULL_HANDLE,
+    .basePipelineIndex = -1,
+  };
+
+  uint32_t stage_count_ = 0;
+  std::array<VkPipelineShaderStageCreateInfo, 2> stages_;
+  std::array<VkSpecializationInfo, 2> specializations_;
+  VkPipelineVertexInputStateCreateInfo vertex_input_;
+  VkPipelineInputAssemblyStateCreateInfo input_assembly_;
+  VkPipelineViewportStateCreateInfo viewport_;
+  VkPipelineRasterizationStateCreateInfo rasterization_;
+  VkPipelineDynamicStateCreateInfo dynamic_;
+  VkPipelineMultisampleStateCreateInfo multisample_;
+  VkPipelineDepthStencilStateCreateInfo depth_stencil_;
+  VkPipelineColorBlendAttachmentState color_blend_attachment_;
+  VkPipelineColorBlendStateCreateInfo color_blend_;
+};
+
+[[nodiscard]] VkPipeline CreateGraphicsPipeline(const VulkanDevice& device,
+                                                const VkGraphicsPipelineCreateInfo& create_info,
+                                                [[maybe_unused]] const char* debug_name) {
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateGraphicsPipelines(
+      device.VulkanHandle(), /*pipelineCache=*/VK_NULL_HANDLE, 1, &create_info,
+      /*pAllocator=*/nullptr, &pipeline);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateGraphicsPipelines() failed" << std::endl;
+    std::abort();
+  }
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE, pipeline, debug_name);
+  return pipeline;
+}
+
+// Copies `specialization_info` into `part`.
+template <typename PartType>
+void CopySpecialization(const VkSpecializationInfo* specialization_info, PartType& part) {
+  if (specialization_info == nullptr)
+    return;
+
+  part.has_specialization = true;
+  part.specialization_entries.assign(
+      specialization_info->pMapEntries,
+      specialization_info->pMapEntries + specialization_info->mapEntryCount);
+  const auto* data = static_cast<const uint8_t*>(specialization_info->pData);
+  part.specialization_data.assign(data, data + specialization_info->dataSize);
+}
+
+}  // namespace
+
+VulkanPipelineManager::VulkanPipelineManager(const VulkanDevice& device, JobSystem& job_system,
+                                             VkRenderPass render_pass,
+                                             VkPipelineLayout pipeline_layout)
+    : device_(device),
+      job_system_(job_system),
+      render_pass_(render_pass),
+      pipeline_layout_(pipeline_layout),
+      uses_pipeline_libraries_(device.HasGraphicsPipelineLibrary()) {
+  assert(render_pass != VK_NULL_HANDLE);
+  assert(pipeline_layout != VK_NULL_HANDLE);
+}
+
+VulkanPipelineManager::~VulkanPipelineManager() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  // Linked pipelines don't need their libraries after they are created.
+  for (auto& [variant, state] : variants_) {
+    job_system_.Wait(state->optimized_compile);
+    VkPipeline optimized_pipeline = state->optimized_pipeline.load(std::memory_order_acquire);
+    functions.vkDestroyPipeline(device, optimized_pipeline, /*pAllocator=*/nullptr);
+    if (state->fast_linked_pipeline != VK_NULL_HANDLE) {
+      functions.vkDestroyPipeline(device, state->fast_linked_pipeline, /*pAllocator=*/nullptr);
+    }
+  }
+  for (const std::unique_ptr<Part>& part : parts_) {
+    job_system_.Wait(part->library_compile);
+    if (part->library != VK_NULL_HANDLE)
+      functions.vkDestroyPipeline(device, part->library, /*pAllocator=*/nullptr);
+  }
+}
+
+VulkanPipelineManager::PartId VulkanPipelineManager::AddVertexInput(
+    const VkPipelineVertexInputStateCreateInfo& vertex_input_state,
+    VkPrimitiveTopology topology) {
+  auto part = std::make_unique<Part>();
+  part->kind = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+  part->bindings.assign(
+      vertex_input_state.pVertexBindingDescriptions,
+      vertex_input_state.pVertexBindingDescriptions +
+          vertex_input_state.vertexBindingDescriptionCount);
+  part->attributes.assign(
+      vertex_input_state.pVertexAttributeDescriptions,
+      vertex_input_state.pVertexAttributeDescriptions +
+          vertex_input_state.vertexAttributeDescriptionCount);
+  part->topology = topology;
+  return AddPart(std::move(part));
+}
+
+VulkanPipelineManager::PartId VulkanPipelineManager::AddVertexShader(
+    VkShaderModule shader_module, const VkSpecializationInfo* specialization_info,
+    VkCullModeFlags cull_mode, VkFrontFace front_face) {
+  assert(shader_module != VK_NULL_HANDLE);
+
+  auto part = std::make_unique<Part>();
+  part->kind = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+  part->shader_module = shader_module;
+  CopySpecialization(specialization_info, *part);
+  part->cull_mode = cull_mode;
+  part->front_face = front_face;
+  return AddPart(std::move(part));
+}
+
+VulkanPipelineManager::PartId VulkanPipelineManager::AddFragmentShader(
+    VkShaderModule shader_module, const VkSpecializationInfo* specialization_info,
+    bool depth_test) {
+  assert(shader_module != VK_NULL_HANDLE);
+
+  auto part = std::make_unique<Part>();
+  part->kind = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+  part->shader_module = shader_module;
+  CopySpecialization(specialization_info, *part);
+  part->depth_test = depth_test;
+  return AddPart(std::move(part));
+}
+
+VulkanPipelineManager::PartId VulkanPipelineManager::AddFragmentOutput(bool alpha_blend) {
+  auto part = std::make_unique<Part>();
+  part->kind = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+  part->alpha_blend = alpha_blend;
+  return AddPart(std::move(part));
+}
+
+void VulkanPipelineManager::Prepare(const Variant& variant) {
+  (void)FindOrPrepare(variant);
+}
+
+VkPipeline VulkanPipelineManager::Pipeline(const Variant& variant) {
+  VariantState& state = FindOrPrepare(variant);
+
+  VkPipeline optimized_pipeline = state.optimized_pipeline.load(std::memory_order_acquire);
+  if (optimized_pipeline != VK_NULL_HANDLE)
+    return optimized_pipeline;
+
+  if (!uses_pipeline_libraries_) {
+    job_system_.Wait(state.optimized_compile);
+    return state.optimized_pipeline.load(std::memory_order_acquire);
+  }
+
+  std::lock_guard<std::mutex> lock(state.fast_link_mutex);
+  if (state.fast_linked_pipeline == VK_NULL_HANDLE)
+    state.fast_linked_pipeline = CompilePipeline(variant, /*optimize=*/false);
+  return state.fast_linked_pipeline;
+}
+
+VulkanPipelineManager::PartId VulkanPipelineManager::AddPart(std::unique_ptr<Part> part) {
+  Part* part_pointer = part.get();
+  PartId part_id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    part_id = static_cast<PartId>(parts_.size());
+    parts_.push_back(std::move(part));
+  }
+
+  if (uses_pipeline_libraries_) {
+    job_system_.Schedule([this, part_pointer]() {
+      part_pointer->library = CompileLibrary(*part_pointer);
+    }, &part_pointer->library_compile);
+  }
+  return part_id;
+}
+
+VulkanPipelineManager::Part& VulkanPipelineManager::GetPart(PartId part_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(part_id < parts_.size());
+  return *parts_[part_id];
+}
+
+VulkanPipelineManager::VariantState& VulkanPipelineManager::FindOrPrepare(
+    const Variant& variant) {
+  VariantState* state;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<VariantState>& variant_state = variants_[variant];
+    if (variant_state != nullptr)
+      return *variant_state;
+
+    variant_state = std::make_unique<VariantState>();
+    state = variant_state.get();
+  }
+
+  job_system_.Schedule([this, variant, state]() {
+    state->optimized_pipeline.store(CompilePipeline(variant, /*optimize=*/true),
+                                    std::memory_order_release);
+    optimized_variant_count_.fetch_add(1, std::memory_order_relaxed);
+  }, &state->optimized_compile);
+  return *state;
+}
+
+VkPipeline VulkanPipelineManager::CompileLibrary(const Part& part) const {
+  GraphicsPipelineState state;
+  state.Add(part);
+
+  VkGraphicsPipelineLibraryCreateInfoEXT library_info = {
+    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+    .pNext = nullptr,
+    .flags = part.kind,
+  };
+
+  // Retaining the link-time optimization information lets the libraries be
+  // linked into optimized pipelines later.
+  VkGraphicsPipelineCreateInfo& create_info = state.CreateInfo();
+  create_info.pNext = &library_info;
+  create_info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                      VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+  create_info.layout = pipeline_layout_;
+  create_info.renderPass = render_pass_;
+  return CreateGraphicsPipeline(device_, create_info, "Pipeline library");
+}
+
+VkPipeline VulkanPipelineManager::CompilePipeline(const Variant& variant, bool optimize) {
+  std::array<Part*, 4> parts = {
+    &GetPart(variant.vertex_input),
+    &GetPart(variant.vertex_shader),
+    &GetPart(variant.fragment_shader),
+    &GetPart(variant.fragment_output),
+  };
+
+  // Each part must be of the kind its position in the variant implies.
+  VkGraphicsPipelineLibraryFlagsEXT kinds = 0;
+  for (const Part* part : parts)
+    kinds |= part->kind;
+  assert(kinds == kAllParts);
+  (void)kinds;
+
+  if (!uses_pipeline_libraries_) {
+    GraphicsPipelineState state;
+    for (const Part* part : parts)
+      state.Add(*part);
+
+    VkGraphicsPipelineCreateInfo& create_info = state.CreateInfo();
+    create_info.layout = pipeline_layout_;
+    create_info.renderPass = render_pass_;
+    return CreateGraphicsPipeline(device_, create_info, "Pipeline");
+  }
+
+  std::array<VkPipeline, 4> libraries;
+  for (size_t i = 0; i < parts.size(); ++i) {
+    job_system_.Wait(parts[i]->library_compile);
+    libraries[i] = parts[i]->library;
+  }
+
+  VkPipelineLibraryCreateInfoKHR library_info = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+    .pNext = nullptr,
+    .libraryCount = static_cast<uint32_t>(libraries.size()),
+    .pLibraries = libraries.data(),
+  };
+
+  // Without VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT, linking only
+  // stitches together the libraries' code.
+  GraphicsPipelineState state;
+  VkGraphicsPipelineCreateInfo& create_info = state.CreateInfo();
+  create_info.pNext = &library_info;
+  create_info.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+  create_info.layout = pipeline_layout_;
+  create_info.renderPass = render_pass_;
+  return CreateGraphicsPipeline(device_, create_info,
+                                optimize ? "Optimized pipeline" : "Fast-linked pipeline");
+}
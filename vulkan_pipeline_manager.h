@@ -0,0 +1,147 @@
+#ifndef VULKAN_PIPELINE_MANAGER_H_
+#define VULKAN_PIPELINE_MANAGER_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "job_system.h"
+
+class VulkanDevice;
+
+// Compiles graphics pipeline variants on JobSystem workers.
+//
+// A variant combines four independently registered parts: vertex input,
+// vertex shader (pre-rasterization), fragment shader, and fragment output.
+// Each part is registered once and shared by all the variants that use it.
+//
+// On devices with VK_EXT_graphics_pipeline_library, each part is compiled
+// into a pipeline library as soon as it is registered. The first time a
+// variant is drawn, its libraries are linked without optimizations, which
+// is fast enough to do while recording. An optimized pipeline is linked in
+// the background, and replaces the quickly linked one once it is ready.
+//
+// Other devices compile complete pipelines. Variants should be requested
+// with Prepare() before they are drawn, to avoid waiting for the compile.
+//
+// All pipelines render to subpass 0 of render passes compatible with the
+// one given at construction, with one color attachment, a dynamic viewport
+// and a dynamic scissor.
+class VulkanPipelineManager {
+ public:
+  using PartId = uint32_t;
+
+  // Identifies a pipeline variant by its parts.
+  struct Variant {
+    PartId vertex_input;
+    PartId vertex_shader;
+    PartId fragment_shader;
+    PartId fragment_output;
+
+    [[nodiscard]] bool operator<(const Variant& other) const {
+      return std::tie(vertex_input, vertex_shader, fragment_shader, fragment_output) <
+             std::tie(other.vertex_input, other.vertex_shader, other.fragment_shader,
+                      other.fragment_output);
+    }
+  };
+
+  // `device`, `job_system`, `render_pass` and `pipeline_layout` must outlive
+  // this instance.
+  explicit VulkanPipelineManager(const VulkanDevice& device, JobSystem& job_system,
+                                 VkRenderPass render_pass, VkPipelineLayout pipeline_layout);
+
+  VulkanPipelineManager(const VulkanPipelineManager&) = delete;
+  VulkanPipelineManager& operator=(const VulkanPipelineManager&) = delete;
+
+  // Waits for all the background compiles.
+  ~VulkanPipelineManager();
+
+  // True if variants are linked from pipeline libraries.
+  [[nodiscard]] bool UsesPipelineLibraries() const { return uses_pipeline_libraries_; }
+
+  // Registers the parts that make up variants.
+  //
+  // The Vulkan structures are copied. Shader modules must outlive this
+  // instance. `specialization_info` may be null.
+  PartId AddVertexInput(const VkPipelineVertexInputStateCreateInfo& vertex_input_state,
+                        VkPrimitiveTopology topology);
+  PartId AddVertexShader(VkShaderModule shader_module,
+                         const VkSpecializationInfo* specialization_info,
+                         VkCullModeFlags cull_mode, VkFrontFace front_face);
+  PartId AddFragmentShader(VkShaderModule shader_module,
+                           const VkSpecializationInfo* specialization_info,
+                           bool depth_test);
+  PartId AddFragmentOutput(bool alpha_blend);
+
+  // Starts compiling `variant` in the background, if it wasn't started yet.
+  //
+  // Can be called from any thread.
+  void Prepare(const Variant& variant);
+
+  // Returns a pipeline for `variant`, for use in command buffers recorded now.
+  //
+  // Returns the optimized pipeline if it's ready. Otherwise, returns a
+  // quickly linked pipeline on devices with pipeline libraries, and waits for
+  // the compile on other devices. Can be called from any thread.
+  //
+  // Pipelines returned by this method remain valid until this instance is
+  // destroyed.
+  [[nodiscard]] VkPipeline Pipeline(const Variant& variant);
+
+  // Number of variants whose optimized pipelines are ready.
+  [[nodiscard]] size_t OptimizedVariantCount() const {
+    return optimized_variant_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // A registered part, with its library, if libraries are used.
+  struct Part;
+
+  struct VariantState {
+    // Tracks the compile of the optimized pipeline.
+    JobCounter optimized_compile;
+    std::atomic<VkPipeline> optimized_pipeline = VK_NULL_HANDLE;
+
+    // Guards the quick link, so it only happens once.
+    std::mutex fast_link_mutex;
+    VkPipeline fast_linked_pipeline = VK_NULL_HANDLE;  // Guarded by `fast_link_mutex`.
+  };
+
+  PartId AddPart(std::unique_ptr<Part> part);
+
+  // Returns the part with the given ID, which must have been registered.
+  [[nodiscard]] Part& GetPart(PartId part_id);
+
+  // Finds the state of `variant`. Starts compiling it if it's new.
+  [[nodiscard]] VariantState& FindOrPrepare(const Variant& variant);
+
+  // Creates the pipeline library for a part.
+  [[nodiscard]] VkPipeline CompileLibrary(const Part& part) const;
+
+  // Compiles a complete pipeline, or links one from the parts' libraries.
+  [[nodiscard]] VkPipeline CompilePipeline(const Variant& variant, bool optimize);
+
+  const VulkanDevice& device_;
+  JobSystem& job_system_;
+  const VkRenderPass render_pass_;
+  const VkPipelineLayout pipeline_layout_;
+  const bool uses_pipeline_libraries_;
+
+  std::atomic<size_t> optimized_variant_count_ = 0;
+
+  // Guards the maps, but not the parts or variants they point to, whose
+  // addresses are stable.
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Part>> parts_;  // Guarded by `mutex_`.
+  std::map<Variant, std::unique_ptr<VariantState>> variants_;  // Guarded by `mutex_`.
+};
+
+#endif  // VULKAN_PIPELINE_MANAGER_H_
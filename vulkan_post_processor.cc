@@ -0,0 +1,361 @@
+#include "vulkan_post_processor.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+#include "vulkan_render_target.h"
+#include "vulkan_shader_module.h"
+
+namespace {
+
+constexpr VkFormat kBloomFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+// Must match the shaders' workgroup sizes.
+constexpr uint32_t kLuminanceTileSize = 16;
+constexpr uint32_t kImageWorkgroupSize = 8;
+constexpr uint32_t kBlurWorkgroupSize = 64;
+
+// Must match shaders/post_luminance.comp.
+constexpr uint32_t kLuminanceTileScale = 4095;
+
+constexpr VkSubgroupFeatureFlags kRequiredSubgroupOperations =
+    VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT |
+    VK_SUBGROUP_FEATURE_SHUFFLE_BIT;
+
+constexpr VkImageSubresourceRange kColorSubresourceRange = {
+  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+  .baseMipLevel = 0,
+  .levelCount = 1,
+  .baseArrayLayer = 0,
+  .layerCount = 1,
+};
+
+// Selects the blur direction in shaders/post_blur.comp.
+constexpr VkBool32 kHorizontalBlur = VK_FALSE;
+constexpr VkBool32 kVerticalBlur = VK_TRUE;
+constexpr VkSpecializationMapEntry kBlurDirectionEntry = {
+  .constantID = 0,
+  .offset = 0,
+  .size = sizeof(VkBool32),
+};
+constexpr VkSpecializationInfo kHorizontalBlurSpecialization = {
+  .mapEntryCount = 1,
+  .pMapEntries = &kBlurDirectionEntry,
+  .dataSize = sizeof(VkBool32),
+  .pData = &kHorizontalBlur,
+};
+constexpr VkSpecializationInfo kVerticalBlurSpecialization = {
+  .mapEntryCount = 1,
+  .pMapEntries = &kBlurDirectionEntry,
+  .dataSize = sizeof(VkBool32),
+  .pData = &kVerticalBlur,
+};
+
+struct DownsamplePushConstants {
+  float threshold;
+};
+
+struct TonemapPushConstants {
+  float bloom_strength;
+  float sharpness;
+  float exposure_key;
+  uint32_t tile_count;
+};
+
+[[nodiscard]] constexpr uint32_t DivideRoundingUp(uint32_t dividend, uint32_t divisor) {
+  return (dividend + divisor - 1) / divisor;
+}
+
+[[nodiscard]] bool SupportsSubgroupShaders(const VulkanDevice& device) {
+  const VkPhysicalDeviceSubgroupProperties& properties = device.SubgroupProperties();
+  return (properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+         (properties.supportedOperations & kRequiredSubgroupOperations) ==
+             kRequiredSubgroupOperations;
+}
+
+// Shaders that benefit from subgroup operations have a variant that uses them.
+[[nodiscard]] std::vector<uint32_t> ReadPostProcessingShader(const std::string& name,
+                                                             bool use_subgroups) {
+  return ReadSpirvFile(name + (use_subgroups ? "_subgroup.spv" : ".spv"));
+}
+
+[[nodiscard]] VkExtent2D BloomLevelExtent(VkExtent2D extent, uint32_t level) {
+  for (uint32_t i = 0; i <= level; ++i) {
+    extent.width = DivideRoundingUp(extent.width, 2);
+    extent.height = DivideRoundingUp(extent.height, 2);
+  }
+  return extent;
+}
+
+// Stops at the first 1x1 level, as smaller levels would repeat it.
+[[nodiscard]] std::vector<std::unique_ptr<VulkanRenderTarget>> CreateBloomImages(
+    const VulkanDevice& device, VkExtent2D extent, uint32_t max_level_count) {
+  std::vector<std::unique_ptr<VulkanRenderTarget>> images;
+  for (uint32_t level = 0; level < max_level_count; ++level) {
+    VkExtent2D level_extent = BloomLevelExtent(extent, level);
+    images.push_back(std::make_unique<VulkanRenderTarget>(
+        device, level_extent, kBloomFormat, VK_IMAGE_USAGE_STORAGE_BIT));
+    if (level_extent.width == 1 && level_extent.height == 1)
+      break;
+  }
+  return images;
+}
+
+// Makes compute shader writes visible to the compute shaders that follow.
+void RecordComputeBarrier(const VulkanDeviceFunctions& functions,
+                          VkCommandBuffer command_buffer) {
+  VkMemoryBarrier barrier = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      /*dependencyFlags=*/0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+}  // namespace
+
+VulkanPostProcessor::VulkanPostProcessor(const VulkanDevice& device, VkExtent2D extent,
+                                         uint32_t max_pending_frames, uint32_t bloom_level_count)
+    : device_(device),
+      extent_(extent),
+      uses_subgroups_(SupportsSubgroupShaders(device)),
+      bloom_levels_(CreateBloomImages(device, extent, bloom_level_count)),
+      bloom_scratch_(CreateBloomImages(device, extent, bloom_level_count)),
+      luminance_buffer_(device, sizeof(uint32_t),
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+      luminance_pipeline_(device, ReadPostProcessingShader("post_luminance", uses_subgroups_),
+                          {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+                          /*push_constant_size=*/0, max_pending_frames),
+      downsample_pipeline_(device, ReadSpirvFile("post_downsample.spv"),
+                           {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+                           sizeof(DownsamplePushConstants),
+                           max_pending_frames + bloom_level_count),
+      horizontal_blur_pipeline_(
+          device, ReadPostProcessingShader("post_blur", uses_subgroups_),
+          {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+          /*push_constant_size=*/0, bloom_level_count, &kHorizontalBlurSpecialization),
+      vertical_blur_pipeline_(
+          device, ReadPostProcessingShader("post_blur", uses_subgroups_),
+          {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+          /*push_constant_size=*/0, bloom_level_count, &kVerticalBlurSpecialization),
+      upsample_pipeline_(device, ReadSpirvFile("post_upsample.spv"),
+                         {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+                         /*push_constant_size=*/0, bloom_level_count),
+      tonemap_pipeline_(device, ReadPostProcessingShader("post_tonemap", uses_subgroups_),
+                        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                         VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+                        sizeof(TonemapPushConstants), max_pending_frames) {
+  assert(extent.width > 0 && extent.height > 0);
+  assert(max_pending_frames > 0);
+  assert(bloom_level_count > 0);
+
+  // The luminance tiles' sum must fit in 32 bits.
+  uint32_t tile_count = DivideRoundingUp(extent.width, kLuminanceTileSize) *
+                        DivideRoundingUp(extent.height, kLuminanceTileSize);
+  assert(tile_count <= std::numeric_limits<uint32_t>::max() / kLuminanceTileScale);
+  (void)tile_count;
+
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, luminance_buffer_.VulkanHandle(),
+                    "Post-processing luminance");
+
+  // The sets that point to the frame's source and target are bound by Record().
+  frame_descriptor_sets_.reserve(max_pending_frames);
+  for (uint32_t i = 0; i < max_pending_frames; ++i) {
+    FrameDescriptorSets descriptor_sets = {
+      .luminance = luminance_pipeline_.AllocateDescriptorSet(),
+      .downsample = downsample_pipeline_.AllocateDescriptorSet(),
+      .tonemap = tonemap_pipeline_.AllocateDescriptorSet(),
+    };
+    luminance_pipeline_.BindBuffer(descriptor_sets.luminance, /*binding=*/1,
+                                   luminance_buffer_.VulkanHandle());
+    downsample_pipeline_.BindImage(descriptor_sets.downsample, /*binding=*/1,
+                                   bloom_levels_[0]->ViewVulkanHandle(),
+                                   VK_IMAGE_LAYOUT_GENERAL);
+    tonemap_pipeline_.BindImage(descriptor_sets.tonemap, /*binding=*/1,
+                                bloom_levels_[0]->ViewVulkanHandle(), VK_IMAGE_LAYOUT_GENERAL);
+    tonemap_pipeline_.BindBuffer(descriptor_sets.tonemap, /*binding=*/2,
+                                 luminance_buffer_.VulkanHandle());
+    frame_descriptor_sets_.push_back(descriptor_sets);
+  }
+
+  for (size_t level = 0; level < bloom_levels_.size(); ++level) {
+    VkImageView level_view = bloom_levels_[level]->ViewVulkanHandle();
+    VkImageView scratch_view = bloom_scratch_[level]->ViewVulkanHandle();
+
+    if (level > 0) {
+      VkDescriptorSet downsample_set = downsample_pipeline_.AllocateDescriptorSet();
+      downsample_pipeline_.BindImage(downsample_set, /*binding=*/0,
+                                     bloom_levels_[level - 1]->ViewVulkanHandle(),
+                                     VK_IMAGE_LAYOUT_GENERAL);
+      downsample_pipeline_.BindImage(downsample_set, /*binding=*/1, level_view,
+                                     VK_IMAGE_LAYOUT_GENERAL);
+      downsample_descriptor_sets_.push_back(downsample_set);
+
+      VkDescriptorSet upsample_set = upsample_pipeline_.AllocateDescriptorSet();
+      upsample_pipeline_.BindImage(upsample_set, /*binding=*/0, level_view,
+                                   VK_IMAGE_LAYOUT_GENERAL);
+      upsample_pipeline_.BindImage(upsample_set, /*binding=*/1,
+                                   bloom_levels_[level - 1]->ViewVulkanHandle(),
+                                   VK_IMAGE_LAYOUT_GENERAL);
+      upsample_descriptor_sets_.push_back(upsample_set);
+    }
+
+    VkDescriptorSet horizontal_set = horizontal_blur_pipeline_.AllocateDescriptorSet();
+    horizontal_blur_pipeline_.BindImage(horizontal_set, /*binding=*/0, level_view,
+                                        VK_IMAGE_LAYOUT_GENERAL);
+    horizontal_blur_pipeline_.BindImage(horizontal_set, /*binding=*/1, scratch_view,
+                                        VK_IMAGE_LAYOUT_GENERAL);
+    horizontal_blur_descriptor_sets_.push_back(horizontal_set);
+
+    VkDescriptorSet vertical_set = vertical_blur_pipeline_.AllocateDescriptorSet();
+    vertical_blur_pipeline_.BindImage(vertical_set, /*binding=*/0, scratch_view,
+                                      VK_IMAGE_LAYOUT_GENERAL);
+    vertical_blur_pipeline_.BindImage(vertical_set, /*binding=*/1, level_view,
+                                      VK_IMAGE_LAYOUT_GENERAL);
+    vertical_blur_descriptor_sets_.push_back(vertical_set);
+  }
+}
+
+VulkanPostProcessor::~VulkanPostProcessor() = default;
+
+void VulkanPostProcessor::Record(VkCommandBuffer command_buffer, uint32_t frame_slot,
+                                 VkImageView source, VkImageView target,
+                                 const Settings& settings) {
+  assert(frame_slot < frame_descriptor_sets_.size());
+
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VULKAN_DEBUG_LABEL_SCOPE(device_, command_buffer, "Post-processing");
+
+  // The descriptor sets are not in use, because the frame that last used
+  // them has completed.
+  const FrameDescriptorSets& frame_sets = frame_descriptor_sets_[frame_slot];
+  luminance_pipeline_.BindImage(frame_sets.luminance, /*binding=*/0, source,
+                                VK_IMAGE_LAYOUT_GENERAL);
+  downsample_pipeline_.BindImage(frame_sets.downsample, /*binding=*/0, source,
+                                 VK_IMAGE_LAYOUT_GENERAL);
+  tonemap_pipeline_.BindImage(frame_sets.tonemap, /*binding=*/0, source,
+                              VK_IMAGE_LAYOUT_GENERAL);
+  tonemap_pipeline_.BindImage(frame_sets.tonemap, /*binding=*/3, target,
+                              VK_IMAGE_LAYOUT_GENERAL);
+
+  // The intermediate images and the luminance buffer are shared by all
+  // frames. Earlier frames on the queue must be done with them. Their
+  // contents are rewritten, so the image layout transitions discard them.
+  std::vector<VkImageMemoryBarrier> image_barriers;
+  for (const auto* images : {&bloom_levels_, &bloom_scratch_}) {
+    for (const std::unique_ptr<VulkanRenderTarget>& image : *images) {
+      image_barriers.push_back(VkImageMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image->VulkanHandle(),
+        .subresourceRange = kColorSubresourceRange,
+      });
+    }
+  }
+  VkBufferMemoryBarrier luminance_barrier = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+    .pNext = nullptr,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .buffer = luminance_buffer_.VulkanHandle(),
+    .offset = 0,
+    .size = VK_WHOLE_SIZE,
+  };
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 1, &luminance_barrier,
+      static_cast<uint32_t>(image_barriers.size()), image_barriers.data());
+
+  functions.vkCmdFillBuffer(command_buffer, luminance_buffer_.VulkanHandle(), /*dstOffset=*/0,
+                            VK_WHOLE_SIZE, /*data=*/0);
+  luminance_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  luminance_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  functions.vkCmdPipelineBarrier(
+      command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      /*dependencyFlags=*/0, 0, nullptr, 1, &luminance_barrier, 0, nullptr);
+
+  // The luminance reduction and the first downsample only read the source,
+  // so they can overlap.
+  uint32_t tile_columns = DivideRoundingUp(extent_.width, kLuminanceTileSize);
+  uint32_t tile_rows = DivideRoundingUp(extent_.height, kLuminanceTileSize);
+  {
+    VULKAN_DEBUG_LABEL_SCOPE(device_, command_buffer, "Luminance");
+    luminance_pipeline_.Dispatch(command_buffer, frame_sets.luminance,
+                                 /*push_constants=*/nullptr, tile_columns, tile_rows);
+  }
+
+  {
+    VULKAN_DEBUG_LABEL_SCOPE(device_, command_buffer, "Bloom");
+    for (size_t level = 0; level < bloom_levels_.size(); ++level) {
+      VkExtent2D level_extent = bloom_levels_[level]->Extent();
+
+      DownsamplePushConstants downsample_push_constants = {
+        .threshold = (level == 0) ? settings.bloom_threshold : 0.0f,
+      };
+      if (level > 0)
+        RecordComputeBarrier(functions, command_buffer);
+      downsample_pipeline_.Dispatch(
+          command_buffer,
+          (level == 0) ? frame_sets.downsample : downsample_descriptor_sets_[level - 1],
+          &downsample_push_constants, DivideRoundingUp(level_extent.width, kImageWorkgroupSize),
+          DivideRoundingUp(level_extent.height, kImageWorkgroupSize));
+
+      // The blurs' workgroups run along the blur direction.
+      RecordComputeBarrier(functions, command_buffer);
+      horizontal_blur_pipeline_.Dispatch(
+          command_buffer, horizontal_blur_descriptor_sets_[level], /*push_constants=*/nullptr,
+          DivideRoundingUp(level_extent.width, kBlurWorkgroupSize), level_extent.height);
+      RecordComputeBarrier(functions, command_buffer);
+      vertical_blur_pipeline_.Dispatch(
+          command_buffer, vertical_blur_descriptor_sets_[level], /*push_constants=*/nullptr,
+          DivideRoundingUp(level_extent.height, kBlurWorkgroupSize), level_extent.width);
+    }
+
+    // Each level accumulates the levels below it, from the smallest up.
+    for (size_t level = bloom_levels_.size() - 1; level > 0; --level) {
+      VkExtent2D fine_extent = bloom_levels_[level - 1]->Extent();
+      RecordComputeBarrier(functions, command_buffer);
+      upsample_pipeline_.Dispatch(command_buffer, upsample_descriptor_sets_[level - 1],
+                                  /*push_constants=*/nullptr,
+                                  DivideRoundingUp(fine_extent.width, kImageWorkgroupSize),
+                                  DivideRoundingUp(fine_extent.height, kImageWorkgroupSize));
+    }
+  }
+
+  RecordComputeBarrier(functions, command_buffer);
+  {
+    VULKAN_DEBUG_LABEL_SCOPE(device_, command_buffer, "Tonemap");
+    TonemapPushConstants tonemap_push_constants = {
+      .bloom_strength = settings.bloom_strength,
+      .sharpness = settings.sharpness,
+      .exposure_key = settings.exposure_key,
+      .tile_count = tile_columns * tile_rows,
+    };
+    tonemap_pipeline_.Dispatch(command_buffer, frame_sets.tonemap, &tonemap_push_constants,
+                               DivideRoundingUp(extent_.width, kImageWorkgroupSize),
+                               DivideRoundingUp(extent_.height, kImageWorkgroupSize));
+  }
+}
@@ -0,0 +1,106 @@
+#ifndef VULKAN_POST_PROCESSOR_H_
+#define VULKAN_POST_PROCESSOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_buffer.h"
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_render_target.h"
+
+class VulkanDevice;
+
+// Post-processes HDR frames with compute shaders.
+//
+// Each frame goes through a bloom chain, which downsamples the bright parts of
+// the frame and blurs each level, then gets tonemapped to the frame's average
+// luminance, and sharpened. Compute passes write whole images without the
+// render passes and overdraw of full-screen fragment passes.
+//
+// The luminance reduction, the blurs and the sharpening use subgroup
+// operations when the device supports them in compute shaders. Shuffles
+// replace most of the image loads that neighboring pixels share.
+class VulkanPostProcessor {
+ public:
+  struct Settings {
+    // Bloom keeps the part of each pixel's brightness above this threshold.
+    float bloom_threshold = 1.0f;
+    float bloom_strength = 0.05f;
+    // 0 disables sharpening.
+    float sharpness = 0.25f;
+    // The frame's average luminance is mapped to this value.
+    float exposure_key = 0.18f;
+  };
+
+  // `device` must outlive this instance.
+  //
+  // Frames have the size `extent`. The bloom chain has up to
+  // `bloom_level_count` levels, each half the size of the previous one. Up to
+  // `max_pending_frames` frames may be in flight on the GPU.
+  explicit VulkanPostProcessor(const VulkanDevice& device, VkExtent2D extent,
+                               uint32_t max_pending_frames, uint32_t bloom_level_count = 5);
+
+  VulkanPostProcessor(const VulkanPostProcessor&) = delete;
+  VulkanPostProcessor& operator=(const VulkanPostProcessor&) = delete;
+
+  ~VulkanPostProcessor();
+
+  // True if the shaders use subgroup operations.
+  [[nodiscard]] bool UsesSubgroups() const { return uses_subgroups_; }
+
+  // Records the post-processing of the image at `source` into `target`.
+  //
+  // `source` must be a view of an R16G16B16A16_SFLOAT image created with
+  // storage usage, in the GENERAL layout, with writes to it made visible to
+  // compute shaders. `target` must be a view of an R8G8B8A8_UNORM image
+  // created with storage usage, in the GENERAL layout. This includes the
+  // images of swap chains whose VulkanSwapChain::ImageUsage() has storage
+  // usage. Otherwise, `target` can be an intermediate image that gets copied
+  // to the swap chain. Both images must have the size given at construction.
+  //
+  // `frame_slot` must be below `max_pending_frames`. The previous frame
+  // recorded with the same slot must have completed. Frames must be submitted
+  // to a single queue, in recording order.
+  void Record(VkCommandBuffer command_buffer, uint32_t frame_slot, VkImageView source,
+              VkImageView target, const Settings& settings);
+
+ private:
+  // Descriptor sets that point to the frame's source and target.
+  struct FrameDescriptorSets {
+    VkDescriptorSet luminance;
+    VkDescriptorSet downsample;
+    VkDescriptorSet tonemap;
+  };
+
+  const VulkanDevice& device_;
+  const VkExtent2D extent_;
+  const bool uses_subgroups_;
+
+  // Level 0 is half the frame's size. Each level is blurred via the scratch
+  // image of the same size.
+  std::vector<std::unique_ptr<VulkanRenderTarget>> bloom_levels_;
+  std::vector<std::unique_ptr<VulkanRenderTarget>> bloom_scratch_;
+  VulkanBuffer luminance_buffer_;
+
+  VulkanComputePipeline luminance_pipeline_;
+  VulkanComputePipeline downsample_pipeline_;
+  VulkanComputePipeline horizontal_blur_pipeline_;
+  VulkanComputePipeline vertical_blur_pipeline_;
+  VulkanComputePipeline upsample_pipeline_;
+  VulkanComputePipeline tonemap_pipeline_;
+
+  std::vector<FrameDescriptorSets> frame_descriptor_sets_;
+  // Set i downsamples level i into level i + 1. Level 0 is downsampled from
+  // the source, with a per-frame set.
+  std::vector<VkDescriptorSet> downsample_descriptor_sets_;
+  // Indexed by bloom level.
+  std::vector<VkDescriptorSet> horizontal_blur_descriptor_sets_;
+  std::vector<VkDescriptorSet> vertical_blur_descriptor_sets_;
+  // Set i adds level i + 1 to level i.
+  std::vector<VkDescriptorSet> upsample_descriptor_sets_;
+};
+
+#endif  // VULKAN_POST_PROCESSOR_H_
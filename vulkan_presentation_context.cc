@@ -2,9 +2,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <vulkan/vulkan_core.h>
@@ -42,8 +45,53 @@ struct VulkanPresentationSurface::State {
 
   // The instance associated with `surface_`. null until `surface_` is created.
   VkInstance instance = VK_NULL_HANDLE;
+
+  std::function<void(const WindowEvent&)> event_handler = nullptr;
 };
 
+namespace {
+
+// GLFW callbacks. The window's user pointer is its surface's State, which
+// does not move when the VulkanPresentationSurface is moved.
+
+void DispatchWindowEvent(GLFWwindow* window, const WindowEvent& event) {
+  auto* state = static_cast<VulkanPresentationSurface::State*>(glfwGetWindowUserPointer(window));
+  assert(state != nullptr);
+  if (state->event_handler)
+    state->event_handler(event);
+}
+
+void OnGlfwWindowClose(GLFWwindow* window) {
+  WindowEvent event;
+  event.type = WindowEvent::Type::kClose;
+  DispatchWindowEvent(window, event);
+}
+
+void OnGlfwCharacter(GLFWwindow* window, unsigned int codepoint) {
+  WindowEvent event;
+  event.type = WindowEvent::Type::kCharacter;
+  event.codepoint = static_cast<uint32_t>(codepoint);
+  DispatchWindowEvent(window, event);
+}
+
+void OnGlfwMouseButton(GLFWwindow* window, int button, int action, int /*mods*/) {
+  WindowEvent event;
+  event.type = WindowEvent::Type::kMouseButton;
+  event.button = button;
+  event.pressed = (action == GLFW_PRESS);
+  DispatchWindowEvent(window, event);
+}
+
+void OnGlfwCursorPosition(GLFWwindow* window, double x, double y) {
+  WindowEvent event;
+  event.type = WindowEvent::Type::kCursorMove;
+  event.x = x;
+  event.y = y;
+  DispatchWindowEvent(window, event);
+}
+
+}  // namespace
+
 VulkanPresentationSurface::VulkanPresentationSurface(std::unique_ptr<State> state)
     : state_(std::move(state)) {
   assert(state_ != nullptr);
@@ -58,9 +106,10 @@ VulkanPresentationSurface::~VulkanPresentationSurface() {
   if (!state_)
     return;
 
-  assert(state_->surface != VK_NULL_HANDLE);
-  assert(state_->instance != VK_NULL_HANDLE);
-  vkDestroySurfaceKHR(state_->instance, state_->surface, /*pAllocator=*/nullptr);
+  if (state_->surface != VK_NULL_HANDLE) {
+    assert(state_->instance != VK_NULL_HANDLE);
+    vkDestroySurfaceKHR(state_->instance, state_->surface, /*pAllocator=*/nullptr);
+  }
 
   assert(state_->window != nullptr);
   glfwDestroyWindow(state_->window);
@@ -82,12 +131,32 @@ VkSurfaceKHR VulkanPresentationSurface::VulkanHandle() const {
   return state_->surface;
 }
 
-void VulkanPresentationSurface::MainLoop() {
+void VulkanPresentationSurface::CreateVulkanSurface(VkInstance instance) {
+  assert(state_);
+  assert(state_->surface == VK_NULL_HANDLE);
+  assert(instance != VK_NULL_HANDLE);
+
+  VkResult result = glfwCreateWindowSurface(instance, state_->window, /*allocator=*/nullptr,
+                                            &state_->surface);
+  if (result != VK_SUCCESS) {
+    std::cerr << "glfwCreateWindowSurface() failed\n";
+    std::abort();
+  }
+  state_->instance = instance;
+}
+
+bool VulkanPresentationSurface::ShouldClose() const {
   assert(state_ != nullptr);
   assert(state_->window != nullptr);
 
-  while (!glfwWindowShouldClose(state_->window))
-    glfwPollEvents();
+  return glfwWindowShouldClose(state_->window);
+}
+
+void VulkanPresentationSurface::SetEventHandler(
+    std::function<void(const WindowEvent&)> event_handler) {
+  assert(state_ != nullptr);
+
+  state_->event_handler = std::move(event_handler);
 }
 
 VulkanPresentationContext::VulkanPresentationContext()
@@ -101,6 +170,12 @@ VulkanPresentationContext::~VulkanPresentationContext() {
 VulkanPresentationSurface VulkanPresentationContext::CreateSurface(VkInstance instance, int width, int height) {
   assert(instance != VK_NULL_HANDLE);
 
+  VulkanPresentationSurface surface = CreateSurfaceWindow(width, height);
+  surface.CreateVulkanSurface(instance);
+  return surface;
+}
+
+VulkanPresentationSurface VulkanPresentationContext::CreateSurfaceWindow(int width, int height) {
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
   glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
   GLFWwindow* window = glfwCreateWindow(width, height, "Vulkan window", /*monitor=*/nullptr,
@@ -110,14 +185,32 @@ VulkanPresentationSurface VulkanPresentationContext::CreateSurface(VkInstance in
     std::abort();
   }
 
-  VkSurfaceKHR surface = VK_NULL_HANDLE;
-  VkResult result = glfwCreateWindowSurface(instance, window, /*allocator=*/nullptr, &surface);
-  if (result != VK_SUCCESS) {
-    std::cerr << "glfwCreateWindowSurface() failed\n";
-    std::abort();
-  }
-
-  return VulkanPresentationSurface(std::make_unique<VulkanPresentationSurface::State>(
+  auto state = std::make_unique<VulkanPresentationSurface::State>(
       VulkanPresentationSurface::State{
-          .window = window, .surface = surface, .instance = instance }));
+          .window = window, .surface = VK_NULL_HANDLE, .instance = VK_NULL_HANDLE,
+          .event_handler = nullptr });
+  glfwSetWindowUserPointer(window, state.get());
+  glfwSetWindowCloseCallback(window, OnGlfwWindowClose);
+  glfwSetCharCallback(window, OnGlfwCharacter);
+  glfwSetMouseButtonCallback(window, OnGlfwMouseButton);
+  glfwSetCursorPosCallback(window, OnGlfwCursorPosition);
+
+  return VulkanPresentationSurface(std::move(state));
+}
+
+void VulkanPresentationContext::PollEvents() {
+  glfwPollEvents();
+}
+
+void VulkanPresentationContext::WaitEvents() {
+  glfwWaitEvents();
+}
+
+void VulkanPresentationContext::WaitEventsTimeout(double timeout_seconds) {
+  assert(timeout_seconds > 0);
+  glfwWaitEventsTimeout(timeout_seconds);
+}
+
+void VulkanPresentationContext::Wake() {
+  glfwPostEmptyEvent();
 }
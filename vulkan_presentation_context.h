@@ -1,11 +1,15 @@
 #ifndef VULKAN_PRESENTATION_CONTEXT_H_
 #define VULKAN_PRESENTATION_CONTEXT_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
 #include <vulkan/vulkan_core.h>
 
+#include "event_source.h"
+#include "window_event.h"
+
 // Abstract representation for a windowing system drawing surface.
 class VulkanPresentationSurface {
  public:
@@ -26,9 +30,19 @@ class VulkanPresentationSurface {
   // The surface's dimensions, in pixels.
   VkExtent2D Size() const;
 
+  // CreateVulkanSurface() must have been called on surfaces returned by
+  // VulkanPresentationContext::CreateSurfaceWindow().
   VkSurfaceKHR VulkanHandle() const;
 
-  void MainLoop();
+  // Creates the Vulkan surface for a window made by CreateSurfaceWindow().
+  void CreateVulkanSurface(VkInstance instance);
+
+  // True after the user asked to close the surface's window.
+  bool ShouldClose() const;
+
+  // Receives the input events for the surface's window, on the thread that
+  // processes the VulkanPresentationContext's events. May be null.
+  void SetEventHandler(std::function<void(const WindowEvent&)> event_handler);
 
  private:
   std::unique_ptr<State> state_;
@@ -37,12 +51,12 @@ class VulkanPresentationSurface {
 // Bridge between the windowing system and Vulkan.
 //
 // Instances must outlive all created VulkanPresentationSurface instances.
-class VulkanPresentationContext {
+class VulkanPresentationContext : public EventSource {
  public:
   VulkanPresentationContext();
   VulkanPresentationContext(const VulkanPresentationContext&) = delete;
   VulkanPresentationContext& operator=(const VulkanPresentationContext&) = delete;
-  ~VulkanPresentationContext();
+  ~VulkanPresentationContext() override;
 
   // vkCreateInstance()-friendly list of Vulkan extensions used by this class.
   [[nodiscard]] const std::vector<const char*>& RequiredVulkanInstanceExtensions() const {
@@ -60,6 +74,20 @@ class VulkanPresentationContext {
   // scope.
   [[nodiscard]] VulkanPresentationSurface CreateSurface(VkInstance instance, int width, int height);
 
+  // Creates a window without its Vulkan surface.
+  //
+  // Windows don't need a Vulkan instance, so they can be created while
+  // another thread creates the instance. The surface is created by
+  // VulkanPresentationSurface::CreateVulkanSurface().
+  [[nodiscard]] VulkanPresentationSurface CreateSurfaceWindow(int width, int height);
+
+  // EventSource implementation, covering the windowing system events for all
+  // surfaces. Except for Wake(), the methods must be called on the main thread.
+  void PollEvents() override;
+  void WaitEvents() override;
+  void WaitEventsTimeout(double timeout_seconds) override;
+  void Wake() override;
+
  private:
   const std::vector<const char*> required_instance_extensions_;
   const std::vector<const char*> required_device_extensions_;
@@ -0,0 +1,205 @@
+#include "vulkan_presenter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_command_pool.h"
+#include "vulkan_debug_utils.h"
+#include "vulkan_deletion_queue.h"
+#include "vulkan_device.h"
+#include "vulkan_swap_chain.h"
+#include "vulkan_sync.h"
+
+VulkanPresenter::VulkanPresenter(const VulkanDevice& device,
+                                 std::vector<const VulkanSwapChain*> swap_chains,
+                                 int frames_in_flight)
+    : device_(device),
+      swap_chains_(std::move(swap_chains)),
+      command_pool_(device, device.GraphicsQueueFamilyIndex(),
+                    VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+      deletion_queue_(device) {
+  assert(!swap_chains_.empty());
+  assert(frames_in_flight > 0);
+
+  std::vector<VkCommandBuffer> command_buffers =
+      command_pool_.AllocateCommandBuffers(static_cast<uint32_t>(frames_in_flight));
+
+  frames_.reserve(frames_in_flight);
+  for (int i = 0; i < frames_in_flight; ++i) {
+    Frame frame = {
+      .frame_number = 0,
+      .command_buffer = command_buffers[i],
+      .fence = CreateVulkanFence(device, VK_FENCE_CREATE_SIGNALED_BIT),
+      .image_available_semaphores = {},
+    };
+    for (size_t j = 0; j < swap_chains_.size(); ++j)
+      frame.image_available_semaphores.push_back(CreateVulkanSemaphore(device));
+
+    std::string frame_name = "Frame slot " + std::to_string(i);
+    VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_BUFFER, frame.command_buffer,
+                      (frame_name + " command buffer").c_str());
+    VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_FENCE, frame.fence, (frame_name + " fence").c_str());
+    for (size_t j = 0; j < swap_chains_.size(); ++j) {
+      VULKAN_DEBUG_NAME(
+          device, VK_OBJECT_TYPE_SEMAPHORE, frame.image_available_semaphores[j],
+          (frame_name + " image available semaphore " + std::to_string(j)).c_str());
+    }
+    frames_.push_back(std::move(frame));
+  }
+
+  render_finished_semaphores_.reserve(swap_chains_.size());
+  for (size_t i = 0; i < swap_chains_.size(); ++i) {
+    std::vector<VkSemaphore> semaphores;
+    for (size_t j = 0; j < swap_chains_[i]->Images().size(); ++j) {
+      semaphores.push_back(CreateVulkanSemaphore(device));
+      VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_SEMAPHORE, semaphores.back(),
+                        ("Swap chain " + std::to_string(i) + " render finished semaphore " +
+                         std::to_string(j)).c_str());
+    }
+    render_finished_semaphores_.push_back(std::move(semaphores));
+  }
+}
+
+VulkanPresenter::~VulkanPresenter() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  // The presentation engine may still be waiting on semaphores, and
+  // presentation has no fence to wait on.
+  functions.vkDeviceWaitIdle(device);
+
+  for (const Frame& frame : frames_) {
+    functions.vkDestroyFence(device, frame.fence, /*pAllocator=*/nullptr);
+    for (VkSemaphore semaphore : frame.image_available_semaphores)
+      functions.vkDestroySemaphore(device, semaphore, /*pAllocator=*/nullptr);
+  }
+  for (const std::vector<VkSemaphore>& semaphores : render_finished_semaphores_) {
+    for (VkSemaphore semaphore : semaphores)
+      functions.vkDestroySemaphore(device, semaphore, /*pAllocator=*/nullptr);
+  }
+}
+
+void VulkanPresenter::RenderFrame(
+    const std::function<void(VkCommandBuffer, const std::vector<FrameImage>&)>& record) {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  Frame& frame = frames_[next_frame_];
+  next_frame_ = (next_frame_ + 1) % frames_.size();
+
+  // The command buffer and the image available semaphores are reused.
+  WaitForVulkanFence(device_, frame.fence);
+
+  // Frames are submitted to one queue, so they finish in order.
+  retired_frame_number_ = std::max(retired_frame_number_, frame.frame_number);
+  deletion_queue_.Collect(retired_frame_number_);
+  frame.frame_number = frame_number_;
+
+  size_t swap_chain_count = swap_chains_.size();
+  std::vector<FrameImage> images;
+  images.reserve(swap_chain_count);
+  std::vector<VkSwapchainKHR> swap_chain_handles;
+  swap_chain_handles.reserve(swap_chain_count);
+  std::vector<uint32_t> image_indexes;
+  image_indexes.reserve(swap_chain_count);
+  std::vector<VkSemaphore> render_finished_semaphores;
+  render_finished_semaphores.reserve(swap_chain_count);
+  for (size_t i = 0; i < swap_chain_count; ++i) {
+    const VulkanSwapChain* swap_chain = swap_chains_[i];
+    uint32_t image_index = swap_chain->AcquireNextImage(frame.image_available_semaphores[i]);
+
+    images.push_back(FrameImage{
+      .swap_chain = swap_chain,
+      .image_index = image_index,
+      .image = swap_chain->Images()[image_index],
+      .image_view = swap_chain->ImageViews()[image_index],
+    });
+    swap_chain_handles.push_back(swap_chain->VulkanHandle());
+    image_indexes.push_back(image_index);
+    render_finished_semaphores.push_back(render_finished_semaphores_[i][image_index]);
+  }
+
+  VkCommandBufferBeginInfo begin_info = {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .pNext = nullptr,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    .pInheritanceInfo = nullptr,
+  };
+  VkResult result = functions.vkBeginCommandBuffer(frame.command_buffer, &begin_info);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkBeginCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  {
+    VULKAN_DEBUG_LABEL_SCOPE(device_, frame.command_buffer, "Frame");
+    record(frame.command_buffer, images);
+  }
+
+  result = functions.vkEndCommandBuffer(frame.command_buffer);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkEndCommandBuffer() failed" << std::endl;
+    std::abort();
+  }
+
+  result = functions.vkResetFences(device_.VulkanHandle(), 1, &frame.fence);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkResetFences() failed" << std::endl;
+    std::abort();
+  }
+
+  std::vector<VkPipelineStageFlags> wait_stages(
+      swap_chain_count,
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT);
+  VkSubmitInfo submit_info = {
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .pNext = nullptr,
+    .waitSemaphoreCount = static_cast<uint32_t>(swap_chain_count),
+    .pWaitSemaphores = frame.image_available_semaphores.data(),
+    .pWaitDstStageMask = wait_stages.data(),
+    .commandBufferCount = 1,
+    .pCommandBuffers = &frame.command_buffer,
+    .signalSemaphoreCount = static_cast<uint32_t>(swap_chain_count),
+    .pSignalSemaphores = render_finished_semaphores.data(),
+  };
+  result = functions.vkQueueSubmit(device_.GraphicsQueue(), 1, &submit_info, frame.fence);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkQueueSubmit() failed" << std::endl;
+    std::abort();
+  }
+
+  std::vector<VkResult> present_results(swap_chain_count, VK_SUCCESS);
+  VkPresentInfoKHR present_info = {
+    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+    .pNext = nullptr,
+    .waitSemaphoreCount = static_cast<uint32_t>(swap_chain_count),
+    .pWaitSemaphores = render_finished_semaphores.data(),
+    .swapchainCount = static_cast<uint32_t>(swap_chain_count),
+    .pSwapchains = swap_chain_handles.data(),
+    .pImageIndices = image_indexes.data(),
+    .pResults = present_results.data(),
+  };
+  result = functions.vkQueuePresentKHR(device_.PresentationQueue(), &present_info);
+  // A suboptimal swap chain still presents. Swap chains will be recreated when
+  // surfaces become resizable.
+  if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+    std::cerr << "vkQueuePresentKHR() failed" << std::endl;
+    std::abort();
+  }
+  for (VkResult present_result : present_results) {
+    if (present_result != VK_SUCCESS && present_result != VK_SUBOPTIMAL_KHR) {
+      std::cerr << "vkQueuePresentKHR() failed on a swap chain" << std::endl;
+      std::abort();
+    }
+  }
+
+  ++frame_number_;
+}
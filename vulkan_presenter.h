@@ -0,0 +1,102 @@
+#ifndef VULKAN_PRESENTER_H_
+#define VULKAN_PRESENTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_command_pool.h"
+#include "vulkan_deletion_queue.h"
+
+class VulkanDevice;
+class VulkanSwapChain;
+
+// Renders frames to several swap chains on one device.
+//
+// Each frame acquires an image from every swap chain, records the work for all
+// of them into one command buffer, submits it with one vkQueueSubmit(), and
+// presents all the images with one vkQueuePresentKHR().
+class VulkanPresenter {
+ public:
+  // An image acquired from a swap chain for the current frame.
+  struct FrameImage {
+    const VulkanSwapChain* swap_chain;
+    uint32_t image_index;
+    VkImage image;
+    VkImageView image_view;
+  };
+
+  // `device` and `swap_chains` must outlive this instance.
+  //
+  // Up to `frames_in_flight` frames are rendered concurrently by the GPU.
+  explicit VulkanPresenter(const VulkanDevice& device,
+                           std::vector<const VulkanSwapChain*> swap_chains,
+                           int frames_in_flight = 2);
+
+  VulkanPresenter(const VulkanPresenter&) = delete;
+  VulkanPresenter& operator=(const VulkanPresenter&) = delete;
+
+  // Blocks until the GPU finishes rendering all the frames.
+  ~VulkanPresenter();
+
+  // Renders one frame on every swap chain, and queues it for presentation.
+  //
+  // `record` receives a command buffer in the recording state, and the images
+  // acquired for the frame, in swap chain order. Each image starts out in an
+  // undefined layout, and is available to the
+  // VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT and
+  // VK_PIPELINE_STAGE_TRANSFER_BIT stages. `record` must leave each image in
+  // the VK_IMAGE_LAYOUT_PRESENT_SRC_KHR layout.
+  //
+  // Blocks if the GPU is still rendering the frame that used the same
+  // resources, `frames_in_flight` frames ago.
+  void RenderFrame(
+      const std::function<void(VkCommandBuffer, const std::vector<FrameImage>&)>& record);
+
+  // The number of the frame being recorded by RenderFrame(), or of the next
+  // frame outside of RenderFrame().
+  //
+  // Frames are numbered from 1. Resources used while recording a frame
+  // should be queued for destruction with this number.
+  [[nodiscard]] uint64_t FrameNumber() const { return frame_number_; }
+
+  // The highest frame number that the GPU is known to have finished.
+  [[nodiscard]] uint64_t RetiredFrameNumber() const { return retired_frame_number_; }
+
+  // Objects queued here are destroyed by RenderFrame() once the GPU finishes
+  // the frames that use them.
+  [[nodiscard]] VulkanDeletionQueue& DeletionQueue() { return deletion_queue_; }
+
+ private:
+  struct Frame {
+    // The frame last rendered with these resources, or 0.
+    uint64_t frame_number;
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    // One per swap chain.
+    std::vector<VkSemaphore> image_available_semaphores;
+  };
+
+  const VulkanDevice& device_;
+  const std::vector<const VulkanSwapChain*> swap_chains_;
+
+  VulkanCommandPool command_pool_;
+  std::vector<Frame> frames_;
+  size_t next_frame_ = 0;
+  uint64_t frame_number_ = 1;
+  uint64_t retired_frame_number_ = 0;
+
+  // Indexed by swap chain, then by image. A semaphore signaled for an image
+  // can be reused once the image is acquired again, because the presentation
+  // engine is done waiting on it by then.
+  std::vector<std::vector<VkSemaphore>> render_finished_semaphores_;
+
+  // Declared last, so it is destroyed first, after the destructor waits for
+  // the device to go idle.
+  VulkanDeletionQueue deletion_queue_;
+};
+
+#endif  // VULKAN_PRESENTER_H_
@@ -0,0 +1,200 @@
+#include "vulkan_render_target.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+
+namespace {
+
+// Opaque file descriptors can be imported by Vulkan devices that have the
+// same device and driver UUIDs.
+constexpr VkExternalMemoryHandleTypeFlagBits kExternalMemoryHandleType =
+    VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+[[nodiscard]] VkImage CreateImage(const VulkanDevice& device, VkExtent2D extent, VkFormat format,
+                                  VkImageUsageFlags usage, bool external) {
+  VkExternalMemoryImageCreateInfo external_info = {
+    .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+    .pNext = nullptr,
+    .handleTypes = kExternalMemoryHandleType,
+  };
+
+  VkImageCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .pNext = external ? &external_info : nullptr,
+    .flags = 0,
+    .imageType = VK_IMAGE_TYPE_2D,
+    .format = format,
+    .extent = VkExtent3D{.width = extent.width, .height = extent.height, .depth = 1},
+    .mipLevels = 1,
+    .arrayLayers = 1,
+    .samples = VK_SAMPLE_COUNT_1_BIT,
+    .tiling = VK_IMAGE_TILING_OPTIMAL,
+    .usage = usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = 0,
+    .pQueueFamilyIndices = nullptr,
+    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+
+  VkImage image = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateImage(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &image);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateImage() failed" << std::endl;
+    std::abort();
+  }
+  return image;
+}
+
+[[nodiscard]] VulkanDevice::MemoryAllocation AllocateImageMemory(
+    const VulkanDevice& device, VkImage image, bool exportable,
+    const VulkanRenderTarget::ImportedMemory* imported_memory) {
+  const VulkanDeviceFunctions& functions = device.Functions();
+
+  VkMemoryRequirements requirements;
+  functions.vkGetImageMemoryRequirements(device.VulkanHandle(), image, &requirements);
+
+  // Shared images get dedicated allocations, so the exporter and the importer
+  // agree on the allocation's size and contents.
+  VkMemoryDedicatedAllocateInfo dedicated_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+    .pNext = nullptr,
+    .image = image,
+    .buffer = VK_NULL_HANDLE,
+  };
+  VkExportMemoryAllocateInfo export_info = {
+    .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+    .pNext = &dedicated_info,
+    .handleTypes = kExternalMemoryHandleType,
+  };
+  VkImportMemoryFdInfoKHR import_info = {
+    .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+    .pNext = &dedicated_info,
+    .handleType = kExternalMemoryHandleType,
+    .fd = -1,
+  };
+
+  const void* allocate_next = nullptr;
+  if (exportable) {
+    allocate_next = &export_info;
+  } else if (imported_memory != nullptr) {
+    assert(imported_memory->fd >= 0);
+    assert(imported_memory->size >= requirements.size);
+    import_info.fd = imported_memory->fd;
+    requirements.size = imported_memory->size;
+    allocate_next = &import_info;
+  }
+
+  VulkanDevice::MemoryAllocation allocation = device.AllocateMemory(
+      requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, /*preferred_properties=*/0,
+      allocate_next);
+
+  VkResult result = functions.vkBindImageMemory(
+      device.VulkanHandle(), image, allocation.memory, /*memoryOffset=*/0);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkBindImageMemory() failed" << std::endl;
+    std::abort();
+  }
+  return allocation;
+}
+
+[[nodiscard]] VkImageView CreateImageView(const VulkanDevice& device, VkImage image,
+                                          VkFormat format) {
+  VkImageViewCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .image = image,
+    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+    .format = format,
+    .components = VkComponentMapping{
+      .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+      .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+      .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+      .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+    },
+    .subresourceRange = VkImageSubresourceRange{
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = 1,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+    },
+  };
+
+  VkImageView image_view = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateImageView(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &image_view);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateImageView() failed" << std::endl;
+    std::abort();
+  }
+  return image_view;
+}
+
+}  // namespace
+
+VulkanRenderTarget::VulkanRenderTarget(const VulkanDevice& device, VkExtent2D extent,
+                                       VkFormat format, VkImageUsageFlags usage, bool exportable)
+    : VulkanRenderTarget(device, extent, format, usage, exportable,
+                         /*imported_memory=*/nullptr) {
+}
+
+VulkanRenderTarget::VulkanRenderTarget(const VulkanDevice& device, VkExtent2D extent,
+                                       VkFormat format, VkImageUsageFlags usage,
+                                       const ImportedMemory& memory)
+    : VulkanRenderTarget(device, extent, format, usage, /*exportable=*/false, &memory) {
+}
+
+VulkanRenderTarget::VulkanRenderTarget(const VulkanDevice& device, VkExtent2D extent,
+                                       VkFormat format, VkImageUsageFlags usage, bool exportable,
+                                       const ImportedMemory* imported_memory)
+    : device_(device),
+      extent_(extent),
+      format_(format),
+      exportable_(exportable),
+      image_(CreateImage(device, extent, format, usage,
+                         /*external=*/exportable || imported_memory != nullptr)),
+      allocation_(AllocateImageMemory(device, image_, exportable, imported_memory)),
+      image_view_(CreateImageView(device, image_, format)) {
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE, image_, "Render target");
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE_VIEW, image_view_, "Render target view");
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_DEVICE_MEMORY, allocation_.memory,
+                    "Render target memory");
+}
+
+VulkanRenderTarget::~VulkanRenderTarget() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  functions.vkDestroyImageView(device, image_view_, /*pAllocator=*/nullptr);
+  functions.vkDestroyImage(device, image_, /*pAllocator=*/nullptr);
+  device_.FreeMemory(allocation_);
+}
+
+int VulkanRenderTarget::ExportMemoryFd() const {
+  assert(exportable_);
+  assert(device_.Functions().vkGetMemoryFdKHR != nullptr);
+
+  VkMemoryGetFdInfoKHR get_fd_info = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+    .pNext = nullptr,
+    .memory = allocation_.memory,
+    .handleType = kExternalMemoryHandleType,
+  };
+
+  int fd = -1;
+  VkResult result = device_.Functions().vkGetMemoryFdKHR(
+      device_.VulkanHandle(), &get_fd_info, &fd);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkGetMemoryFdKHR() failed" << std::endl;
+    std::abort();
+  }
+  return fd;
+}
@@ -0,0 +1,77 @@
+#ifndef VULKAN_RENDER_TARGET_H_
+#define VULKAN_RENDER_TARGET_H_
+
+#include <cassert>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+// An offscreen 2D color image, with its own memory and a view.
+//
+// The memory can be shared with another process on the same machine, which
+// avoids copying rendered frames through host memory.
+class VulkanRenderTarget {
+ public:
+  // Memory exported by another process with ExportMemoryFd().
+  struct ImportedMemory {
+    int fd;
+    VkDeviceSize size;
+  };
+
+  // `device` must outlive this instance.
+  //
+  // If `exportable` is true, the memory can be exported with ExportMemoryFd().
+  // This requires the VK_KHR_external_memory_fd device extension.
+  explicit VulkanRenderTarget(const VulkanDevice& device, VkExtent2D extent, VkFormat format,
+                              VkImageUsageFlags usage, bool exportable = false);
+
+  // Creates a target that uses memory exported by another process.
+  //
+  // Takes ownership of `memory.fd`. `extent`, `format` and `usage` must match
+  // the exported target, and the exporting device must have the same identity
+  // as `device`. This requires the VK_KHR_external_memory_fd device extension.
+  explicit VulkanRenderTarget(const VulkanDevice& device, VkExtent2D extent, VkFormat format,
+                              VkImageUsageFlags usage, const ImportedMemory& memory);
+
+  VulkanRenderTarget(const VulkanRenderTarget&) = delete;
+  VulkanRenderTarget& operator=(const VulkanRenderTarget&) = delete;
+
+  ~VulkanRenderTarget();
+
+  [[nodiscard]] VkImage VulkanHandle() const {
+    assert(image_ != VK_NULL_HANDLE);
+    return image_;
+  }
+  [[nodiscard]] VkImageView ViewVulkanHandle() const {
+    assert(image_view_ != VK_NULL_HANDLE);
+    return image_view_;
+  }
+
+  [[nodiscard]] VkExtent2D Extent() const { return extent_; }
+  [[nodiscard]] VkFormat Format() const { return format_; }
+
+  // The size of the image's memory, which importers must know.
+  [[nodiscard]] VkDeviceSize MemorySize() const { return allocation_.size; }
+
+  // Returns an opaque file descriptor that refers to the image's memory.
+  //
+  // The caller owns the returned file descriptor. Only valid on exportable
+  // targets.
+  [[nodiscard]] int ExportMemoryFd() const;
+
+ private:
+  explicit VulkanRenderTarget(const VulkanDevice& device, VkExtent2D extent, VkFormat format,
+                              VkImageUsageFlags usage, bool exportable,
+                              const ImportedMemory* imported_memory);
+
+  const VulkanDevice& device_;
+  const VkExtent2D extent_;
+  const VkFormat format_;
+  const bool exportable_;
+  const VkImage image_;
+  const VulkanDevice::MemoryAllocation allocation_;
+  const VkImageView image_view_;
+};
+
+#endif  // VULKAN_RENDER_TARGET_H_
@@ -0,0 +1,68 @@
+#include "vulkan_shader_module.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+namespace {
+
+[[nodiscard]] VkShaderModule CreateShaderModule(const VulkanDevice& device,
+                                                const std::vector<uint32_t>& spirv) {
+  VkShaderModuleCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .codeSize = spirv.size() * sizeof(uint32_t),
+    .pCode = spirv.data(),
+  };
+
+  VkShaderModule shader_module = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateShaderModule(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &shader_module);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateShaderModule() failed" << std::endl;
+    std::abort();
+  }
+  return shader_module;
+}
+
+}  // namespace
+
+std::vector<uint32_t> ReadSpirvFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    std::cerr << "Failed to open SPIR-V module " << path << std::endl;
+    std::abort();
+  }
+
+  std::streamsize size = file.tellg();
+  if (size <= 0 || size % sizeof(uint32_t) != 0) {
+    std::cerr << "Invalid SPIR-V module size in " << path << std::endl;
+    std::abort();
+  }
+
+  std::vector<uint32_t> spirv(static_cast<size_t>(size) / sizeof(uint32_t));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char*>(spirv.data()), size)) {
+    std::cerr << "Failed to read SPIR-V module " << path << std::endl;
+    std::abort();
+  }
+  return spirv;
+}
+
+VulkanShaderModule::VulkanShaderModule(const VulkanDevice& device,
+                                       const std::vector<uint32_t>& spirv)
+    : device_(device), shader_module_(CreateShaderModule(device, spirv)) {
+}
+
+VulkanShaderModule::~VulkanShaderModule() {
+  device_.Functions().vkDestroyShaderModule(
+      device_.VulkanHandle(), shader_module_, /*pAllocator=*/nullptr);
+}
@@ -0,0 +1,36 @@
+#ifndef VULKAN_SHADER_MODULE_H_
+#define VULKAN_SHADER_MODULE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+
+// Reads a SPIR-V module produced by the spirv_shader() build rule.
+[[nodiscard]] std::vector<uint32_t> ReadSpirvFile(const std::string& path);
+
+class VulkanShaderModule {
+ public:
+  // `device` must outlive this instance.
+  explicit VulkanShaderModule(const VulkanDevice& device, const std::vector<uint32_t>& spirv);
+
+  VulkanShaderModule(const VulkanShaderModule&) = delete;
+  VulkanShaderModule& operator=(const VulkanShaderModule&) = delete;
+
+  ~VulkanShaderModule();
+
+  [[nodiscard]] VkShaderModule VulkanHandle() const {
+    assert(shader_module_ != VK_NULL_HANDLE);
+    return shader_module_;
+  }
+
+ private:
+  const VulkanDevice& device_;
+  const VkShaderModule shader_module_;
+};
+
+#endif  // VULKAN_SHADER_MODULE_H_
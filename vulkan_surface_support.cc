@@ -4,6 +4,10 @@
 #include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include <vulkan/vulkan_core.h>
@@ -182,17 +186,56 @@ int VulkanSurfaceSupport::BestImageCount() const {
   return static_cast<int>(image_count);
 }
 
+VkImageUsageFlags VulkanSurfaceSupport::SupportedImageUsage() const {
+  assert(IsAcceptable());
+  return capabilities_.supportedUsageFlags;
+}
+
 VulkanSurfaceSupport::Queues VulkanSurfaceSupport::QueueFamilyIndexes() const {
   assert(IsAcceptable());
-  assert(!graphics_queue_family_indexes_.empty());
-  assert(!presentation_queue_family_indexes_.empty());
+
+  std::optional<Queues> queues = CommonQueueFamilyIndexes({this});
+  assert(queues.has_value());
+  return *queues;
+}
+
+bool VulkanSurfaceSupport::CanPresentFrom(uint32_t queue_family_index) const {
+  return presentation_queue_family_indexes_.count(queue_family_index) != 0;
+}
+
+// static
+std::optional<VulkanSurfaceSupport::Queues> VulkanSurfaceSupport::CommonQueueFamilyIndexes(
+    const std::vector<const VulkanSurfaceSupport*>& surface_supports) {
+  assert(!surface_supports.empty());
+
+  // All the surfaces are on the same device, so they share the graphics queue families.
+  const std::set<uint32_t>& graphics_queue_family_indexes =
+      surface_supports.front()->graphics_queue_family_indexes_;
+  assert(!graphics_queue_family_indexes.empty());
+
+  std::set<uint32_t> presentation_queue_family_indexes =
+      surface_supports.front()->presentation_queue_family_indexes_;
+  for (const VulkanSurfaceSupport* surface_support : surface_supports) {
+    assert(surface_support->IsAcceptable());
+    assert(surface_support->graphics_queue_family_indexes_ == graphics_queue_family_indexes);
+
+    std::set<uint32_t> common_indexes;
+    std::set_intersection(presentation_queue_family_indexes.begin(),
+                          presentation_queue_family_indexes.end(),
+                          surface_support->presentation_queue_family_indexes_.begin(),
+                          surface_support->presentation_queue_family_indexes_.end(),
+                          std::inserter(common_indexes, common_indexes.end()));
+    presentation_queue_family_indexes = std::move(common_indexes);
+  }
+  if (presentation_queue_family_indexes.empty())
+    return std::nullopt;
 
   // Prefer to use the same queue family for graphics and presentation commands.
   //
   // This avoids having to share images across queues.
-  for (uint32_t graphics_queue_family_index : graphics_queue_family_indexes_) {
-    if (presentation_queue_family_indexes_.count(graphics_queue_family_index)) {
-      return {
+  for (uint32_t graphics_queue_family_index : graphics_queue_family_indexes) {
+    if (presentation_queue_family_indexes.count(graphics_queue_family_index)) {
+      return Queues{
         .graphics_queue_family_index = graphics_queue_family_index,
         .presentation_queue_family_index = graphics_queue_family_index,
       };
@@ -201,8 +244,8 @@ VulkanSurfaceSupport::Queues VulkanSurfaceSupport::QueueFamilyIndexes() const {
 
   // No queue family supports both graphics commands and presentation commands
   // for the given device. Fall back to the first queue family in each category.
-  return {
-    .graphics_queue_family_index = *graphics_queue_family_indexes_.begin(),
-    .presentation_queue_family_index = *graphics_queue_family_indexes_.begin(),
+  return Queues{
+    .graphics_queue_family_index = *graphics_queue_family_indexes.begin(),
+    .presentation_queue_family_index = *presentation_queue_family_indexes.begin(),
   };
 }
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -26,6 +27,13 @@ class VulkanSurfaceSupport {
   VulkanSurfaceSupport& operator=(const VulkanSurfaceSupport&) = delete;
   ~VulkanSurfaceSupport();
 
+  // Queue families that can render to and present on all the given surfaces.
+  //
+  // All the surfaces must be acceptable on the same physical device. Returns
+  // nullopt if no queue family can present on all the surfaces.
+  [[nodiscard]] static std::optional<Queues> CommonQueueFamilyIndexes(
+      const std::vector<const VulkanSurfaceSupport*>& surface_supports);
+
   [[nodiscard]] bool IsAcceptable() const;
 
   // Must only be called if IsAcceptable() returns true.
@@ -34,7 +42,9 @@ class VulkanSurfaceSupport {
   [[nodiscard]] VkPresentModeKHR BestMode() const;
   [[nodiscard]] VkExtent2D BestExtentFor(VkExtent2D surface_size) const;
   [[nodiscard]] int BestImageCount() const;
+  [[nodiscard]] VkImageUsageFlags SupportedImageUsage() const;
   [[nodiscard]] Queues QueueFamilyIndexes() const;
+  [[nodiscard]] bool CanPresentFrom(uint32_t queue_family_index) const;
 
 #if !defined(NDEBUG)
   VkPhysicalDevice PhysicalDeviceVulkanHandle() const {
@@ -0,0 +1,205 @@
+#include "vulkan_swap_chain.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_debug_utils.h"
+#include "vulkan_device.h"
+#include "vulkan_physical_device.h"
+#include "vulkan_presentation_context.h"
+#include "vulkan_surface_support.h"
+
+namespace {
+
+[[nodiscard]] VkImageUsageFlags SwapChainImageUsage(const VulkanSurfaceSupport& surface_support) {
+  VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+  // Lets images be cleared without a render pass.
+  if (surface_support.SupportedImageUsage() & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+    usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+  // Lets compute shaders, such as VulkanPostProcessor's, write images
+  // directly. sRGB formats can't be used for storage images.
+  if ((surface_support.SupportedImageUsage() & VK_IMAGE_USAGE_STORAGE_BIT) &&
+      surface_support.BestFormat().format == VK_FORMAT_R8G8B8A8_UNORM) {
+    usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+  }
+
+  return usage;
+}
+
+[[nodiscard]] VkSwapchainKHR CreateSwapChain(
+    const VulkanDevice& device, const VulkanSurfaceSupport& surface_support,
+    const VulkanPresentationSurface& surface, VkSurfaceFormatKHR surface_format,
+    VkExtent2D image_extent, VkPresentModeKHR present_mode, VkImageUsageFlags image_usage) {
+  assert(surface.VulkanHandle() == surface_support.SurfaceVulkanHandle());
+  assert(surface_support.IsAcceptable());
+  assert(surface_support.CanPresentFrom(device.PresentationQueueFamilyIndex()));
+
+  bool is_unified_queue =
+      (device.GraphicsQueueFamilyIndex() == device.PresentationQueueFamilyIndex());
+  const uint32_t queue_family_indexes[] = {
+    device.GraphicsQueueFamilyIndex(),
+    device.PresentationQueueFamilyIndex(),
+  };
+
+  VkSwapchainCreateInfoKHR create_info = {
+    .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+    .pNext = nullptr,
+    .flags = 0,
+    .surface = surface.VulkanHandle(),
+    .minImageCount = static_cast<uint32_t>(surface_support.BestImageCount()),
+    .imageFormat = surface_format.format,
+    .imageColorSpace = surface_format.colorSpace,
+    .imageExtent = image_extent,
+    .imageArrayLayers = 1,
+    .imageUsage = image_usage,
+    .imageSharingMode = is_unified_queue ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT,
+    .queueFamilyIndexCount = static_cast<uint32_t>(is_unified_queue ? 0 : 2),
+    .pQueueFamilyIndices = is_unified_queue ? nullptr : queue_family_indexes,
+    .preTransform = surface_support.CurrentTransform(),
+    .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+    .presentMode = present_mode,
+    .clipped = VK_TRUE,
+    .oldSwapchain = VK_NULL_HANDLE,  // TODO(pwnall): Change when recreating.
+  };
+
+  VkSwapchainKHR swap_chain = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateSwapchainKHR(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &swap_chain);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateSwapchainKHR() failed" << std::endl;
+    std::abort();
+  }
+  return swap_chain;
+}
+
+[[nodiscard]] std::vector<VkImage> GetSwapChainImages(const VulkanDevice& device,
+                                                      VkSwapchainKHR swap_chain) {
+  assert(swap_chain != VK_NULL_HANDLE);
+
+  uint32_t count = 0;
+  VkResult result = device.Functions().vkGetSwapchainImagesKHR(
+      device.VulkanHandle(), swap_chain, &count, /*pSwapchainImages=*/nullptr);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkGetSwapchainImagesKHR() failed to return count" << std::endl;
+    std::abort();
+  }
+
+  std::vector<VkImage> swap_chain_images(count);
+  result = device.Functions().vkGetSwapchainImagesKHR(
+      device.VulkanHandle(), swap_chain, &count, swap_chain_images.data());
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkGetSwapchainImagesKHR() failed to return list" << std::endl;
+    std::abort();
+  }
+
+  return swap_chain_images;
+}
+
+[[nodiscard]] VkImageView CreateImageView(const VulkanDevice& device, VkFormat image_format,
+                                          VkImage image) {
+  VkImageViewCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .image = image,
+    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+    .format = image_format,
+    .components = VkComponentMapping{
+      .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+      .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+      .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+      .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+    },
+    .subresourceRange = VkImageSubresourceRange{
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = 1,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+    },
+  };
+
+  VkImageView image_view = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateImageView(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &image_view);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateImageView() failed" << std::endl;
+    std::abort();
+  }
+  return image_view;
+}
+
+[[nodiscard]] std::vector<VkImageView> CreateImageViews(
+    const VulkanDevice& device, VkFormat image_format, const std::vector<VkImage>& images) {
+  std::vector<VkImageView> image_views;
+  image_views.reserve(images.size());
+
+  for (VkImage image : images)
+    image_views.push_back(CreateImageView(device, image_format, image));
+  return image_views;
+}
+
+}  // namespace
+
+VulkanSwapChain::VulkanSwapChain(const VulkanDevice& device,
+                                 const VulkanPresentationSurface& surface)
+    : VulkanSwapChain(
+          device, surface,
+          VulkanSurfaceSupport(VulkanPhysicalDevice(device.PhysicalDeviceVulkanHandle()),
+                               surface.VulkanHandle())) {
+}
+
+VulkanSwapChain::VulkanSwapChain(const VulkanDevice& device,
+                                 const VulkanPresentationSurface& surface,
+                                 const VulkanSurfaceSupport& surface_support)
+    : device_(device),
+      format_(surface_support.BestFormat()),
+      extent_(surface_support.BestExtentFor(surface.Size())),
+      present_mode_(surface_support.BestMode()),
+      image_usage_(SwapChainImageUsage(surface_support)),
+      swap_chain_(CreateSwapChain(device, surface_support, surface, format_, extent_,
+                                  present_mode_, image_usage_)),
+      images_(GetSwapChainImages(device, swap_chain_)),
+      image_views_(CreateImageViews(device, format_.format, images_)) {
+  VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_SWAPCHAIN_KHR, swap_chain_, "Swap chain");
+  for (size_t i = 0; i < images_.size(); ++i) {
+    VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE, images_[i],
+                      ("Swap chain image " + std::to_string(i)).c_str());
+    VULKAN_DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE_VIEW, image_views_[i],
+                      ("Swap chain image view " + std::to_string(i)).c_str());
+  }
+}
+
+VulkanSwapChain::~VulkanSwapChain() {
+  const VulkanDeviceFunctions& functions = device_.Functions();
+  VkDevice device = device_.VulkanHandle();
+
+  for (VkImageView image_view : image_views_)
+    functions.vkDestroyImageView(device, image_view, /*pAllocator=*/nullptr);
+  functions.vkDestroySwapchainKHR(device, swap_chain_, /*pAllocator=*/nullptr);
+}
+
+uint32_t VulkanSwapChain::AcquireNextImage(VkSemaphore semaphore) const {
+  assert(semaphore != VK_NULL_HANDLE);
+
+  uint32_t image_index = 0;
+  VkResult result = device_.Functions().vkAcquireNextImageKHR(
+      device_.VulkanHandle(), swap_chain_, /*timeout=*/UINT64_MAX, semaphore,
+      /*fence=*/VK_NULL_HANDLE, &image_index);
+  // A suboptimal swap chain can still present. It will be recreated when
+  // surfaces become resizable.
+  if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+    std::cerr << "vkAcquireNextImageKHR() failed" << std::endl;
+    std::abort();
+  }
+  return image_index;
+}
@@ -0,0 +1,68 @@
+#ifndef VULKAN_SWAP_CHAIN_H_
+#define VULKAN_SWAP_CHAIN_H_
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+class VulkanPresentationSurface;
+class VulkanSurfaceSupport;
+
+// The images presented on one surface.
+//
+// A VulkanDevice can drive any number of swap chains, one per surface.
+class VulkanSwapChain {
+ public:
+  // `device` and `surface` must outlive this instance.
+  //
+  // The device's presentation queue must be able to present on `surface`.
+  explicit VulkanSwapChain(const VulkanDevice& device, const VulkanPresentationSurface& surface);
+
+  VulkanSwapChain(const VulkanSwapChain&) = delete;
+  VulkanSwapChain& operator=(const VulkanSwapChain&) = delete;
+
+  ~VulkanSwapChain();
+
+  [[nodiscard]] VkSwapchainKHR VulkanHandle() const {
+    assert(swap_chain_ != VK_NULL_HANDLE);
+    return swap_chain_;
+  }
+
+  [[nodiscard]] VkExtent2D Extent() const { return extent_; }
+  [[nodiscard]] VkFormat Format() const { return format_.format; }
+  [[nodiscard]] VkPresentModeKHR PresentMode() const { return present_mode_; }
+
+  // Always includes VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT. Also includes
+  // VK_IMAGE_USAGE_TRANSFER_DST_BIT if the surface supports it, and
+  // VK_IMAGE_USAGE_STORAGE_BIT if the surface supports it and the format is
+  // VK_FORMAT_R8G8B8A8_UNORM. Compute passes such as VulkanPostProcessor's
+  // can only write the images directly when the storage bit is set.
+  [[nodiscard]] VkImageUsageFlags ImageUsage() const { return image_usage_; }
+
+  [[nodiscard]] const std::vector<VkImage>& Images() const { return images_; }
+  [[nodiscard]] const std::vector<VkImageView>& ImageViews() const { return image_views_; }
+
+  // Returns the index of the next image to render to.
+  //
+  // The image may still be in use by the presentation engine. `semaphore` is
+  // signaled when the image is available.
+  [[nodiscard]] uint32_t AcquireNextImage(VkSemaphore semaphore) const;
+
+ private:
+  explicit VulkanSwapChain(const VulkanDevice& device, const VulkanPresentationSurface& surface,
+                           const VulkanSurfaceSupport& surface_support);
+
+  const VulkanDevice& device_;
+  const VkSurfaceFormatKHR format_;
+  const VkExtent2D extent_;
+  const VkPresentModeKHR present_mode_;
+  const VkImageUsageFlags image_usage_;
+  const VkSwapchainKHR swap_chain_;
+  const std::vector<VkImage> images_;
+  const std::vector<VkImageView> image_views_;
+};
+
+#endif  // VULKAN_SWAP_CHAIN_H_
@@ -0,0 +1,107 @@
+#include "vulkan_sync.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_device.h"
+
+VkFence CreateVulkanFence(const VulkanDevice& device, VkFenceCreateFlags flags) {
+  VkFenceCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = flags,
+  };
+
+  VkFence fence = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateFence(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &fence);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateFence() failed" << std::endl;
+    std::abort();
+  }
+  return fence;
+}
+
+VkSemaphore CreateVulkanSemaphore(const VulkanDevice& device, const void* next) {
+  VkSemaphoreCreateInfo create_info = {
+    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    .pNext = next,
+    .flags = 0,
+  };
+
+  VkSemaphore semaphore = VK_NULL_HANDLE;
+  VkResult result = device.Functions().vkCreateSemaphore(
+      device.VulkanHandle(), &create_info, /*pAllocator=*/nullptr, &semaphore);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkCreateSemaphore() failed" << std::endl;
+    std::abort();
+  }
+  return semaphore;
+}
+
+VkSemaphore CreateExportableVulkanSemaphore(const VulkanDevice& device) {
+  VkExportSemaphoreCreateInfo export_info = {
+    .sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO,
+    .pNext = nullptr,
+    .handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+  };
+  return CreateVulkanSemaphore(device, &export_info);
+}
+
+int ExportVulkanSemaphoreFd(const VulkanDevice& device, VkSemaphore semaphore) {
+  assert(semaphore != VK_NULL_HANDLE);
+  assert(device.Functions().vkGetSemaphoreFdKHR != nullptr);
+
+  VkSemaphoreGetFdInfoKHR get_fd_info = {
+    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR,
+    .pNext = nullptr,
+    .semaphore = semaphore,
+    .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+  };
+
+  int fd = -1;
+  VkResult result = device.Functions().vkGetSemaphoreFdKHR(
+      device.VulkanHandle(), &get_fd_info, &fd);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkGetSemaphoreFdKHR() failed" << std::endl;
+    std::abort();
+  }
+  return fd;
+}
+
+void ImportVulkanSemaphoreFd(const VulkanDevice& device, VkSemaphore semaphore, int fd) {
+  assert(semaphore != VK_NULL_HANDLE);
+  assert(fd >= 0);
+  assert(device.Functions().vkImportSemaphoreFdKHR != nullptr);
+
+  // Opaque file descriptors use reference transference, so both semaphores
+  // keep sharing the payload after the import.
+  VkImportSemaphoreFdInfoKHR import_info = {
+    .sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+    .pNext = nullptr,
+    .semaphore = semaphore,
+    .flags = 0,
+    .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+    .fd = fd,
+  };
+  VkResult result = device.Functions().vkImportSemaphoreFdKHR(device.VulkanHandle(), &import_info);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkImportSemaphoreFdKHR() failed" << std::endl;
+    std::abort();
+  }
+}
+
+void WaitForVulkanFence(const VulkanDevice& device, VkFence fence) {
+  assert(fence != VK_NULL_HANDLE);
+
+  VkResult result = device.Functions().vkWaitForFences(
+      device.VulkanHandle(), 1, &fence, /*waitAll=*/VK_TRUE, UINT64_MAX);
+  if (result != VK_SUCCESS) {
+    std::cerr << "vkWaitForFences() failed" << std::endl;
+    std::abort();
+  }
+}
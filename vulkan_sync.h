@@ -0,0 +1,36 @@
+#ifndef VULKAN_SYNC_H_
+#define VULKAN_SYNC_H_
+
+#include <vulkan/vulkan_core.h>
+
+class VulkanDevice;
+
+// Helpers for creating and waiting on synchronization primitives.
+//
+// The returned handles must be destroyed via the device's function table.
+
+[[nodiscard]] VkFence CreateVulkanFence(const VulkanDevice& device, VkFenceCreateFlags flags = 0);
+
+// `next` is chained into the VkSemaphoreCreateInfo.
+[[nodiscard]] VkSemaphore CreateVulkanSemaphore(const VulkanDevice& device,
+                                                const void* next = nullptr);
+
+// Creates a semaphore that can be exported with ExportVulkanSemaphoreFd().
+[[nodiscard]] VkSemaphore CreateExportableVulkanSemaphore(const VulkanDevice& device);
+
+// Returns an opaque file descriptor that refers to the semaphore's payload.
+//
+// The caller owns the returned file descriptor. Requires the
+// VK_KHR_external_semaphore_fd device extension.
+[[nodiscard]] int ExportVulkanSemaphoreFd(const VulkanDevice& device, VkSemaphore semaphore);
+
+// Makes `semaphore` share the payload of the semaphore exported as `fd`.
+//
+// Takes ownership of `fd`. The exporting device must have the same identity
+// as `device`.
+void ImportVulkanSemaphoreFd(const VulkanDevice& device, VkSemaphore semaphore, int fd);
+
+// Blocks until `fence` is signaled.
+void WaitForVulkanFence(const VulkanDevice& device, VkFence fence);
+
+#endif  // VULKAN_SYNC_H_
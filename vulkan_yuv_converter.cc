@@ -0,0 +1,59 @@
+#include "vulkan_yuv_converter.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_compute_pipeline.h"
+#include "vulkan_shader_module.h"
+
+namespace {
+
+// Must match shaders/rgb_to_yuv420.comp.
+constexpr uint32_t kBlockWidth = 8;
+constexpr uint32_t kBlockHeight = 2;
+constexpr uint32_t kWorkgroupSize = 8;
+
+struct PushConstants {
+  uint32_t width;
+  uint32_t height;
+};
+
+}  // namespace
+
+VulkanYuvConverter::VulkanYuvConverter(const VulkanDevice& device, VkExtent2D extent,
+                                       uint32_t max_pending_conversions)
+    : extent_(extent),
+      pipeline_(device, ReadSpirvFile("rgb_to_yuv420.spv"),
+                {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+                sizeof(PushConstants), max_pending_conversions) {
+  assert(extent.width % kBlockWidth == 0);
+  assert(extent.height % kBlockHeight == 0);
+
+  descriptor_sets_.reserve(max_pending_conversions);
+  for (uint32_t i = 0; i < max_pending_conversions; ++i)
+    descriptor_sets_.push_back(pipeline_.AllocateDescriptorSet());
+}
+
+VulkanYuvConverter::~VulkanYuvConverter() = default;
+
+void VulkanYuvConverter::Record(VkCommandBuffer command_buffer, uint32_t conversion_index,
+                                VkImageView source, VkBuffer planes) {
+  assert(conversion_index < descriptor_sets_.size());
+
+  // The descriptor set is not in use, because the conversion that last used
+  // it has completed.
+  VkDescriptorSet descriptor_set = descriptor_sets_[conversion_index];
+  pipeline_.BindImage(descriptor_set, /*binding=*/0, source, VK_IMAGE_LAYOUT_GENERAL);
+  pipeline_.BindBuffer(descriptor_set, /*binding=*/1, planes, /*offset=*/0,
+                       PlanesSize(extent_));
+
+  PushConstants push_constants = {.width = extent_.width, .height = extent_.height};
+  uint32_t block_columns = extent_.width / kBlockWidth;
+  uint32_t block_rows = extent_.height / kBlockHeight;
+  pipeline_.Dispatch(command_buffer, descriptor_set, &push_constants,
+                     (block_columns + kWorkgroupSize - 1) / kWorkgroupSize,
+                     (block_rows + kWorkgroupSize - 1) / kWorkgroupSize);
+}
@@ -0,0 +1,54 @@
+#ifndef VULKAN_YUV_CONVERTER_H_
+#define VULKAN_YUV_CONVERTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "vulkan_compute_pipeline.h"
+
+class VulkanDevice;
+
+// Converts RGBA images to planar YUV 4:2:0 on the GPU.
+//
+// The output uses BT.601 limited range, and is laid out as in Y4M frames: the
+// full-resolution Y plane, followed by the quarter-resolution U and V planes.
+// It is 1.5 bytes per pixel, compared to 4 bytes for RGBA.
+class VulkanYuvConverter {
+ public:
+  // `device` must outlive this instance.
+  //
+  // The width of `extent` must be a multiple of 8, and its height must be even.
+  // Up to `max_pending_conversions` conversions may be in flight on the GPU.
+  explicit VulkanYuvConverter(const VulkanDevice& device, VkExtent2D extent,
+                              uint32_t max_pending_conversions);
+
+  VulkanYuvConverter(const VulkanYuvConverter&) = delete;
+  VulkanYuvConverter& operator=(const VulkanYuvConverter&) = delete;
+
+  ~VulkanYuvConverter();
+
+  // The size of the buffer written by a conversion.
+  [[nodiscard]] static VkDeviceSize PlanesSize(VkExtent2D extent) {
+    return VkDeviceSize{extent.width} * extent.height * 3 / 2;
+  }
+
+  // Records the conversion of the image at `source` into `planes`.
+  //
+  // `source` must be a view of an R8G8B8A8_UNORM image created with storage
+  // usage, in the GENERAL layout. `planes` must be a storage buffer of at
+  // least PlanesSize() bytes.
+  //
+  // `conversion_index` must be below `max_pending_conversions`. The previous
+  // conversion recorded with the same index must have completed.
+  void Record(VkCommandBuffer command_buffer, uint32_t conversion_index, VkImageView source,
+              VkBuffer planes);
+
+ private:
+  const VkExtent2D extent_;
+  VulkanComputePipeline pipeline_;
+  std::vector<VkDescriptorSet> descriptor_sets_;
+};
+
+#endif  // VULKAN_YUV_CONVERTER_H_
@@ -0,0 +1,34 @@
+#ifndef WINDOW_EVENT_H_
+#define WINDOW_EVENT_H_
+
+#include <cstdint>
+
+// User input received by a VulkanPresentationSurface's window.
+//
+// Events are small and trivially copyable, so they can be passed between
+// threads through a SpscQueue.
+struct WindowEvent {
+  enum class Type {
+    // The user asked to close the window.
+    kClose,
+
+    // A Unicode character was typed. Uses `codepoint`.
+    kCharacter,
+
+    // A mouse button was pressed or released. Uses `button` and `pressed`.
+    kMouseButton,
+
+    // The cursor moved. Uses `x` and `y`, in screen coordinates relative to the
+    // window's content area.
+    kCursorMove,
+  };
+
+  Type type = Type::kClose;
+  uint32_t codepoint = 0;
+  int button = 0;
+  bool pressed = false;
+  double x = 0;
+  double y = 0;
+};
+
+#endif  // WINDOW_EVENT_H_